@@ -0,0 +1,326 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2001 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra bench.c ../../src/pid.c ../../src/pid_bank.c -lm -o bench.bin */
+/* gcc -std=c99 -O2 -Wall -Wextra -DEPID_NO_VALID_FLT bench.c ../../src/pid.c ../../src/pid_bank.c -lm -o bench_novalid.bin */
+
+/* Micro-benchmark of every public function of <pid.h>.
+ * The library is compiled separately (not header-only), so calls are
+ * measured as applications use them. Output is JSON on `stdout`:
+ * per function median and 99th percentile in ns/call and cycles/call
+ * (time-stamp counter ticks, `null` where not available), and hardware
+ * counters per call on Linux (`null` where not available, see "bench.h").
+ * The `*_update` kernels compare a controller update done by separate
+ * calls (scalar), by `epid_pid_step()` (fused), and by a bank of `BANK_N`
+ * controllers (per controller), also with gains profiles gathered by index,
+ * plus the LPF.
+ * Build it with and without `-DEPID_NO_VALID_FLT` to compare
+ * `EPID_FEATURE_VALID_FLT` on and off.
+ */
+
+#include "bench.h"
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+
+
+/* Rotate over contexts and inputs, so no call is hoisted out of loops. */
+#define CTX_N 64U
+#define INPUT_N 1024U
+#define BANK_N 200U /* `BENCH_BATCH` is a multiple of it. */
+
+static epid_t ctxs[CTX_N];
+static epid_t tuned[CTX_N]; /* By `epid_init_T()`, for `epid_set_gains_T()`. */
+static epid_lpf_t lpfs[CTX_N];
+static epid_coef_t coefs[CTX_N];
+static float inputs[INPUT_N];
+
+static epid_bank_t bank;
+static EPID_ALIGNED(EPID_BANK_ALIGN) float bank_mem[EPID_BANK_MEM_LEN(BANK_N)];
+static EPID_ALIGNED(EPID_BANK_ALIGN) float bank_sp[BANK_N];
+static epid_gains_t bank_gains[4];
+static uint32_t bank_gains_index[BANK_N];
+
+
+static void setup(void)
+{
+    uint32_t seed = 1U;
+
+    for (size_t i = 0U; i < INPUT_N; i++) {
+        seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+        inputs[i] = 20.0f + (float)(seed >> 16) * (60.0f / 65536.0f);
+    }
+
+    for (size_t i = 0U; i < CTX_N; i++) {
+        if ((epid_init(&ctxs[i], inputs[i], inputs[i], 0.0f,
+                       500.0f, 10.0f, 200.0f) != EPID_ERR_NONE)
+         || (epid_init_T(&tuned[i], inputs[i], inputs[i], 0.0f,
+                         500.0f, 5.0f, 0.04f, 0.1f) != EPID_ERR_NONE)
+         || (epid_coef_init(&coefs[i], &ctxs[i]) != EPID_ERR_NONE)
+         || (epid_util_lpf_init(&lpfs[i], 0.1f, inputs[i]) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (epid_bank_init(&bank, bank_mem, BANK_N) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_bank_init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0U; i < BANK_N; i++) {
+        bank_sp[i] = 70.0f;
+        bank_gains_index[i] = (uint32_t)(i % 4U);
+        epid_bank_load(&bank, i, &ctxs[i % CTX_N]);
+    }
+    for (size_t i = 0U; i < 4U; i++) {
+        if (epid_gains_init(&bank_gains[i], 500.0f, 10.0f + (float)i, 200.0f) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_gains_init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void k_init(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        const float x = inputs[n % INPUT_N];
+        acc += epid_init(&ctxs[n % CTX_N], x, x, 0.0f, 500.0f, 10.0f, 200.0f);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_init_T(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        const float x = inputs[n % INPUT_N];
+        acc += epid_init_T(&ctxs[n % CTX_N], x, x, 0.0f, 500.0f, 5.0f, 0.04f, 0.1f);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_set_gains(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        acc += epid_set_gains(&tuned[n % CTX_N], 500.0f, inputs[n % INPUT_N], 200.0f);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_set_gains_T(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        acc += epid_set_gains_T(&tuned[n % CTX_N], 500.0f, inputs[n % INPUT_N], 0.04f);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_pi_calc(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pi_calc(&ctxs[n % CTX_N], 70.0f, inputs[n % INPUT_N]);
+    }
+    bench_sink = ctxs[0].p_term;
+}
+
+static void k_pid_calc(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pid_calc(&ctxs[n % CTX_N], 70.0f, inputs[n % INPUT_N]);
+    }
+    bench_sink = ctxs[0].d_term;
+}
+
+static void k_pi_sum(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pi_sum(&ctxs[n % CTX_N], 0.0f, 500.0f);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_pid_sum(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pid_sum(&ctxs[n % CTX_N], 0.0f, 500.0f);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_pi_step(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pi_step(&ctxs[n % CTX_N], 70.0f, inputs[n % INPUT_N],
+                     -100.0f, 100.0f, 0.0f, 500.0f);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_pid_step(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_pid_step(&ctxs[n % CTX_N], 70.0f, inputs[n % INPUT_N],
+                      -100.0f, 100.0f, 0.0f, 500.0f);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_util_ilim(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_util_ilim(&ctxs[n % CTX_N], -100.0f, 100.0f);
+    }
+    bench_sink = ctxs[0].i_term;
+}
+
+static void k_coef_init(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        acc += epid_coef_init(&coefs[n % CTX_N], &ctxs[n % CTX_N]);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_coef_pid_step(size_t iters)
+{
+    float acc = 0.0f;
+    for (size_t n = 0U; n < iters; n++) {
+        acc += epid_coef_pid_step(&coefs[n % CTX_N], &ctxs[n % CTX_N],
+                                  70.0f, inputs[n % INPUT_N], 0.0f, 500.0f);
+    }
+    bench_sink = acc;
+}
+
+static void k_coef_terms(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_coef_terms(&ctxs[n % CTX_N], 70.0f, inputs[n % INPUT_N]);
+    }
+    bench_sink = ctxs[0].d_term;
+}
+
+static void k_lpf_init(size_t iters)
+{
+    epid_info_t acc = 0U;
+    for (size_t n = 0U; n < iters; n++) {
+        acc += epid_util_lpf_init(&lpfs[n % CTX_N], 0.1f, inputs[n % INPUT_N]);
+    }
+    bench_sink = (float)acc;
+}
+
+static void k_lpf_calc(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_util_lpf_calc(&lpfs[n % CTX_N], inputs[n % INPUT_N]);
+    }
+    bench_sink = lpfs[0].y;
+}
+
+/* One controller update per call. */
+static void k_scalar_update(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n++) {
+        epid_t *ctx = &ctxs[n % CTX_N];
+        epid_pid_calc(ctx, 70.0f, inputs[n % INPUT_N]);
+        epid_util_ilim(ctx, -100.0f, 100.0f);
+        epid_pid_sum(ctx, 0.0f, 500.0f);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_fused_update(size_t iters)
+{
+    k_pid_step(iters);
+}
+
+static void k_bank_update(size_t iters)
+{
+    /* `iters` rounded up to whole bank steps. */
+    for (size_t n = 0U; n < iters; n += BANK_N) {
+        epid_bank_pid_step(&bank, bank_sp, &inputs[n % (INPUT_N - BANK_N + 1U)],
+                           0.0f, 500.0f, BANK_N);
+    }
+    bench_sink = bank.y_out[0];
+}
+
+static void k_bank_gains_update(size_t iters)
+{
+    for (size_t n = 0U; n < iters; n += BANK_N) {
+        epid_bank_pid_step_gains(&bank, bank_gains, bank_gains_index,
+                                 bank_sp, &inputs[n % (INPUT_N - BANK_N + 1U)],
+                                 0.0f, 500.0f, BANK_N);
+    }
+    bench_sink = bank.y_out[0];
+}
+
+static void k_lpf_update(size_t iters)
+{
+    k_lpf_calc(iters);
+}
+
+
+static const struct {
+    const char *name;
+    bench_kernel_t kernel;
+} kernels[] = {
+    {"epid_init", k_init},
+    {"epid_init_T", k_init_T},
+    {"epid_set_gains", k_set_gains},
+    {"epid_set_gains_T", k_set_gains_T},
+    {"epid_pi_calc", k_pi_calc},
+    {"epid_pid_calc", k_pid_calc},
+    {"epid_pi_sum", k_pi_sum},
+    {"epid_pid_sum", k_pid_sum},
+    {"epid_pi_step", k_pi_step},
+    {"epid_pid_step", k_pid_step},
+    {"epid_util_ilim", k_util_ilim},
+    {"epid_coef_init", k_coef_init},
+    {"epid_coef_pid_step", k_coef_pid_step},
+    {"epid_coef_terms", k_coef_terms},
+    {"epid_util_lpf_init", k_lpf_init},
+    {"epid_util_lpf_calc", k_lpf_calc},
+    {"scalar_update", k_scalar_update},
+    {"fused_update", k_fused_update},
+    {"bank_update", k_bank_update},
+    {"bank_gains_update", k_bank_gains_update},
+    {"lpf_update", k_lpf_update},
+};
+
+
+int main()
+{
+    setup();
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+#ifdef EPID_FEATURE_VALID_FLT
+    printf("  \"valid_flt\": true,\n");
+#else
+    printf("  \"valid_flt\": false,\n");
+#endif
+    printf("  \"timer\": \"clock_gettime(CLOCK_MONOTONIC)\", \"cycles\": \"%s\",\n",
+#ifdef BENCH_HAVE_TSC
+           "rdtsc"
+#else
+           "none"
+#endif
+           );
+    printf("  \"perf\": \"%s\", \"bank_kernel\": \"%s\",\n",
+           bench_perf_available() ? "perf_event_open" : "none",
+           epid_bank_kernel_name());
+    printf("  \"batch\": %u, \"samples\": %u,\n  \"results\": [",
+           BENCH_BATCH, BENCH_SAMPLES);
+
+    for (size_t k = 0U; k < (sizeof(kernels) / sizeof(kernels[0])); k++) {
+        const bench_stats_t st = bench_run(kernels[k].kernel, BENCH_BATCH, BENCH_SAMPLES);
+        bench_json_stats(stdout, kernels[k].name, &st, k == 0U);
+        bench_json_end(stdout);
+    }
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,299 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2001 host. */
+
+/* EPID benchmarks harness: Timers, samples statistics and JSON output.
+ *
+ * A kernel is a function running `iters` calls of the measured code.
+ * `bench_run()` times `BENCH_SAMPLES` batches of `BENCH_BATCH` calls,
+ * and reports per call median and 99th percentile of wall time (ns)
+ * and of time-stamp counter ticks (cycles) when available.
+ *
+ * On Linux, hardware counters are read with `perf_event_open()` around
+ * every batch, and reported as mean per call: instructions, branch-misses,
+ * cache-misses, and stalled cycles (frontend, backend).
+ * A counter that can not be opened (no PMU in VMs/containers,
+ * `perf_event_paranoid`, unsupported event) is reported as `null`,
+ * timing is done anyway. Define `BENCH_NO_PERF` to build without it.
+ */
+
+#ifndef EPID_BENCH_H
+#define EPID_BENCH_H 1
+
+#ifndef _POSIX_C_SOURCE
+# define _POSIX_C_SOURCE 200112L /* For `clock_gettime()`. */
+#endif
+
+#if defined(__linux__) && !defined(BENCH_NO_PERF)
+# ifndef _DEFAULT_SOURCE
+#  define _DEFAULT_SOURCE 1 /* For `syscall()`. */
+# endif
+# define BENCH_HAVE_PERF 1
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define BENCH_HAVE_TSC 1
+#endif
+
+#ifdef BENCH_HAVE_PERF
+# include <unistd.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+# include <linux/perf_event.h>
+#endif
+
+#ifndef BENCH_SAMPLES
+# define BENCH_SAMPLES 1000U /* Timed batches per kernel. */
+#endif
+#ifndef BENCH_BATCH
+# define BENCH_BATCH 1000U /* Calls per timed batch. */
+#endif
+
+
+#define BENCH_PERF_N 5U /* Hardware counters. */
+
+static const char *const bench_perf_names[BENCH_PERF_N] = {
+    "instructions", "branch_misses", "cache_misses",
+    "stalled_cycles_frontend", "stalled_cycles_backend"
+};
+
+
+typedef void (*bench_kernel_t)(size_t iters);
+
+typedef struct {
+    double ns_median; /* Per call. */
+    double ns_p99;
+    double cycles_median; /* Per call, `-1` without a time-stamp counter. */
+    double cycles_p99;
+    double perf[BENCH_PERF_N]; /* Mean per call, `-1` if not available. */
+} bench_stats_t;
+
+
+/* Keep results alive, so calls are not optimized away. */
+static volatile float bench_sink;
+
+
+static inline uint64_t bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static inline uint64_t bench_cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+
+#ifdef BENCH_HAVE_PERF
+/* Counters file descriptors, `-1` if not available; `0` before opened. */
+static int bench_perf_fd[BENCH_PERF_N];
+static int bench_perf_opened = 0;
+
+static inline void bench_perf_open(void)
+{
+    static const uint64_t configs[BENCH_PERF_N] = {
+        PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND,
+        PERF_COUNT_HW_STALLED_CYCLES_BACKEND
+    };
+
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; /* Allowed with `perf_event_paranoid <= 2`. */
+        attr.exclude_hv = 1;
+        /* Counters may be multiplexed, to scale them. */
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        /* This thread, any CPU. */
+        bench_perf_fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0UL);
+    }
+    bench_perf_opened = 1;
+}
+
+static inline void bench_perf_start(void)
+{
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        if (bench_perf_fd[i] >= 0) {
+            ioctl(bench_perf_fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(bench_perf_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/* Stop counting and add counts to `sum`, `-1` for a failed counter. */
+static inline void bench_perf_stop(double *sum)
+{
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        if (bench_perf_fd[i] >= 0) {
+            ioctl(bench_perf_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        uint64_t v[3]; /* Value, time enabled, time running. */
+        if ((bench_perf_fd[i] < 0) || (sum[i] < 0.0)) {
+            continue;
+        }
+        if ((read(bench_perf_fd[i], v, sizeof(v)) != (ssize_t)sizeof(v)) || (v[2] == 0U)) {
+            sum[i] = -1.0; /* Never scheduled on the PMU. */
+        }
+        else {
+            sum[i] += (double)v[0] * ((double)v[1] / (double)v[2]);
+        }
+    }
+}
+
+/* Any counter opened. */
+static inline int bench_perf_available(void)
+{
+    if (!bench_perf_opened) {
+        bench_perf_open();
+    }
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        if (bench_perf_fd[i] >= 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#else
+static inline int bench_perf_available(void)
+{
+    return 0;
+}
+#endif /* BENCH_HAVE_PERF */
+
+
+static inline int bench_cmp_double(const void *a, const void *b)
+{
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+
+/* Percentile `p` in [0, 100] of sorted samples, nearest rank. */
+static inline double bench_percentile(const double *sorted, size_t n, double p)
+{
+    size_t rank = (size_t)((p / 100.0) * (double)n + 0.5);
+    if (rank > 0U) {
+        rank--;
+    }
+    if (rank >= n) {
+        rank = n - 1U;
+    }
+    return sorted[rank];
+}
+
+
+/* Time a kernel over `samples` batches of `batch` calls, per call statistics. */
+static inline bench_stats_t bench_run(bench_kernel_t kernel, size_t batch, size_t samples)
+{
+    static double ns[BENCH_SAMPLES];
+    static double cycles[BENCH_SAMPLES];
+#ifdef BENCH_HAVE_PERF
+    double perf_sum[BENCH_PERF_N] = {0.0};
+#endif
+    bench_stats_t st;
+    const int perf = bench_perf_available();
+
+    (void)perf; /* Unused without `BENCH_HAVE_PERF`. */
+
+    if (samples > BENCH_SAMPLES) {
+        samples = BENCH_SAMPLES;
+    }
+
+    kernel(batch); /* Warm-up caches and branch predictors. */
+
+    for (size_t s = 0U; s < samples; s++) {
+#ifdef BENCH_HAVE_PERF
+        if (perf) {
+            bench_perf_start();
+        }
+#endif
+        const uint64_t t0 = bench_ns();
+        const uint64_t c0 = bench_cycles();
+        kernel(batch);
+        const uint64_t c1 = bench_cycles();
+        const uint64_t t1 = bench_ns();
+#ifdef BENCH_HAVE_PERF
+        if (perf) {
+            bench_perf_stop(perf_sum);
+        }
+#endif
+        ns[s] = (double)(t1 - t0) / (double)batch;
+        cycles[s] = (double)(c1 - c0) / (double)batch;
+    }
+
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+#ifdef BENCH_HAVE_PERF
+        if (perf && (bench_perf_fd[i] >= 0) && (perf_sum[i] >= 0.0)) {
+            st.perf[i] = perf_sum[i] / ((double)batch * (double)samples);
+            continue;
+        }
+#endif
+        st.perf[i] = -1.0;
+    }
+
+    qsort(ns, samples, sizeof(ns[0]), bench_cmp_double);
+    qsort(cycles, samples, sizeof(cycles[0]), bench_cmp_double);
+
+    st.ns_median = bench_percentile(ns, samples, 50.0);
+    st.ns_p99 = bench_percentile(ns, samples, 99.0);
+#ifdef BENCH_HAVE_TSC
+    st.cycles_median = bench_percentile(cycles, samples, 50.0);
+    st.cycles_p99 = bench_percentile(cycles, samples, 99.0);
+#else
+    st.cycles_median = -1.0;
+    st.cycles_p99 = -1.0;
+#endif
+
+    return st;
+}
+
+
+/* JSON output helpers; `first` tells if a comma separator is needed.
+ * The object is left open for more fields, close it with `bench_json_end()`.
+ */
+static inline void bench_json_stats(FILE *out, const char *name, const bench_stats_t *st, int first)
+{
+    fprintf(out, "%s\n    {\"name\": \"%s\", \"ns_median\": %.3f, \"ns_p99\": %.3f",
+            first ? "" : ",", name, st->ns_median, st->ns_p99);
+    if (st->cycles_median >= 0.0) {
+        fprintf(out, ", \"cycles_median\": %.2f, \"cycles_p99\": %.2f",
+                st->cycles_median, st->cycles_p99);
+    }
+    else {
+        fprintf(out, ", \"cycles_median\": null, \"cycles_p99\": null");
+    }
+    for (size_t i = 0U; i < BENCH_PERF_N; i++) {
+        if (st->perf[i] >= 0.0) {
+            fprintf(out, ", \"%s\": %.3f", bench_perf_names[i], st->perf[i]);
+        }
+        else {
+            fprintf(out, ", \"%s\": null", bench_perf_names[i]);
+        }
+    }
+}
+
+static inline void bench_json_end(FILE *out)
+{
+    fputc('}', out);
+}
+
+#endif /* EPID_BENCH_H */
@@ -0,0 +1,174 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2001 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread bench_farm.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_farm.c -lm -o bench_farm.bin */
+
+/* Scaling of `epid_farm_pid_step()` from 1 to N threads (online CPUs by
+ * default, or the first argument), on a bank of `FARM_N` controllers.
+ * Output is JSON on `stdout`: per threads count, ns per tick, millions of
+ * controller updates per second, speed-up versus one thread, stolen chunks,
+ * and if the outputs after `CHECK_TICKS` ticks are bit for bit identical
+ * to the single thread outputs (determinism, exit status 1 if not).
+ * Check: `extras/testing/test_farm.c`.
+ */
+
+#include "bench.h"
+
+#include <unistd.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_farm.h"
+
+
+#ifndef FARM_N
+# define FARM_N (1024U * 1024U) /* Controllers. */
+#endif
+#define TICKS 50U /* Timed ticks per sample. */
+#define SAMPLES 9U
+#define CHECK_TICKS 20U
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+static epid_bank_t bank;
+static float *bank_mem;
+static float *setpoints;
+static float *measures;
+static float *y_ref; /* Outputs of the single thread run. */
+static epid_farm_t farm;
+
+
+static void *alloc_aligned(size_t size)
+{
+    void *p = NULL;
+    if (posix_memalign(&p, EPID_BANK_ALIGN, size) != 0) {
+        fprintf(stderr, "posix_memalign() error.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+
+/* Same initial states for every run. */
+static void reset(void)
+{
+    uint32_t seed = 1U;
+
+    for (size_t i = 0U; i < FARM_N; i++) {
+        seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+        measures[i] = 20.0f + (float)(seed >> 16) * (60.0f / 65536.0f);
+        setpoints[i] = 70.0f;
+        if (epid_bank_set(&bank, i, measures[i], measures[i], 0.0f,
+                          500.0f, 10.0f + (float)(i % 7U), 200.0f) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_bank_set() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void ticks(size_t count)
+{
+    for (size_t k = 0U; k < count; k++) {
+        /* Change the measures, so every tick has new inputs. */
+        measures[k % FARM_N] += 0.5f;
+        epid_farm_pid_step(&farm, &bank, setpoints, measures,
+                           PID_LIM_MIN, PID_LIM_MAX, FARM_N);
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads;
+    double ns_1 = 0.0;
+    int first = 1;
+    int all_same = 1;
+
+    if (argc > 1) {
+        n_cpus = strtol(argv[1], NULL, 10);
+    }
+    if (n_cpus < 1) {
+        n_cpus = 1;
+    }
+    max_threads = ((size_t)n_cpus < EPID_FARM_THREADS_MAX) ? (size_t)n_cpus : EPID_FARM_THREADS_MAX;
+
+    bank_mem = (float *)alloc_aligned(EPID_BANK_MEM_LEN(FARM_N) * sizeof(float));
+    setpoints = (float *)alloc_aligned(FARM_N * sizeof(float));
+    measures = (float *)alloc_aligned(FARM_N * sizeof(float));
+    y_ref = (float *)alloc_aligned(FARM_N * sizeof(float));
+
+    if (epid_bank_init(&bank, bank_mem, FARM_N) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_bank_init() error.\n");
+        return 1;
+    }
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"controllers\": %lu, \"chunk\": %u, \"bank_kernel\": \"%s\", \"cpus\": %ld,\n",
+           (unsigned long)FARM_N, EPID_FARM_CHUNK, epid_bank_kernel_name(), n_cpus);
+    printf("  \"results\": [");
+
+    for (size_t threads = 1U; threads <= max_threads; threads++) {
+        static double ns[SAMPLES];
+        size_t steals = 0U;
+        int same = 1;
+
+        /* 1, 2, 4, ... and the max. */
+        if (((threads & (threads - 1U)) != 0U) && (threads != max_threads)) {
+            continue;
+        }
+
+        if (epid_farm_init(&farm, threads) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_farm_init() error.\n");
+            return 1;
+        }
+
+        /* Determinism check. */
+        reset();
+        ticks(CHECK_TICKS);
+        if (threads == 1U) {
+            memcpy(y_ref, bank.y_out, FARM_N * sizeof(float));
+        }
+        else {
+            same = (memcmp(y_ref, bank.y_out, FARM_N * sizeof(float)) == 0);
+            all_same = all_same && same;
+        }
+
+        for (size_t t = 0U; t < threads; t++) {
+            farm.workers[t].steals = 0U;
+        }
+        for (size_t s = 0U; s < SAMPLES; s++) {
+            const uint64_t t0 = bench_ns();
+            ticks(TICKS);
+            ns[s] = (double)(bench_ns() - t0) / (double)TICKS;
+        }
+        for (size_t t = 0U; t < threads; t++) {
+            steals += farm.workers[t].steals;
+        }
+
+        epid_farm_deinit(&farm);
+
+        qsort(ns, SAMPLES, sizeof(ns[0]), bench_cmp_double);
+        const double ns_tick = bench_percentile(ns, SAMPLES, 50.0);
+        if (threads == 1U) {
+            ns_1 = ns_tick;
+        }
+
+        printf("%s\n    {\"threads\": %lu, \"ns_per_tick\": %.0f, \"mupdates_per_s\": %.1f,"
+               " \"speedup\": %.2f, \"steals_per_tick\": %.2f, \"deterministic\": %s}",
+               first ? "" : ",", (unsigned long)threads, ns_tick,
+               ((double)FARM_N * 1e3) / ns_tick, ns_1 / ns_tick,
+               (double)steals / (double)(SAMPLES * TICKS), same ? "true" : "false");
+        first = 0;
+    }
+
+    printf("\n  ]\n}\n");
+
+    free(bank_mem);
+    free(setpoints);
+    free(measures);
+    free(y_ref);
+
+    return all_same ? 0 : 1;
+}
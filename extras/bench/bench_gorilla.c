@@ -0,0 +1,213 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2001 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra bench_gorilla.c ../../src/pid.c ../../src/pid_gorilla.c ../../src/pid_plant.c -lm -o bench_gorilla.bin */
+
+/* Telemetry compression of the heating system of `extras/testing/main.c`,
+ * `ticks` records {tick, SP, PV, P, I, D, CV, flags} of 32 bytes:
+ *   - "steps": The `main.c` run (SP 70, cold water at 100 s, SP 77 at 150 s,
+ *     SP 75 at 220 s) repeated every 360 s, mostly transients.
+ *   - "regulation": One SP for the whole run, mostly steady state.
+ * Records are encoded in blocks of `BLOCK_BYTES`, decoded and compared bit
+ * for bit. Output is JSON on `stdout`: bytes per record and compression ratio
+ * (against 32 bytes records, and 28 bytes rows of trace files), median
+ * encode and decode ns per record over `RUNS` runs.
+ * Usage: ./bench_gorilla.bin [ticks]
+ */
+
+#include "bench.h"
+
+#include "../../src/pid.h"
+#include "../../src/pid_gorilla.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters, as `extras/testing/main.c`. */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+#define CYCLE_TICKS (3600U) /* 360 s */
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+#define BLOCK_BYTES (4096U)
+#define RUNS (7U)
+
+
+static epid_telem_rec_t *recs;
+static epid_telem_rec_t *decoded;
+static uint8_t *blocks; /* Blocks, `BLOCK_BYTES` apart. */
+static size_t *block_len;
+static size_t n_blocks;
+
+
+/* Simulate heating something, run every `SAMPLE_TIME_S` */
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+
+
+static void simulate(int steps, uint32_t ticks)
+{
+    epid_t ctx;
+
+    if ((epid_plant_thermal_init(&heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+     || (epid_init(&ctx, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t k = 0U; k < ticks; k++) {
+        const uint32_t phase = k % CYCLE_TICKS;
+        float setpoint = 70.0f;
+        epid_telem_rec_t *r = &recs[k];
+
+        if (steps) {
+            setpoint = (phase < 1500U) ? 70.0f : ((phase < 2200U) ? 77.0f : 75.0f);
+            if (phase == 1000U) {
+                heating_system.y[0] -= 7.0f; /* Cold water. */
+            }
+        }
+
+        epid_pid_calc(&ctx, setpoint, heating_system.y[0]);
+        epid_pid_sum(&ctx, PID_LIM_MIN, PID_LIM_MAX);
+        epid_plant_thermal_step(&heating_system, &ctx.y_out);
+
+        r->tick = k;
+        r->setpoint = setpoint;
+        r->measure = ctx.xk_1;
+        r->p_term = ctx.p_term;
+        r->i_term = ctx.i_term;
+        r->d_term = ctx.d_term;
+        r->y_out = ctx.y_out;
+        r->flags = (uint32_t)ctx.flags;
+    }
+}
+
+
+/* Return: Encoded bytes. */
+static size_t encode(uint32_t ticks)
+{
+    epid_gorilla_enc_t enc;
+    size_t bytes = 0U;
+    uint32_t k = 0U;
+
+    n_blocks = 0U;
+    while (k < ticks) {
+        if (epid_gorilla_enc_init(&enc, &blocks[n_blocks * BLOCK_BYTES], BLOCK_BYTES) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_gorilla_enc_init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+        while ((k < ticks) && epid_gorilla_enc_push(&enc, &recs[k])) {
+            k++;
+        }
+        block_len[n_blocks] = epid_gorilla_enc_finish(&enc);
+        bytes += block_len[n_blocks];
+        n_blocks++;
+    }
+
+    return bytes;
+}
+
+
+/* Return: Decoded records. */
+static uint32_t decode(void)
+{
+    epid_gorilla_dec_t dec;
+    uint32_t k = 0U;
+
+    for (size_t b = 0U; b < n_blocks; b++) {
+        (void)epid_gorilla_dec_init(&dec, &blocks[b * BLOCK_BYTES], block_len[b]);
+        while (epid_gorilla_dec_pop(&dec, &decoded[k])) {
+            k++;
+        }
+        if (dec.error != 0) {
+            fprintf(stderr, "epid_gorilla_dec_pop() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return k;
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const char *const names[] = {"steps", "regulation"};
+    uint32_t ticks = 1000000U;
+    size_t max_blocks;
+
+    if (argc > 1) {
+        ticks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (ticks == 0U) {
+        fprintf(stderr, "Usage: %s [ticks]\n", argv[0]);
+        return 1;
+    }
+
+    /* Every block holds at least its first record and one more. */
+    max_blocks = (ticks / 2U) + 1U;
+    recs = (epid_telem_rec_t *)malloc(ticks * sizeof(*recs));
+    decoded = (epid_telem_rec_t *)malloc(ticks * sizeof(*decoded));
+    blocks = (uint8_t *)malloc(max_blocks * BLOCK_BYTES);
+    block_len = (size_t *)malloc(max_blocks * sizeof(*block_len));
+    if ((recs == NULL) || (decoded == NULL) || (blocks == NULL) || (block_len == NULL)) {
+        fprintf(stderr, "malloc() error.\n");
+        return 1;
+    }
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"ticks\": %u, \"record_bytes\": %u, \"block_bytes\": %u,\n",
+           (unsigned)ticks, (unsigned)sizeof(epid_telem_rec_t), BLOCK_BYTES);
+    printf("  \"results\": [");
+
+    for (int steps = 1; steps >= 0; steps--) {
+        double enc_ns[RUNS], dec_ns[RUNS];
+        size_t bytes = 0U;
+        uint32_t n = 0U;
+        double per_rec;
+
+        simulate(steps, ticks);
+        for (size_t run = 0U; run < RUNS; run++) {
+            uint64_t t0 = bench_ns();
+
+            bytes = encode(ticks);
+            enc_ns[run] = (double)(bench_ns() - t0) / (double)ticks;
+
+            t0 = bench_ns();
+            n = decode();
+            dec_ns[run] = (double)(bench_ns() - t0) / (double)ticks;
+        }
+        qsort(enc_ns, RUNS, sizeof(double), bench_cmp_double);
+        qsort(dec_ns, RUNS, sizeof(double), bench_cmp_double);
+
+        if ((n != ticks) || (memcmp(recs, decoded, ticks * sizeof(*recs)) != 0)) {
+            fprintf(stderr, "%s: Round trip error.\n", names[1 - steps]);
+            return 1;
+        }
+
+        per_rec = (double)bytes / (double)ticks;
+        printf("%s\n    {\"name\": \"%s\", \"bytes_per_record\": %.3f,"
+               " \"ratio_record\": %.2f, \"ratio_trace\": %.2f,"
+               " \"encode_ns_per_record\": %.2f, \"decode_ns_per_record\": %.2f}",
+               steps ? "" : ",", names[1 - steps], per_rec,
+               (double)sizeof(epid_telem_rec_t) / per_rec, 28.0 / per_rec,
+               enc_ns[RUNS / 2U], dec_ns[RUNS / 2U]);
+    }
+
+    printf("\n  ]\n}\n");
+    free(recs);
+    free(decoded);
+    free(blocks);
+    free(block_len);
+
+    return 0;
+}
@@ -0,0 +1,201 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2001 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra bench_gs.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_gs.c -lm -o bench_gs.bin */
+
+/* Cost of gain scheduling (<pid_gs.h>) per controller tick, every controller
+ * scheduled on its own measure (temperature) with a table of `GS_ROWS` rows.
+ * Output is JSON on `stdout`, per controller tick:
+ *   - "step": `epid_bank_pid_step()` only, no scheduling.
+ *   - "epid_t_update": `epid_gs_update()`, `epid_pid_calc()`, `epid_pid_sum()`
+ *     over an `epid_t` array, uniform grid.
+ *   - "bank_lookup": `epid_gs_lookup()` per controller into the bank gains,
+ *     then `epid_bank_pid_step()`, uniform grid.
+ *   - "bank_uniform", "bank_sorted": `epid_gs_bank_update()` then
+ *     `epid_bank_pid_step()`, uniform grid and sorted breakpoints.
+ *   - "gs_uniform", "gs_sorted": `epid_gs_bank_update()` only.
+ * Before timing, gains of the batched update are checked bit for bit against
+ * `epid_gs_lookup()` and `epid_gs_update()` (exit status 1 on mismatch).
+ */
+
+#include "bench.h"
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_gs.h"
+
+
+#define BANK_N 4096U
+#define GS_ROWS 16U
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+static epid_t ctxs[BANK_N];
+static epid_bank_t bank;
+static EPID_ALIGNED(EPID_BANK_ALIGN) float bank_mem[EPID_BANK_MEM_LEN(BANK_N)];
+static EPID_ALIGNED(EPID_BANK_ALIGN) float setpoints[BANK_N];
+static EPID_ALIGNED(EPID_BANK_ALIGN) float measures[BANK_N];
+
+static epid_gs_t gs_uniform, gs_sorted;
+static epid_gains_t table[GS_ROWS];
+static float breakpoints[GS_ROWS];
+
+
+static void setup(void)
+{
+    uint32_t seed = 1U;
+
+    /* Temperature 0 to 150 °C: Gains decrease as the plant gets faster. */
+    for (size_t r = 0U; r < GS_ROWS; r++) {
+        const float f = (float)r / (float)(GS_ROWS - 1U);
+        breakpoints[r] = 150.0f * f * f; /* Denser at low temperatures. */
+        if (epid_gains_init(&table[r], 800.0f - (500.0f * f), 20.0f - (12.0f * f),
+                            300.0f * (1.0f - f)) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_gains_init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if ((epid_gs_init_uniform(&gs_uniform, 0.0f, 10.0f, table, GS_ROWS) != EPID_ERR_NONE)
+     || (epid_gs_init(&gs_sorted, breakpoints, table, GS_ROWS) != EPID_ERR_NONE)
+     || (epid_bank_init(&bank, bank_mem, BANK_N) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0U; i < BANK_N; i++) {
+        seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+        measures[i] = -10.0f + (float)(seed >> 16) * (170.0f / 65536.0f); /* Also out of range. */
+        setpoints[i] = 70.0f;
+
+        if (epid_init(&ctxs[i], measures[i], measures[i], 0.0f,
+                      table[0].kp, table[0].ki, table[0].kd) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+        epid_bank_load(&bank, i, &ctxs[i]);
+    }
+}
+
+
+/* Batched gains equal per controller gains, bit for bit. Return: Mismatches. */
+static unsigned check(const epid_gs_t *gs)
+{
+    unsigned bad = 0U;
+
+    epid_gs_bank_update(gs, &bank, measures, BANK_N);
+
+    for (size_t i = 0U; i < BANK_N; i++) {
+        epid_gains_t g;
+        epid_t ctx = ctxs[i];
+
+        if ((epid_gs_lookup(gs, measures[i], &g) != EPID_ERR_NONE)
+         || (epid_gs_update(gs, &ctx, measures[i]) != EPID_ERR_NONE)
+         || (memcmp(&g.kp, &bank.kp[i], sizeof(float)) != 0)
+         || (memcmp(&g.ki, &bank.ki[i], sizeof(float)) != 0)
+         || (memcmp(&g.kd, &bank.kd[i], sizeof(float)) != 0)
+         || (ctx.kp != g.kp) || (ctx.ki != g.ki) || (ctx.kd != g.kd)
+         || (ctx.y_out != ctxs[i].y_out) /* States kept. */
+        ) {
+            bad++;
+        }
+    }
+
+    return bad;
+}
+
+
+/* Kernels update the first `iters` controllers once. */
+static void k_step(size_t iters)
+{
+    epid_bank_pid_step(&bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = bank.y_out[0];
+}
+
+static void k_epid_t_update(size_t iters)
+{
+    for (size_t i = 0U; i < iters; i++) {
+        (void)epid_gs_update(&gs_uniform, &ctxs[i], measures[i]);
+        epid_pid_calc(&ctxs[i], setpoints[i], measures[i]);
+        epid_pid_sum(&ctxs[i], PID_LIM_MIN, PID_LIM_MAX);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_bank_lookup(size_t iters)
+{
+    for (size_t i = 0U; i < iters; i++) {
+        epid_gains_t g;
+        if (epid_gs_lookup(&gs_uniform, measures[i], &g) == EPID_ERR_NONE) {
+            bank.kp[i] = g.kp;
+            bank.ki[i] = g.ki;
+            bank.kd[i] = g.kd;
+        }
+    }
+    epid_bank_pid_step(&bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = bank.y_out[0];
+}
+
+static void k_bank_uniform(size_t iters)
+{
+    epid_gs_bank_update(&gs_uniform, &bank, measures, iters);
+    epid_bank_pid_step(&bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = bank.y_out[0];
+}
+
+static void k_bank_sorted(size_t iters)
+{
+    epid_gs_bank_update(&gs_sorted, &bank, measures, iters);
+    epid_bank_pid_step(&bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = bank.y_out[0];
+}
+
+static void k_gs_uniform(size_t iters)
+{
+    epid_gs_bank_update(&gs_uniform, &bank, measures, iters);
+    bench_sink = bank.kp[0];
+}
+
+static void k_gs_sorted(size_t iters)
+{
+    epid_gs_bank_update(&gs_sorted, &bank, measures, iters);
+    bench_sink = bank.kp[0];
+}
+
+
+static const struct {
+    const char *name;
+    bench_kernel_t kernel;
+} kernels[] = {
+    {"step", k_step},
+    {"epid_t_update", k_epid_t_update},
+    {"bank_lookup", k_bank_lookup},
+    {"bank_uniform", k_bank_uniform},
+    {"bank_sorted", k_bank_sorted},
+    {"gs_uniform", k_gs_uniform},
+    {"gs_sorted", k_gs_sorted},
+};
+
+
+int main()
+{
+    unsigned bad;
+
+    setup();
+    bad = check(&gs_uniform) + check(&gs_sorted);
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"controllers\": %u, \"table_rows\": %u, \"mismatches\": %u,\n  \"results\": [",
+           BANK_N, GS_ROWS, bad);
+
+    for (size_t k = 0U; k < (sizeof(kernels) / sizeof(kernels[0])); k++) {
+        const bench_stats_t st = bench_run(kernels[k].kernel, BANK_N, BENCH_SAMPLES / 4U);
+        bench_json_stats(stdout, kernels[k].name, &st, k == 0U);
+        bench_json_end(stdout);
+    }
+
+    printf("\n  ]\n}\n");
+
+    return (bad == 0U) ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2001 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra bench_pool.c -lm -o bench_pool.bin */
+
+/* Throughput versus number of controllers, `epid_t` array versus
+ * `epid_pool_t` (hot/cold split), from L1 sized pools to DRAM.
+ * The library is compiled in this file (header-only), so only memory layout
+ * differs between the measured loops. Output is JSON on `stdout`:
+ * per pool size, the bytes of per controller state and ns per controller update.
+ *   - "epid_t": `epid_pid_calc()` then `epid_pid_sum()` over an `epid_t` array.
+ *   - "pool": `epid_pool_pid_step()`, one shared gains entry, no terms output.
+ *   - "pool_terms": Same with the terms output.
+ * Setpoints and measures arrays (8 bytes per controller) are read by all.
+ */
+
+#include "bench.h"
+
+#define EPID_HEADER_ONLY 1
+#include "../../src/pid.h"
+#include "../../src/pid_pool.h"
+#include "../../src/pid_pool.c"
+
+
+/* Pool sizes from `POOL_MIN` to `POOL_MAX` controllers, by factors of 4. */
+#ifndef POOL_MIN
+# define POOL_MIN 256U
+#endif
+#ifndef POOL_MAX
+# define POOL_MAX (4U * 1024U * 1024U)
+#endif
+/* Controller updates per size and kernel, to keep run-time constant. */
+#define UPDATES_TARGET (32.0 * 1024.0 * 1024.0)
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+static epid_t *ctxs;
+static epid_pool_t pool;
+static epid_hot_t *hot;
+static epid_terms_t *terms;
+static epid_gains_t gains[1];
+static float *setpoints;
+static float *measures;
+
+
+static void *alloc_aligned(size_t size)
+{
+    void *p = NULL;
+    if (posix_memalign(&p, EPID_POOL_ALIGN, size) != 0) {
+        fprintf(stderr, "posix_memalign() error.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+
+static void setup(size_t n)
+{
+    uint32_t seed = 1U;
+
+    ctxs = (epid_t *)alloc_aligned(n * sizeof(epid_t));
+    hot = (epid_hot_t *)alloc_aligned(n * sizeof(epid_hot_t));
+    terms = (epid_terms_t *)alloc_aligned(n * sizeof(epid_terms_t));
+    setpoints = (float *)alloc_aligned(n * sizeof(float));
+    measures = (float *)alloc_aligned(n * sizeof(float));
+
+    if ((epid_gains_init(&gains[0], 500.0f, 10.0f, 200.0f) != EPID_ERR_NONE)
+     || (epid_pool_init(&pool, hot, n, gains, 1U, NULL) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0U; i < n; i++) {
+        seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+        measures[i] = 20.0f + (float)(seed >> 16) * (60.0f / 65536.0f);
+        setpoints[i] = 70.0f;
+
+        if ((epid_init(&ctxs[i], measures[i], measures[i], 0.0f,
+                       500.0f, 10.0f, 200.0f) != EPID_ERR_NONE)
+         || (epid_pool_set(&pool, i, measures[i], measures[i], 0.0f, 0U) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void cleanup(void)
+{
+    free(ctxs);
+    free(hot);
+    free(terms);
+    free(setpoints);
+    free(measures);
+}
+
+
+/* Kernels update the first `iters` controllers once. */
+static void k_epid_t(size_t iters)
+{
+    for (size_t i = 0U; i < iters; i++) {
+        epid_pid_calc(&ctxs[i], setpoints[i], measures[i]);
+        epid_pid_sum(&ctxs[i], PID_LIM_MIN, PID_LIM_MAX);
+    }
+    bench_sink = ctxs[0].y_out;
+}
+
+static void k_pool(size_t iters)
+{
+    pool.terms = NULL;
+    epid_pool_pid_step(&pool, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = hot[0].y_out;
+}
+
+static void k_pool_terms(size_t iters)
+{
+    pool.terms = terms;
+    epid_pool_pid_step(&pool, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, iters);
+    bench_sink = terms[0].d_term;
+}
+
+
+static const struct {
+    const char *name;
+    bench_kernel_t kernel;
+    size_t state_bytes; /* Per controller, without inputs. */
+} kernels[] = {
+    {"epid_t", k_epid_t, sizeof(epid_t)},
+    {"pool", k_pool, sizeof(epid_hot_t)},
+    {"pool_terms", k_pool_terms, sizeof(epid_hot_t) + sizeof(epid_terms_t)},
+};
+
+
+int main()
+{
+    int first = 1;
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"input_bytes\": %u,\n  \"results\": [", (unsigned)(2U * sizeof(float)));
+
+    for (size_t n = POOL_MIN; n <= POOL_MAX; n *= 4U) {
+        size_t samples = (size_t)(UPDATES_TARGET / (double)n);
+        if (samples < 5U) {
+            samples = 5U;
+        }
+        if (samples > BENCH_SAMPLES) {
+            samples = BENCH_SAMPLES;
+        }
+
+        setup(n);
+
+        for (size_t k = 0U; k < (sizeof(kernels) / sizeof(kernels[0])); k++) {
+            const bench_stats_t st = bench_run(kernels[k].kernel, n, samples);
+            bench_json_stats(stdout, kernels[k].name, &st, first);
+            printf(", \"controllers\": %lu, \"state_bytes\": %lu, \"working_set_bytes\": %lu",
+                   (unsigned long)n, (unsigned long)kernels[k].state_bytes,
+                   (unsigned long)(n * (kernels[k].state_bytes + (2U * sizeof(float)))));
+            bench_json_end(stdout);
+            first = 0;
+        }
+
+        cleanup();
+    }
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
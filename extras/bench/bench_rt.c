@@ -0,0 +1,161 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, Linux host. */
+/* gcc -std=c99 -O2 -Wall -Wextra bench_rt.c ../../src/pid.c ../../src/pid_rt.c ../../src/pid_plant.c -lm -o bench_rt.bin */
+
+/* Timing of the real-time runner (`epid_rt_run()`) with the heating system of
+ * `extras/testing/main.c` as a simulated plant behind the sensor and actuator
+ * callbacks. Usage:
+ *   ./bench_rt.bin [period_us] [ticks] [timerfd] [fifo=PRIORITY] [mlock] [cpu=N]
+ * (`fifo` and `mlock` usually need root or `CAP_SYS_NICE`/`CAP_IPC_LOCK`).
+ * Output is JSON on `stdout`: Settings, counts, and min/p50/p99/p99.9/max/mean
+ * in ns of the wake-up latency (jitter) and of the compute time.
+ * `Ctrl+C` stops the run early, with statistics of the done ticks.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_rt.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters, as `extras/testing/main.c`. */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define PLANT_STEP_S 0.1f /* Simulated time per tick, faster than real-time. */
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+
+typedef struct {
+    epid_plant_thermal_t heating_system;
+    float energy_watt;
+} plant_t;
+
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+static epid_rt_t rt;
+
+
+static int sensor(void *user, float *setpoint, float *measure)
+{
+    plant_t *plant = (plant_t *)user;
+
+    (void)setpoint; /* Constant. */
+    /* Plant time advances with the ticks, one `PLANT_STEP_S` per tick. */
+    epid_plant_thermal_step(&plant->heating_system, &plant->energy_watt);
+    *measure = plant->heating_system.y[0];
+
+    return 0;
+}
+
+
+static void actuator(void *user, float output)
+{
+    ((plant_t *)user)->energy_watt = output;
+}
+
+
+static void on_sigint(int sig)
+{
+    (void)sig;
+    epid_rt_stop(&rt);
+}
+
+
+static void json_hist(const char *name, const epid_rt_hist_t *hist, int last)
+{
+    epid_rt_summary_t s;
+
+    epid_rt_hist_summary(hist, &s);
+    printf("  \"%s_ns\": {\"min\": %llu, \"p50\": %llu, \"p99\": %llu, \"p99.9\": %llu,"
+           " \"max\": %llu, \"mean\": %.1f}%s\n",
+           name, (unsigned long long)s.min, (unsigned long long)s.p50,
+           (unsigned long long)s.p99, (unsigned long long)s.p999,
+           (unsigned long long)s.max, s.mean, last ? "" : ",");
+}
+
+
+int main(int argc, char *argv[])
+{
+    epid_rt_config_t config;
+    plant_t plant;
+    epid_t ctx;
+
+    memset(&config, 0, sizeof(config));
+    config.period_ns = 1000000U; /* 1 ms */
+    config.ticks = 5000U;
+    config.out_min = PID_LIM_MIN;
+    config.out_max = PID_LIM_MAX;
+
+    if (argc > 1) {
+        config.period_ns = strtoull(argv[1], NULL, 10) * 1000U;
+    }
+    if (argc > 2) {
+        config.ticks = strtoull(argv[2], NULL, 10);
+    }
+    for (int a = 3; a < argc; a++) {
+        if (strcmp(argv[a], "timerfd") == 0) {
+            config.options |= EPID_RT_TIMERFD;
+        }
+        else if (strncmp(argv[a], "fifo=", 5) == 0) {
+            config.options |= EPID_RT_FIFO;
+            config.priority = atoi(argv[a] + 5);
+        }
+        else if (strcmp(argv[a], "mlock") == 0) {
+            config.options |= EPID_RT_MLOCK;
+        }
+        else if (strncmp(argv[a], "cpu=", 4) == 0) {
+            config.options |= EPID_RT_PIN;
+            config.cpu = atoi(argv[a] + 4);
+        }
+        else {
+            fprintf(stderr, "Unknown option: %s\n", argv[a]);
+            return 1;
+        }
+    }
+
+    plant.energy_watt = 0.0f;
+    if ((epid_plant_thermal_init(&plant.heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&plant.heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            PLANT_STEP_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+     || (epid_init(&ctx, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f,
+                   EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+     || (epid_rt_init(&rt, &config, &ctx, 70.0f, sensor, actuator, &plant) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return 1;
+    }
+
+    signal(SIGINT, on_sigint);
+
+    if (epid_rt_run(&rt) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_rt_run() error: %s: %s\n", rt.error_op, strerror(rt.error));
+        return 1;
+    }
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"period_ns\": %llu, \"timer\": \"%s\", \"fifo\": %d, \"mlock\": %s, \"cpu\": %d,\n",
+           (unsigned long long)config.period_ns,
+           ((config.options & EPID_RT_TIMERFD) != 0U) ? "timerfd" : "clock_nanosleep",
+           ((config.options & EPID_RT_FIFO) != 0U) ? config.priority : 0,
+           ((config.options & EPID_RT_MLOCK) != 0U) ? "true" : "false",
+           ((config.options & EPID_RT_PIN) != 0U) ? config.cpu : -1);
+    printf("  \"ticks\": %llu, \"misses\": %llu, \"skipped\": %llu, \"sensor_errors\": %llu,\n",
+           (unsigned long long)rt.stats.ticks, (unsigned long long)rt.stats.misses,
+           (unsigned long long)rt.stats.skipped, (unsigned long long)rt.stats.sensor_errors);
+    printf("  \"final_temp_c\": %.3f,\n", plant.heating_system.y[0]);
+    json_hist("jitter", &rt.stats.jitter, 0);
+    json_hist("compute", &rt.stats.compute, 1);
+    printf("}\n");
+
+    return 0;
+}
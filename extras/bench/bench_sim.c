@@ -0,0 +1,244 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2001 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread bench_sim.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_plant.c ../../src/pid_sim.c -lm -o bench_sim.bin */
+
+/* Closed loops simulation throughput: `SIM_N` loops of a second-order plant,
+ * a measurement LPF and a Type-C PID, by steps of the banks and plant
+ * functions ("step": One pass over all the loops per function per step),
+ * by the fused kernels of `epid_sim_run()` ("fused"), and by
+ * `epid_sim_run_mt()` from 1 to N threads (online CPUs by default,
+ * or the first argument).
+ * Output is JSON on `stdout`: per mode, ns per step of all loops, millions of
+ * controller updates per second, speed-up versus "step", and if the states
+ * and telemetry after the run are bit for bit identical to "step".
+ */
+
+#include "bench.h"
+
+#include <unistd.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_plant.h"
+#include "../../src/pid_sim.h"
+
+
+#ifndef SIM_N
+# define SIM_N (64U * 1024U) /* Closed loops. */
+#endif
+#define STEPS 200U /* Timed steps per sample. */
+#define SAMPLES 9U
+#define DECIMATION 10U
+
+#define SIM_TS 0.01f /* Sample period (s). */
+#define PID_LIM_MIN -10.0f
+#define PID_LIM_MAX 10.0f
+
+
+static epid_bank_t bank;
+static epid_lpf_bank_t lpf;
+static epid_plant_so_t plant;
+static float *bank_mem;
+static float *lpf_mem;
+static float *plant_mem;
+static float *setpoints;
+static float *measures;
+static float *pv_out; /* Telemetry of `STEPS` steps. */
+static float *cv_out;
+static float *ref[5]; /* Bank, LPF, plant states and telemetry of "step". */
+static epid_sim_t sim;
+
+
+static void *alloc_aligned(size_t size)
+{
+    void *p = NULL;
+    if (posix_memalign(&p, EPID_BANK_ALIGN, size) != 0) {
+        fprintf(stderr, "posix_memalign() error.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+
+/* Same initial states for every run. */
+static void reset(void)
+{
+    uint32_t seed = 1U;
+
+    if ((epid_bank_init(&bank, bank_mem, SIM_N) != EPID_ERR_NONE)
+     || (epid_lpf_bank_init(&lpf, lpf_mem, SIM_N) != EPID_ERR_NONE)
+     || (epid_plant_so_init(&plant, plant_mem, SIM_N) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "Banks init error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t i = 0U; i < SIM_N; i++) {
+        seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+        const float r = (float)(seed >> 16) * (1.0f / 65536.0f);
+
+        setpoints[i] = 1.0f + r;
+        if ((epid_plant_so_set(&plant, i, 1.0f, 2.0f + (4.0f * r), 0.2f + r, SIM_TS, 0.0f) != EPID_ERR_NONE)
+         || (epid_lpf_bank_set(&lpf, i, 0.5f, 0.0f) != EPID_ERR_NONE)
+         || (epid_bank_set(&bank, i, 0.0f, 0.0f, 0.0f,
+                           2.0f + r, 0.05f, 0.5f * r) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "Banks set error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (epid_sim_init(&sim, &bank, &lpf, EPID_SIM_SO, &plant, 1, DECIMATION) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_sim_init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/* Reference: The same loops by the per-step API. */
+static void steps_api(uint32_t steps)
+{
+    for (uint32_t k = 0U; k < steps; k++) {
+        memcpy(measures, plant.y, SIM_N * sizeof(float));
+        epid_lpf_bank_calc(&lpf, measures, SIM_N);
+        epid_bank_pid_step(&bank, setpoints, lpf.y, PID_LIM_MIN, PID_LIM_MAX, SIM_N);
+        epid_plant_so_step(&plant, bank.y_out);
+
+        if ((k % DECIMATION) == 0U) {
+            memcpy(pv_out + ((k / DECIMATION) * SIM_N), measures, SIM_N * sizeof(float));
+            memcpy(cv_out + ((k / DECIMATION) * SIM_N), bank.y_out, SIM_N * sizeof(float));
+        }
+    }
+}
+
+
+static void run(size_t threads, uint32_t steps)
+{
+    if (threads == 0U) {
+        steps_api(steps);
+    }
+    else if (threads == 1U) {
+        epid_sim_run(&sim, setpoints, PID_LIM_MIN, PID_LIM_MAX, steps, pv_out, cv_out);
+    }
+    else if (epid_sim_run_mt(&sim, setpoints, PID_LIM_MIN, PID_LIM_MAX, steps,
+                             pv_out, cv_out, threads) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_sim_run_mt() error.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/* Copy (`save` non-zero) or compare the states and telemetry with `ref`. */
+static int check(int save)
+{
+    const size_t rows = (STEPS + DECIMATION - 1U) / DECIMATION;
+    const float *const data[5] = { bank_mem, lpf_mem, plant_mem, pv_out, cv_out };
+    const size_t len[5] = {
+        EPID_BANK_MEM_LEN(SIM_N), EPID_LPF_BANK_MEM_LEN(SIM_N), EPID_PLANT_SO_MEM_LEN(SIM_N),
+        rows * SIM_N, rows * SIM_N
+    };
+    int same = 1;
+
+    for (size_t k = 0U; k < 5U; k++) {
+        if (save) {
+            memcpy(ref[k], data[k], len[k] * sizeof(float));
+        }
+        else if (memcmp(ref[k], data[k], len[k] * sizeof(float)) != 0) {
+            same = 0;
+        }
+    }
+    return same;
+}
+
+
+int main(int argc, char *argv[])
+{
+    long n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads;
+    double ns_ref = 0.0;
+    const size_t rows = (STEPS + DECIMATION - 1U) / DECIMATION;
+
+    if (argc > 1) {
+        n_cpus = strtol(argv[1], NULL, 10);
+    }
+    if (n_cpus < 1) {
+        n_cpus = 1;
+    }
+    max_threads = ((size_t)n_cpus < EPID_SIM_THREADS_MAX) ? (size_t)n_cpus : EPID_SIM_THREADS_MAX;
+
+    bank_mem = (float *)alloc_aligned(EPID_BANK_MEM_LEN(SIM_N) * sizeof(float));
+    lpf_mem = (float *)alloc_aligned(EPID_LPF_BANK_MEM_LEN(SIM_N) * sizeof(float));
+    plant_mem = (float *)alloc_aligned(EPID_PLANT_SO_MEM_LEN(SIM_N) * sizeof(float));
+    setpoints = (float *)alloc_aligned(SIM_N * sizeof(float));
+    measures = (float *)alloc_aligned(SIM_N * sizeof(float));
+    pv_out = (float *)alloc_aligned(rows * SIM_N * sizeof(float));
+    cv_out = (float *)alloc_aligned(rows * SIM_N * sizeof(float));
+    ref[0] = (float *)alloc_aligned(EPID_BANK_MEM_LEN(SIM_N) * sizeof(float));
+    ref[1] = (float *)alloc_aligned(EPID_LPF_BANK_MEM_LEN(SIM_N) * sizeof(float));
+    ref[2] = (float *)alloc_aligned(EPID_PLANT_SO_MEM_LEN(SIM_N) * sizeof(float));
+    ref[3] = (float *)alloc_aligned(rows * SIM_N * sizeof(float));
+    ref[4] = (float *)alloc_aligned(rows * SIM_N * sizeof(float));
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"loops\": %lu, \"lanes\": %u, \"decimation\": %u, \"bank_kernel\": \"%s\", \"cpus\": %ld,\n",
+           (unsigned long)SIM_N, EPID_SIM_LANES, DECIMATION, epid_bank_kernel_name(), n_cpus);
+    printf("  \"results\": [");
+
+    /* `threads` 0 is "step", then "fused" by 1, 2, 4, ... and the max threads. */
+    for (size_t threads = 0U; threads <= max_threads; threads++) {
+        static double ns[SAMPLES];
+        int same = 1;
+
+        if ((threads > 1U) && ((threads & (threads - 1U)) != 0U) && (threads != max_threads)) {
+            continue;
+        }
+#ifndef EPID_SIM_THREADS_AVAILABLE
+        if (threads > 1U) {
+            break;
+        }
+#endif
+
+        /* Bit-exactness check. */
+        reset();
+        run(threads, STEPS);
+        if (threads == 0U) {
+            (void)check(1);
+        }
+        else {
+            same = check(0);
+        }
+
+        for (size_t s = 0U; s < SAMPLES; s++) {
+            const uint64_t t0 = bench_ns();
+            run(threads, STEPS);
+            ns[s] = (double)(bench_ns() - t0) / (double)STEPS;
+        }
+        bench_sink = cv_out[SIM_N - 1U];
+
+        qsort(ns, SAMPLES, sizeof(ns[0]), bench_cmp_double);
+        const double ns_step = bench_percentile(ns, SAMPLES, 50.0);
+        if (threads == 0U) {
+            ns_ref = ns_step;
+        }
+
+        printf("%s\n    {\"mode\": \"%s\", \"threads\": %lu, \"ns_per_step\": %.0f,"
+               " \"mupdates_per_s\": %.1f, \"speedup\": %.2f, \"bit_exact\": %s}",
+               (threads == 0U) ? "" : ",", (threads == 0U) ? "step" : "fused",
+               (unsigned long)((threads == 0U) ? 1U : threads), ns_step,
+               ((double)SIM_N * 1e3) / ns_step, ns_ref / ns_step, same ? "true" : "false");
+    }
+
+    printf("\n  ]\n}\n");
+
+    free(bank_mem);
+    free(lpf_mem);
+    free(plant_mem);
+    free(setpoints);
+    free(measures);
+    free(pv_out);
+    free(cv_out);
+    for (size_t k = 0U; k < 5U; k++) {
+        free(ref[k]);
+    }
+
+    return 0;
+}
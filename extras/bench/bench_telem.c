@@ -0,0 +1,214 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2001 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread bench_telem.c ../../src/pid.c ../../src/pid_telem.c ../../src/pid_plant.c -lm -o bench_telem.bin */
+
+/* Cost of per-tick tracing for the control step: The heating system of
+ * `extras/testing/main.c` run for `ticks` ticks as fast as possible, with:
+ *   - "none": No tracing.
+ *   - "fprintf": One formatted line per tick, by the control step.
+ *   - "ring": `epid_telem_push()` per tick; A drain thread pops batches of
+ *     records and writes the same lines.
+ * Lines go to `path` (default "/dev/null"). Output is JSON on `stdout`:
+ * ns per tick of the control loop, records written and dropped.
+ * Unpaced, the loop runs faster than any real plant, so with one CPU or a slow
+ * sink the ring fills and records are dropped (counted), the step never blocks.
+ * With `period_us`, ticks are paced on absolute deadlines (a production rate)
+ * and only the tick compute time is measured.
+ * Usage: ./bench_telem.bin [ticks] [path] [period_us]
+ */
+
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_telem.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters, as `extras/testing/main.c`. */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+#define RING_CAP 4096U
+#define DRAIN_BATCH 256U
+
+
+static FILE *out;
+static EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_t ring;
+static EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_rec_t recs[RING_CAP];
+static atomic_int drain_stop;
+static uint64_t written;
+static uint64_t period_ns; /* Zero: Unpaced. */
+
+
+/* Simulate heating something, run every `SAMPLE_TIME_S` */
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+
+
+static void write_rec(const epid_telem_rec_t *r)
+{
+    fprintf(out, "%u\t%f\t%f\t%f\t%f\t%f\t%f\t%u\n", (unsigned)r->tick,
+            r->setpoint, r->measure, r->p_term, r->i_term, r->d_term, r->y_out,
+            (unsigned)r->flags);
+}
+
+
+static void *drain_run(void *arg)
+{
+    static epid_telem_rec_t batch[DRAIN_BATCH];
+    uint64_t n_all = 0U;
+
+    (void)arg;
+    for (;;) {
+        /* Read the flag first, so nothing pushed before it is left. */
+        const int stop = atomic_load(&drain_stop);
+        const uint32_t n = epid_telem_pop(&ring, batch, DRAIN_BATCH);
+
+        for (uint32_t i = 0U; i < n; i++) {
+            write_rec(&batch[i]);
+        }
+        n_all += n;
+
+        if (n == 0U) {
+            if (stop) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+
+    written = n_all;
+    return NULL;
+}
+
+
+/* Return: ns per tick of the control loop. */
+static double run(int mode, uint32_t ticks)
+{
+    pthread_t drain;
+    epid_t ctx;
+    const float setpoint = 70.0f;
+    struct timespec next;
+    uint64_t t0, t1, busy = 0U;
+
+    written = 0U;
+    if ((epid_plant_thermal_init(&heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+     || (epid_init(&ctx, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+     || (epid_telem_init(&ring, recs, RING_CAP) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    atomic_store(&drain_stop, 0);
+    if ((mode == 2) && (pthread_create(&drain, NULL, drain_run, NULL) != 0)) {
+        fprintf(stderr, "pthread_create() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    t0 = bench_ns();
+    for (uint32_t k = 0U; k < ticks; k++) {
+        uint64_t ta = 0U;
+
+        if (period_ns != 0U) {
+            next.tv_nsec += (long)period_ns;
+            while (next.tv_nsec >= 1000000000L) {
+                next.tv_nsec -= 1000000000L;
+                next.tv_sec++;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+            ta = bench_ns();
+        }
+
+        epid_pid_calc(&ctx, setpoint, heating_system.y[0]);
+        epid_pid_sum(&ctx, PID_LIM_MIN, PID_LIM_MAX);
+        epid_plant_thermal_step(&heating_system, &ctx.y_out);
+
+        if (mode == 1) {
+            epid_telem_rec_t r = {k, setpoint, ctx.xk_1, ctx.p_term, ctx.i_term,
+                                  ctx.d_term, ctx.y_out, (uint32_t)ctx.flags};
+            write_rec(&r);
+            written++;
+        }
+        else if (mode == 2) {
+            (void)epid_telem_push(&ring, k, setpoint, &ctx);
+        }
+
+        if (period_ns != 0U) {
+            busy += bench_ns() - ta;
+        }
+    }
+    t1 = bench_ns();
+
+    if (mode == 2) {
+        atomic_store(&drain_stop, 1);
+        pthread_join(drain, NULL);
+    }
+    fflush(out);
+    bench_sink = heating_system.y[0];
+
+    return (double)((period_ns != 0U) ? busy : (t1 - t0)) / (double)ticks;
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const char *const names[] = {"none", "fprintf", "ring"};
+    uint32_t ticks = 1000000U;
+    const char *path = "/dev/null";
+
+    if (argc > 1) {
+        ticks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        path = argv[2];
+    }
+    if (argc > 3) {
+        period_ns = strtoull(argv[3], NULL, 10) * 1000U;
+    }
+    if ((ticks == 0U) || ((out = fopen(path, "w")) == NULL)) {
+        fprintf(stderr, "Usage: %s [ticks] [path] [period_us]\n", argv[0]);
+        return 1;
+    }
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"ticks\": %u, \"period_ns\": %llu, \"path\": \"%s\", \"ring_records\": %u, \"record_bytes\": %u,",
+           (unsigned)ticks, (unsigned long long)period_ns, path, RING_CAP,
+           (unsigned)sizeof(epid_telem_rec_t));
+#ifdef EPID_FEATURE_ATOMICS
+    printf(" \"ring\": \"c11_atomics\",\n");
+#else
+    printf(" \"ring\": \"volatile\",\n");
+#endif
+    printf("  \"results\": [");
+
+    for (int mode = 0; mode < 3; mode++) {
+        const double ns = run(mode, ticks);
+
+        printf("%s\n    {\"name\": \"%s\", \"ns_per_tick\": %.2f, \"written\": %llu, \"dropped\": %u}",
+               (mode == 0) ? "" : ",", names[mode], ns, (unsigned long long)written,
+               (mode == 2) ? (unsigned)epid_telem_dropped(&ring) : 0U);
+    }
+
+    printf("\n  ]\n}\n");
+    fclose(out);
+
+    return 0;
+}
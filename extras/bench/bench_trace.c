@@ -0,0 +1,302 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2008 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread bench_trace.c ../../src/pid.c ../../src/pid_telem.c ../../src/pid_trace.c ../../src/pid_plant.c -lm -o bench_trace.bin */
+
+/* Cost of writing and loading traces of the heating system of
+ * `extras/testing/main.c`, `ticks` samples of {time, SP, PV, CV, P, I, D}:
+ *   - "tsv": One formatted tab-separated line per tick (as `main.c`),
+ *     loaded back by parsing every field (`strtof()`).
+ *   - "trace": `epid_trace_writer_append_ctx()` per tick, loaded back by
+ *     `epid_trace_reader_open()` and a pass over the PV column.
+ *   - "telem_trace": `epid_telem_push()` per tick; A drain thread pops batches
+ *     of records and appends them with `epid_trace_writer_append_recs()`.
+ * Files are written in `dir` (default "/tmp") and removed. Output is JSON on
+ * `stdout`: ns per sample to write (control loop and output) and to load,
+ * file bytes per tick. Loads are from the page cache, not the disk.
+ * Unpaced, with one CPU the ring fills and records are dropped (counted),
+ * see `bench_telem.c` for paced ticks.
+ * Usage: ./bench_trace.bin [ticks] [dir]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_telem.h"
+#include "../../src/pid_trace.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters, as `extras/testing/main.c`. */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+#define RING_CAP 4096U
+#define DRAIN_BATCH 256U
+
+
+static epid_trace_writer_t trace;
+static EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_t ring;
+static EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_rec_t recs[RING_CAP];
+static atomic_int drain_stop;
+static int drain_error;
+
+
+/* Simulate heating something, run every `SAMPLE_TIME_S` */
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+
+
+static void *drain_run(void *arg)
+{
+    static epid_telem_rec_t batch[DRAIN_BATCH];
+
+    (void)arg;
+    for (;;) {
+        /* Read the flag first, so nothing pushed before it is left. */
+        const int stop = atomic_load(&drain_stop);
+        const uint32_t n = epid_telem_pop(&ring, batch, DRAIN_BATCH);
+
+        if ((n != 0U) && (epid_trace_writer_append_recs(&trace, batch, n) != EPID_ERR_NONE)) {
+            drain_error = 1;
+        }
+
+        if (n == 0U) {
+            if (stop) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+static void fail(const char *what)
+{
+    fprintf(stderr, "%s error.\n", what);
+    exit(EXIT_FAILURE);
+}
+
+
+/* Return: ns per tick of the control loop and output, to the file closed. */
+static double write_run(int mode, uint32_t ticks, FILE *tsv)
+{
+    pthread_t drain;
+    epid_t ctx;
+    const float setpoint = 70.0f;
+    uint64_t t0, t1;
+
+    if ((epid_plant_thermal_init(&heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+     || (epid_init(&ctx, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+    ) {
+        fail("epid_*init()");
+    }
+    if (mode == 2) {
+        drain_error = 0;
+        atomic_store(&drain_stop, 0);
+        if ((epid_telem_init(&ring, recs, RING_CAP) != EPID_ERR_NONE)
+         || (pthread_create(&drain, NULL, drain_run, NULL) != 0)
+        ) {
+            fail("drain start");
+        }
+    }
+
+    t0 = bench_ns();
+    for (uint32_t k = 0U; k < ticks; k++) {
+        const float t = (float)k * SAMPLE_TIME_S;
+
+        epid_pid_calc(&ctx, setpoint, heating_system.y[0]);
+        epid_pid_sum(&ctx, PID_LIM_MIN, PID_LIM_MAX);
+        epid_plant_thermal_step(&heating_system, &ctx.y_out);
+
+        if (mode == 0) {
+            fprintf(tsv, "%.2f\t%f\t%f\t%f\t%f\t%f\t%f\n", (double)t, (double)setpoint,
+                    (double)ctx.xk_1, (double)ctx.y_out, (double)ctx.p_term,
+                    (double)ctx.i_term, (double)ctx.d_term);
+        }
+        else if (mode == 1) {
+            if (epid_trace_writer_append_ctx(&trace, t, setpoint, &ctx) != EPID_ERR_NONE) {
+                fail("epid_trace_writer_append_ctx()");
+            }
+        }
+        else {
+            (void)epid_telem_push(&ring, k, setpoint, &ctx);
+        }
+    }
+
+    if (mode == 2) {
+        atomic_store(&drain_stop, 1);
+        pthread_join(drain, NULL);
+        if (drain_error) {
+            fail("epid_trace_writer_append_recs()");
+        }
+    }
+    if (((mode == 0) && (fclose(tsv) != 0))
+     || ((mode != 0) && (epid_trace_writer_close(&trace) != EPID_ERR_NONE))
+    ) {
+        fail("close");
+    }
+    t1 = bench_ns();
+    bench_sink = heating_system.y[0];
+
+    return (double)(t1 - t0) / (double)ticks;
+}
+
+
+/* Return: ns per sample to parse all columns of a text trace. */
+static double tsv_load(const char *path, uint32_t ticks)
+{
+    float *cols = (float *)malloc((size_t)ticks * 7U * sizeof(float));
+    char line[256];
+    size_t n = 0U;
+    uint64_t t0, t1;
+    FILE *f;
+
+    if (cols == NULL) {
+        fail("malloc()");
+    }
+
+    t0 = bench_ns();
+    if ((f = fopen(path, "r")) == NULL) {
+        fail("fopen()");
+    }
+    while ((n < ticks) && (fgets(line, sizeof(line), f) != NULL)) {
+        char *p = line;
+
+        for (size_t c = 0U; c < 7U; c++) {
+            cols[(c * ticks) + n] = strtof(p, &p);
+        }
+        n++;
+    }
+    fclose(f);
+    t1 = bench_ns();
+
+    if (n != ticks) {
+        fail("tsv_load()");
+    }
+    bench_sink = cols[(2U * ticks) + (ticks - 1U)];
+    free(cols);
+
+    return (double)(t1 - t0) / (double)ticks;
+}
+
+
+/* Return: ns per sample to map a trace and read its PV column;
+ * `open_ns` the open only, `count` the samples.
+ */
+static double trace_load(const char *path, double *open_ns, uint64_t *count)
+{
+    epid_trace_reader_t r;
+    const float *pv;
+    float sum = 0.0f;
+    uint64_t t0, t1, t2;
+
+    t0 = bench_ns();
+    if ((epid_trace_reader_open(&r, path) != EPID_ERR_NONE) || (r.header.count == 0U)) {
+        fail("epid_trace_reader_open()");
+    }
+    t1 = bench_ns();
+    pv = epid_trace_reader_column(&r, EPID_TRACE_PV);
+    for (uint64_t k = 0U; k < r.header.count; k++) {
+        sum += pv[k];
+    }
+    t2 = bench_ns();
+    epid_trace_reader_close(&r);
+
+    bench_sink = sum;
+    *open_ns = (double)(t1 - t0);
+    *count = r.header.count;
+
+    return (double)(t2 - t0) / (double)*count;
+}
+
+
+static double file_bytes(const char *path, uint32_t ticks)
+{
+    struct stat st;
+
+    if (stat(path, &st) != 0) {
+        fail("stat()");
+    }
+
+    return (double)st.st_size / (double)ticks;
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const char *const names[] = {"tsv", "trace", "telem_trace"};
+    uint32_t ticks = 1000000U;
+    const char *dir = "/tmp";
+    char paths[3][1024];
+
+    if (argc > 1) {
+        ticks = (uint32_t)strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        dir = argv[2];
+    }
+    if (ticks == 0U) {
+        fprintf(stderr, "Usage: %s [ticks] [dir]\n", argv[0]);
+        return 1;
+    }
+    for (int mode = 0; mode < 3; mode++) {
+        snprintf(paths[mode], sizeof(paths[mode]), "%s/epid_bench_%s.%s", dir, names[mode],
+                 (mode == 0) ? "tsv" : "trc");
+    }
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"ticks\": %u, \"dir\": \"%s\", \"ring_records\": %u,\n", (unsigned)ticks, dir, RING_CAP);
+    printf("  \"results\": [");
+
+    for (int mode = 0; mode < 3; mode++) {
+        FILE *tsv = NULL;
+        double write_ns, load_ns, open_ns = 0.0, bytes;
+        uint64_t count = ticks;
+
+        if (mode == 0) {
+            if ((tsv = fopen(paths[mode], "w")) == NULL) {
+                fail("fopen()");
+            }
+        }
+        else if (epid_trace_writer_open(&trace, paths[mode], 1U, ticks,
+                                        0.0, SAMPLE_TIME_S) != EPID_ERR_NONE) {
+            fail("epid_trace_writer_open()");
+        }
+
+        write_ns = write_run(mode, ticks, tsv);
+        bytes = file_bytes(paths[mode], ticks);
+        /* "telem_trace": Records dropped on a full ring are missing. */
+        load_ns = (mode == 0) ? tsv_load(paths[mode], ticks)
+                              : trace_load(paths[mode], &open_ns, &count);
+        remove(paths[mode]);
+
+        printf("%s\n    {\"name\": \"%s\", \"write_ns_per_sample\": %.2f, \"file_bytes_per_tick\": %.2f,"
+               " \"load_ns_per_sample\": %.2f, \"open_ns\": %.0f, \"written\": %llu, \"dropped\": %u}",
+               (mode == 0) ? "" : ",", names[mode], write_ns, bytes, load_ns, open_ns,
+               (unsigned long long)count, (mode == 2) ? (unsigned)epid_telem_dropped(&ring) : 0U);
+    }
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2001 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread bench_tune.c ../../src/pid.c ../../src/pid_tune.c -lm -o bench_tune.bin */
+
+/* Contention of the tuning channel (<pid_tune.h>): `READERS` threads step
+ * `TUNE_N` controllers (one channel each) with `epid_tune_read()` at the start
+ * of every tick, while one writer thread publishes new gains and setpoints
+ * round-robin over all channels as fast as it can.
+ * Every write is a consistent set {v, v + 1, v + 2, v + 3} of {Kp, Ki, Kd, SP},
+ * so a torn set taken by a reader is detected and counted (must be zero).
+ * Output is JSON on `stdout`, ns per controller tick:
+ *   - "no_tune": `epid_pid_calc()` + `epid_pid_sum()` only.
+ *   - "idle": With `epid_tune_read()`, no writer (fast path).
+ *   - "contended": With `epid_tune_read()` and the writer running.
+ * Usage: ./bench_tune.bin [readers]
+ */
+
+#include "bench.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_tune.h"
+
+
+#ifndef TUNE_N
+# define TUNE_N 4096U /* Controllers, and channels. */
+#endif
+#define READERS_MAX 64U
+#define TICKS 2000U /* Ticks of all controllers per run. */
+#define SAMPLES 9U
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+typedef struct {
+    epid_t ctx;
+    float setpoint;
+    uint32_t seen;
+} loop_t;
+
+typedef struct {
+    pthread_t thread;
+    size_t begin, end; /* Controllers range. */
+    int mode; /* 0: no tune, 1: tune. */
+    uint64_t ns; /* Run time. */
+    uint64_t taken; /* New values taken. */
+    uint64_t torn; /* Inconsistent sets taken, must be zero. */
+} reader_t;
+
+static loop_t loops[TUNE_N];
+static epid_tune_t tunes[TUNE_N];
+static reader_t readers[READERS_MAX];
+static atomic_int writer_stop;
+static uint64_t writes;
+
+
+static void *reader_run(void *arg)
+{
+    reader_t *r = (reader_t *)arg;
+    const uint64_t t0 = bench_ns();
+
+    for (unsigned k = 0U; k < TICKS; k++) {
+        for (size_t i = r->begin; i < r->end; i++) {
+            loop_t *l = &loops[i];
+            const float measure = 20.0f + (float)((k + i) & 63U);
+
+            if ((r->mode != 0) && (epid_tune_read(&tunes[i], &l->seen, &l->ctx, &l->setpoint) != 0)) {
+                r->taken++;
+                if ((l->ctx.ki != (l->ctx.kp + 1.0f))
+                 || (l->ctx.kd != (l->ctx.kp + 2.0f))
+                 || (l->setpoint != (l->ctx.kp + 3.0f))) {
+                    r->torn++;
+                }
+            }
+            epid_pid_calc(&l->ctx, l->setpoint, measure);
+            epid_pid_sum(&l->ctx, PID_LIM_MIN, PID_LIM_MAX);
+        }
+    }
+
+    r->ns = bench_ns() - t0;
+    return NULL;
+}
+
+
+static void *writer_run(void *arg)
+{
+    uint64_t n = 0U;
+    float v = 1.0f;
+
+    (void)arg;
+    while (atomic_load_explicit(&writer_stop, memory_order_relaxed) == 0) {
+        for (size_t i = 0U; i < TUNE_N; i++) {
+            if (epid_tune_write(&tunes[i], v, v + 1.0f, v + 2.0f, v + 3.0f) != EPID_ERR_NONE) {
+                fprintf(stderr, "epid_tune_write() error.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        n += TUNE_N;
+        /* Exact integers in `float`. */
+        v = (v < 1000000.0f) ? (v + 1.0f) : 1.0f;
+    }
+
+    writes = n;
+    return NULL;
+}
+
+
+static void reset(void)
+{
+    for (size_t i = 0U; i < TUNE_N; i++) {
+        if ((epid_init(&loops[i].ctx, 20.0f, 20.0f, 0.0f, 1.0f, 2.0f, 3.0f) != EPID_ERR_NONE)
+         || (epid_tune_init(&tunes[i], 1.0f, 2.0f, 3.0f, 4.0f) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+        loops[i].setpoint = 4.0f;
+        loops[i].seen = 0U;
+    }
+}
+
+
+/* Return: ns per controller tick, the slowest reader. */
+static double run(size_t n_readers, int mode, int contended, uint64_t *taken, uint64_t *torn)
+{
+    pthread_t writer;
+    uint64_t ns = 0U;
+
+    reset();
+    *taken = 0U;
+    *torn = 0U;
+    writes = 0U;
+
+    atomic_store(&writer_stop, 0);
+    if (contended && (pthread_create(&writer, NULL, writer_run, NULL) != 0)) {
+        fprintf(stderr, "pthread_create() error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (size_t r = 0U; r < n_readers; r++) {
+        readers[r].begin = (r * TUNE_N) / n_readers;
+        readers[r].end = ((r + 1U) * TUNE_N) / n_readers;
+        readers[r].mode = mode;
+        readers[r].taken = 0U;
+        readers[r].torn = 0U;
+        if (pthread_create(&readers[r].thread, NULL, reader_run, &readers[r]) != 0) {
+            fprintf(stderr, "pthread_create() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (size_t r = 0U; r < n_readers; r++) {
+        pthread_join(readers[r].thread, NULL);
+        *taken += readers[r].taken;
+        *torn += readers[r].torn;
+        if (readers[r].ns > ns) {
+            ns = readers[r].ns;
+        }
+    }
+
+    atomic_store(&writer_stop, 1);
+    if (contended) {
+        pthread_join(writer, NULL);
+    }
+
+    return ((double)ns * (double)n_readers) / ((double)TICKS * (double)TUNE_N);
+}
+
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        int mode, contended;
+    } runs[] = {
+        {"no_tune", 0, 0},
+        {"idle", 1, 0},
+        {"contended", 1, 1},
+    };
+    long n = sysconf(_SC_NPROCESSORS_ONLN) - 1; /* A CPU for the writer. */
+    size_t n_readers;
+    uint64_t torn_all = 0U;
+
+    if (argc > 1) {
+        n = strtol(argv[1], NULL, 10);
+    }
+    n_readers = (n < 1) ? 1U : (((size_t)n > READERS_MAX) ? READERS_MAX : (size_t)n);
+
+    printf("{\n  \"library\": \"EPID\", \"version\": \"%s\",\n", EPID_LIB_VERSION);
+    printf("  \"controllers\": %u, \"readers\": %lu, \"ticks\": %u,",
+           TUNE_N, (unsigned long)n_readers, TICKS);
+#ifdef EPID_FEATURE_ATOMICS
+    printf(" \"channel\": \"c11_atomics\",\n");
+#else
+    printf(" \"channel\": \"volatile\",\n");
+#endif
+    printf("  \"results\": [");
+
+    for (size_t k = 0U; k < (sizeof(runs) / sizeof(runs[0])); k++) {
+        uint64_t taken, torn;
+        double samples[SAMPLES];
+
+        for (size_t s = 0U; s < SAMPLES; s++) {
+            samples[s] = run(n_readers, runs[k].mode, runs[k].contended, &taken, &torn);
+            torn_all += torn;
+        }
+        qsort(samples, SAMPLES, sizeof(samples[0]), bench_cmp_double);
+
+        printf("%s\n    {\"name\": \"%s\", \"ns_per_tick\": %.2f, \"writes\": %llu,"
+               " \"taken\": %llu, \"torn\": %llu}",
+               (k == 0U) ? "" : ",", runs[k].name, bench_percentile(samples, SAMPLES, 50.0),
+               (unsigned long long)writes, (unsigned long long)taken, (unsigned long long)torn);
+    }
+
+    printf("\n  ]\n}\n");
+
+    return (torn_all == 0U) ? 0 : 1;
+}
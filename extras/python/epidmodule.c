@@ -0,0 +1,932 @@
+/* SPDX-License-Identifier: ISC */
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, CPython 3 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra -shared -fPIC $(python3-config --includes) epidmodule.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_plant.c -lm -o epid$(python3-config --extension-suffix) */
+
+/* Python module `epid`: Controllers and LPF banks (see <pid_bank.h>) over
+ * NumPy arrays without copies, and a closed loop simulation run in C.
+ *
+ *   - `Bank(n)`: Bank of `n` controllers. Attributes `kp`, `ki`, `kd`, `xk_1`,
+ *     `xk_2`, `y_out` are float32 views of the bank memory (writable),
+ *     `pi_step()` and `pid_step()` take float32 arrays of `n` values.
+ *   - `LpfBank(n)`: Bank of `n` low-pass filters, attributes
+ *     `smoothing_factor` and `y`.
+ *   - `simulate(plant, controller, n_steps)`: Closed loops run in C,
+ *     results as arrays (see `help(epid.simulate)`).
+ *
+ * Arguments arrays are any C-contiguous float32 buffers (NumPy arrays,
+ * `array.array('f')`, ...), they are used in place. Views are NumPy arrays
+ * if NumPy can be imported, else `memoryview` objects.
+ * The GIL is released while processing.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_plant.h"
+
+
+static PyObject *numpy_asarray; /* `numpy.asarray`, or `NULL`. */
+
+
+/* An array from a float32 writable buffer: `numpy.asarray(mv)`, or `mv`. */
+static PyObject *epid_py_array(PyObject *mv)
+{
+    PyObject *arr;
+
+    if ((mv == NULL) || (numpy_asarray == NULL)) {
+        return mv;
+    }
+    arr = PyObject_CallFunctionObjArgs(numpy_asarray, mv, NULL);
+    Py_DECREF(mv);
+    return arr;
+}
+
+
+/* A view of `count` floats at `offset` floats of the buffer of `owner`. */
+static PyObject *epid_py_view(PyObject *owner, Py_ssize_t offset, Py_ssize_t count)
+{
+    PyObject *mv = PyMemoryView_FromObject(owner);
+    PyObject *start = PyLong_FromSsize_t(offset);
+    PyObject *stop = PyLong_FromSsize_t(offset + count);
+    PyObject *slice, *view = NULL;
+
+    if ((mv != NULL) && (start != NULL) && (stop != NULL)) {
+        slice = PySlice_New(start, stop, NULL);
+        view = (slice != NULL) ? PyObject_GetItem(mv, slice) : NULL;
+        Py_XDECREF(slice);
+    }
+    Py_XDECREF(stop);
+    Py_XDECREF(start);
+    Py_XDECREF(mv);
+    return epid_py_array(view);
+}
+
+
+/* Get a C-contiguous float32 buffer of `n` values (`n < 0`: Any length). */
+static int epid_py_floats(PyObject *obj, Py_buffer *view, Py_ssize_t n, const char *name)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        return -1;
+    }
+    if ((view->itemsize != (Py_ssize_t)sizeof(float))
+     || (view->format == NULL)
+     || ((strcmp(view->format, "f") != 0) && (strcmp(view->format, "<f") != 0)
+      && (strcmp(view->format, "=f") != 0))
+    ) {
+        PyErr_Format(PyExc_TypeError, "%s: Expected a float32 array", name);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if ((n >= 0) && ((view->len / view->itemsize) != n)) {
+        PyErr_Format(PyExc_ValueError, "%s: Expected %zd values, got %zd",
+                     name, n, view->len / view->itemsize);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return 0;
+}
+
+
+/* Memory block of `len` floats, aligned to `EPID_BANK_ALIGN` in `*raw`. */
+static float *epid_py_alloc(size_t len, void **raw)
+{
+    uintptr_t p;
+
+    *raw = PyMem_Calloc(1U, (len * sizeof(float)) + EPID_BANK_ALIGN);
+    if (*raw == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    p = ((uintptr_t)*raw + (EPID_BANK_ALIGN - 1U)) & ~(uintptr_t)(EPID_BANK_ALIGN - 1U);
+    return (float *)p;
+}
+
+
+/* Export `len` floats at `mem` as a 1-D float32 buffer. */
+static int epid_py_getbuffer(PyObject *owner, Py_buffer *view, int flags,
+                             float *mem, Py_ssize_t *shape)
+{
+    view->obj = owner;
+    Py_INCREF(owner);
+    view->buf = mem;
+    view->len = shape[0] * (Py_ssize_t)sizeof(float);
+    view->readonly = 0;
+    view->itemsize = sizeof(float);
+    view->format = ((flags & PyBUF_FORMAT) != 0) ? (char *)"f" : NULL;
+    view->ndim = 1;
+    view->shape = ((flags & PyBUF_ND) != 0) ? shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? &view->itemsize : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+
+/* `epid.Bank` */
+
+typedef struct {
+    PyObject_HEAD
+    epid_bank_t bank;
+    void *raw;
+    Py_ssize_t shape[1]; /* `EPID_BANK_MEM_LEN(n)` */
+} epid_py_bank_t;
+
+
+static int Bank_init(epid_py_bank_t *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"n", NULL};
+    Py_ssize_t n;
+    float *mem;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &n)) {
+        return -1;
+    }
+    if ((self->raw != NULL) || (n <= 0)) {
+        PyErr_SetString(PyExc_ValueError, "Bank(n): Expected `n > 0`, once");
+        return -1;
+    }
+    if ((mem = epid_py_alloc(EPID_BANK_MEM_LEN((size_t)n), &self->raw)) == NULL) {
+        return -1;
+    }
+    (void)epid_bank_init(&self->bank, mem, (size_t)n);
+    self->shape[0] = (Py_ssize_t)EPID_BANK_MEM_LEN((size_t)n);
+    return 0;
+}
+
+
+static void Bank_dealloc(epid_py_bank_t *self)
+{
+    PyMem_Free(self->raw);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+static int Bank_getbuffer(epid_py_bank_t *self, Py_buffer *view, int flags)
+{
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "Bank: Not initialized");
+        return -1;
+    }
+    return epid_py_getbuffer((PyObject *)self, view, flags, self->bank.kp, self->shape);
+}
+
+
+static PyObject *Bank_set(epid_py_bank_t *self, PyObject *args)
+{
+    Py_ssize_t i;
+    float xk_1, xk_2, y_previous, kp, ki, kd;
+
+    if (!PyArg_ParseTuple(args, "nffffff", &i, &xk_1, &xk_2, &y_previous, &kp, &ki, &kd)) {
+        return NULL;
+    }
+    if ((self->raw == NULL) || (i < 0) || ((size_t)i >= self->bank.n)
+     || (epid_bank_set(&self->bank, (size_t)i, xk_1, xk_2, y_previous, kp, ki, kd) != EPID_ERR_NONE)
+    ) {
+        PyErr_SetString(PyExc_ValueError, "epid_bank_set() error");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *Bank_step(epid_py_bank_t *self, PyObject *args, int pid)
+{
+    PyObject *sp_obj, *pv_obj;
+    Py_buffer sp, pv;
+    float out_min, out_max;
+    size_t n;
+
+    if (!PyArg_ParseTuple(args, "OOff", &sp_obj, &pv_obj, &out_min, &out_max)) {
+        return NULL;
+    }
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "Bank: Not initialized");
+        return NULL;
+    }
+    n = self->bank.n;
+    if (epid_py_floats(sp_obj, &sp, (Py_ssize_t)n, "setpoints") != 0) {
+        return NULL;
+    }
+    if (epid_py_floats(pv_obj, &pv, (Py_ssize_t)n, "measures") != 0) {
+        PyBuffer_Release(&sp);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (pid) {
+        epid_bank_pid_step(&self->bank, (const float *)sp.buf, (const float *)pv.buf, out_min, out_max, n);
+    }
+    else {
+        epid_bank_pi_step(&self->bank, (const float *)sp.buf, (const float *)pv.buf, out_min, out_max, n);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&pv);
+    PyBuffer_Release(&sp);
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *Bank_pi_step(epid_py_bank_t *self, PyObject *args)
+{
+    return Bank_step(self, args, 0);
+}
+
+
+static PyObject *Bank_pid_step(epid_py_bank_t *self, PyObject *args)
+{
+    return Bank_step(self, args, 1);
+}
+
+
+/* Getters of the bank arrays, `closure`: Array index in the memory block. */
+static PyObject *Bank_array(epid_py_bank_t *self, void *closure)
+{
+    const Py_ssize_t k = (Py_ssize_t)(intptr_t)closure;
+
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "Bank: Not initialized");
+        return NULL;
+    }
+    return epid_py_view((PyObject *)self, k * (Py_ssize_t)EPID_BANK_STRIDE(self->bank.n),
+                        (Py_ssize_t)self->bank.n);
+}
+
+
+static PyObject *Bank_n(epid_py_bank_t *self, void *closure)
+{
+    (void)closure;
+    return PyLong_FromSize_t(self->bank.n);
+}
+
+
+static PyMethodDef Bank_methods[] = {
+    {"set", (PyCFunction)Bank_set, METH_VARARGS,
+     "set(i, xk_1, xk_2, y_previous, kp, ki, kd)\n"
+     "Set the controller `i`, see `epid_bank_set()`. Raise `ValueError` on error."},
+    {"pi_step", (PyCFunction)Bank_pi_step, METH_VARARGS,
+     "pi_step(setpoints, measures, out_min, out_max)\n"
+     "Type-C PI step of all controllers, see `epid_bank_pi_step()`."},
+    {"pid_step", (PyCFunction)Bank_pid_step, METH_VARARGS,
+     "pid_step(setpoints, measures, out_min, out_max)\n"
+     "Type-C PID step of all controllers, see `epid_bank_pid_step()`."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef Bank_getset[] = {
+    {"kp", (getter)Bank_array, NULL, "Gains `Kp` (view).", (void *)0},
+    {"ki", (getter)Bank_array, NULL, "Gains `Ki` (view).", (void *)1},
+    {"kd", (getter)Bank_array, NULL, "Gains `Kd` (view).", (void *)2},
+    {"xk_1", (getter)Bank_array, NULL, "Measurements `PV[k-1]` (view).", (void *)3},
+    {"xk_2", (getter)Bank_array, NULL, "Measurements `PV[k-2]` (view).", (void *)4},
+    {"y_out", (getter)Bank_array, NULL, "Outputs (CV) (view).", (void *)5},
+    {"n", (getter)Bank_n, NULL, "Number of controllers.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyBufferProcs Bank_buffer = {
+    (getbufferproc)Bank_getbuffer,
+    NULL
+};
+
+static PyTypeObject Bank_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "epid.Bank",
+    .tp_doc = "Bank(n): Bank of `n` Type-C PI/PID controllers, see <pid_bank.h>.\n"
+              "The buffer is the bank memory block.",
+    .tp_basicsize = sizeof(epid_py_bank_t),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)Bank_init,
+    .tp_dealloc = (destructor)Bank_dealloc,
+    .tp_as_buffer = &Bank_buffer,
+    .tp_methods = Bank_methods,
+    .tp_getset = Bank_getset,
+};
+
+
+/* `epid.LpfBank` */
+
+typedef struct {
+    PyObject_HEAD
+    epid_lpf_bank_t bank;
+    void *raw;
+    Py_ssize_t shape[1]; /* `EPID_LPF_BANK_MEM_LEN(n)` */
+} epid_py_lpf_bank_t;
+
+
+static int LpfBank_init(epid_py_lpf_bank_t *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"n", NULL};
+    Py_ssize_t n;
+    float *mem;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "n", kwlist, &n)) {
+        return -1;
+    }
+    if ((self->raw != NULL) || (n <= 0)) {
+        PyErr_SetString(PyExc_ValueError, "LpfBank(n): Expected `n > 0`, once");
+        return -1;
+    }
+    if ((mem = epid_py_alloc(EPID_LPF_BANK_MEM_LEN((size_t)n), &self->raw)) == NULL) {
+        return -1;
+    }
+    (void)epid_lpf_bank_init(&self->bank, mem, (size_t)n);
+    self->shape[0] = (Py_ssize_t)EPID_LPF_BANK_MEM_LEN((size_t)n);
+    return 0;
+}
+
+
+static void LpfBank_dealloc(epid_py_lpf_bank_t *self)
+{
+    PyMem_Free(self->raw);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+
+static int LpfBank_getbuffer(epid_py_lpf_bank_t *self, Py_buffer *view, int flags)
+{
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "LpfBank: Not initialized");
+        return -1;
+    }
+    return epid_py_getbuffer((PyObject *)self, view, flags, self->bank.smoothing_factor, self->shape);
+}
+
+
+static PyObject *LpfBank_set(epid_py_lpf_bank_t *self, PyObject *args)
+{
+    Py_ssize_t i;
+    float smoothing_factor, x_0;
+
+    if (!PyArg_ParseTuple(args, "nff", &i, &smoothing_factor, &x_0)) {
+        return NULL;
+    }
+    if ((self->raw == NULL) || (i < 0) || ((size_t)i >= self->bank.n)
+     || (epid_lpf_bank_set(&self->bank, (size_t)i, smoothing_factor, x_0) != EPID_ERR_NONE)
+    ) {
+        PyErr_SetString(PyExc_ValueError, "epid_lpf_bank_set() error");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *LpfBank_calc(epid_py_lpf_bank_t *self, PyObject *arg)
+{
+    Py_buffer x;
+
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "LpfBank: Not initialized");
+        return NULL;
+    }
+    if (epid_py_floats(arg, &x, (Py_ssize_t)self->bank.n, "inputs") != 0) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    epid_lpf_bank_calc(&self->bank, (const float *)x.buf, self->bank.n);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&x);
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *LpfBank_array(epid_py_lpf_bank_t *self, void *closure)
+{
+    const Py_ssize_t k = (Py_ssize_t)(intptr_t)closure;
+
+    if (self->raw == NULL) {
+        PyErr_SetString(PyExc_ValueError, "LpfBank: Not initialized");
+        return NULL;
+    }
+    return epid_py_view((PyObject *)self, k * (Py_ssize_t)EPID_BANK_STRIDE(self->bank.n),
+                        (Py_ssize_t)self->bank.n);
+}
+
+
+static PyObject *LpfBank_n(epid_py_lpf_bank_t *self, void *closure)
+{
+    (void)closure;
+    return PyLong_FromSize_t(self->bank.n);
+}
+
+
+static PyMethodDef LpfBank_methods[] = {
+    {"set", (PyCFunction)LpfBank_set, METH_VARARGS,
+     "set(i, smoothing_factor, x_0)\n"
+     "Set the filter `i`, see `epid_lpf_bank_set()`. Raise `ValueError` on error."},
+    {"calc", (PyCFunction)LpfBank_calc, METH_O,
+     "calc(inputs)\n"
+     "Filter one input of all filters, see `epid_lpf_bank_calc()`."},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyGetSetDef LpfBank_getset[] = {
+    {"smoothing_factor", (getter)LpfBank_array, NULL, "Smoothing factors (view).", (void *)0},
+    {"y", (getter)LpfBank_array, NULL, "Filters outputs (view).", (void *)1},
+    {"n", (getter)LpfBank_n, NULL, "Number of filters.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyBufferProcs LpfBank_buffer = {
+    (getbufferproc)LpfBank_getbuffer,
+    NULL
+};
+
+static PyTypeObject LpfBank_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    .tp_name = "epid.LpfBank",
+    .tp_doc = "LpfBank(n): Bank of `n` low-pass filters, see <pid_bank.h>.\n"
+              "The buffer is the bank memory block.",
+    .tp_basicsize = sizeof(epid_py_lpf_bank_t),
+    .tp_flags = Py_TPFLAGS_DEFAULT,
+    .tp_new = PyType_GenericNew,
+    .tp_init = (initproc)LpfBank_init,
+    .tp_dealloc = (destructor)LpfBank_dealloc,
+    .tp_as_buffer = &LpfBank_buffer,
+    .tp_methods = LpfBank_methods,
+    .tp_getset = LpfBank_getset,
+};
+
+
+/* `epid.simulate()` */
+
+/* Get a float item of a dict, `def` if missing. Return -1 on error. */
+static int epid_py_dict_float(PyObject *dict, const char *key, float def, float *out)
+{
+    PyObject *v = PyDict_GetItemString(dict, key);
+
+    if (v == NULL) {
+        *out = def;
+        return 0;
+    }
+    *out = (float)PyFloat_AsDouble(v);
+    return ((*out == -1.0f) && PyErr_Occurred()) ? -1 : 0;
+}
+
+
+/* Get `n` floats of a dict item: A number, or a float32 buffer of `n` values
+ * (`*n == 0`: Any length, set to the array length). Copied into `*out`
+ * (`PyMem_Malloc()`), as `count` copies of the number for a number.
+ */
+static int epid_py_dict_floats(PyObject *dict, const char *key, float def,
+                               Py_ssize_t *n, Py_ssize_t count, float **out)
+{
+    PyObject *v = PyDict_GetItemString(dict, key);
+    Py_ssize_t len;
+    Py_buffer view;
+    float x = def;
+
+    if ((v != NULL) && PyObject_CheckBuffer(v)) {
+        if (epid_py_floats(v, &view, (*n != 0) ? *n : -1, key) != 0) {
+            return -1;
+        }
+        len = view.len / view.itemsize;
+        if (len == 0) {
+            PyErr_Format(PyExc_ValueError, "%s: Expected values", key);
+            PyBuffer_Release(&view);
+            return -1;
+        }
+        if ((*out = (float *)PyMem_Malloc((size_t)len * sizeof(float))) == NULL) {
+            PyBuffer_Release(&view);
+            PyErr_NoMemory();
+            return -1;
+        }
+        memcpy(*out, view.buf, (size_t)view.len);
+        PyBuffer_Release(&view);
+        *n = len;
+        return 0;
+    }
+
+    if ((v != NULL) && (epid_py_dict_float(dict, key, def, &x) != 0)) {
+        return -1;
+    }
+    if ((*out = (float *)PyMem_Malloc((size_t)count * sizeof(float))) == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        (*out)[i] = x;
+    }
+    return 0;
+}
+
+
+/* A new float32 array over a `bytearray`, shape `(rows,)` or `(rows, cols)` if `cols != 0`. */
+static PyObject *epid_py_new_array(Py_ssize_t rows, Py_ssize_t cols, float **data)
+{
+    const Py_ssize_t count = rows * ((cols != 0) ? cols : 1);
+    PyObject *ba = PyByteArray_FromStringAndSize(NULL, count * (Py_ssize_t)sizeof(float));
+    PyObject *mv, *shape, *arr;
+
+    if (ba == NULL) {
+        return NULL;
+    }
+    *data = (float *)(void *)PyByteArray_AS_STRING(ba);
+    mv = PyMemoryView_FromObject(ba);
+    Py_DECREF(ba);
+    if (mv == NULL) {
+        return NULL;
+    }
+    shape = (cols != 0) ? Py_BuildValue("(nn)", rows, cols) : Py_BuildValue("(n)", rows);
+    arr = (shape != NULL) ? PyObject_CallMethod(mv, "cast", "sO", "f", shape) : NULL;
+    Py_XDECREF(shape);
+    Py_DECREF(mv);
+    return epid_py_array(arr);
+}
+
+
+/* Plants of `simulate()`, one model for all loops, see <pid_plant.h>. */
+enum {
+    EPID_PY_THERMAL,
+    EPID_PY_FOPDT,
+    EPID_PY_SO,
+    EPID_PY_INT
+};
+
+typedef struct {
+    int model;
+    union {
+        epid_plant_thermal_t thermal;
+        epid_plant_fopdt_t fopdt;
+        epid_plant_so_t so;
+        epid_plant_int_t integ;
+    } ctx;
+    float *y; /* Outputs of the model context. */
+    void *raw;
+} epid_py_plant_t;
+
+
+/* Model names, to `EPID_PY_*`; "heating" is "thermal" with its defaults. */
+static const struct {
+    const char *name;
+    int model;
+} epid_py_models[] = {
+    {"heating", EPID_PY_THERMAL},
+    {"thermal", EPID_PY_THERMAL},
+    {"first_order", EPID_PY_FOPDT},
+    {"fopdt", EPID_PY_FOPDT},
+    {"second_order", EPID_PY_SO},
+    {"integrating", EPID_PY_INT}
+};
+
+
+/* Set `n` plants from the `plant` dict, see `simulate_doc`. Return -1 on error. */
+static int epid_py_plant_open(epid_py_plant_t *plant, PyObject *dict, Py_ssize_t n, float dt)
+{
+    static const char *const keys[][5] = {
+        {"C", "h", "ambient", "y0", NULL},
+        {"K", "tau", "y0", "u0", NULL},
+        {"K", "wn", "zeta", "y0", NULL},
+        {"K", "y0", NULL, NULL, NULL}
+    };
+    static const float defaults[][4] = {
+        {4.186f*100.0f, 11.3f*6.0f*0.0025f, 20.0f, 20.0f}, /* `extras/testing/main.c` */
+        {1.0f, 1.0f, 0.0f, 0.0f},
+        {1.0f, 1.0f, 1.0f, 0.0f},
+        {1.0f, 0.0f, 0.0f, 0.0f}
+    };
+    PyObject *model_obj = PyDict_GetItemString(dict, "model");
+    float *p[4] = {NULL, NULL, NULL, NULL};
+    epid_info_t err = EPID_ERR_NONE;
+    long delay = 0;
+    size_t len = 0U;
+    float *mem;
+    int ret = -1;
+
+    plant->model = EPID_PY_THERMAL;
+    plant->raw = NULL;
+    if (model_obj != NULL) {
+        size_t m = 0U;
+
+        for (; m < (sizeof(epid_py_models) / sizeof(epid_py_models[0])); m++) {
+            if (PyUnicode_Check(model_obj)
+             && (PyUnicode_CompareWithASCIIString(model_obj, epid_py_models[m].name) == 0)) {
+                break;
+            }
+        }
+        if (m == (sizeof(epid_py_models) / sizeof(epid_py_models[0]))) {
+            PyErr_SetString(PyExc_ValueError, "plant: Unknown model");
+            return -1;
+        }
+        plant->model = epid_py_models[m].model;
+    }
+
+    /* Numbers, or float32 arrays of `n` values (a parameter per loop). */
+    for (int k = 0; (k < 4) && (keys[plant->model][k] != NULL); k++) {
+        Py_ssize_t n_k = n;
+
+        if (epid_py_dict_floats(dict, keys[plant->model][k], defaults[plant->model][k], &n_k, n, &p[k]) != 0) {
+            goto out;
+        }
+    }
+    if (plant->model == EPID_PY_FOPDT) {
+        PyObject *v = PyDict_GetItemString(dict, "delay");
+
+        if (v != NULL) {
+            delay = PyLong_AsLong(v);
+            if ((delay < 0) || (delay > 0xFFFFFFL)) {
+                if (!PyErr_Occurred()) {
+                    PyErr_SetString(PyExc_ValueError, "plant: Expected `0 <= delay` (samples)");
+                }
+                goto out;
+            }
+        }
+    }
+
+    switch (plant->model) {
+    case EPID_PY_FOPDT: len = EPID_PLANT_FOPDT_MEM_LEN((size_t)n, (size_t)delay); break;
+    case EPID_PY_SO: len = EPID_PLANT_SO_MEM_LEN((size_t)n); break;
+    case EPID_PY_INT: len = EPID_PLANT_INT_MEM_LEN((size_t)n); break;
+    default: len = EPID_PLANT_THERMAL_MEM_LEN((size_t)n); break;
+    }
+    if ((mem = epid_py_alloc(len, &plant->raw)) == NULL) {
+        goto out;
+    }
+
+    switch (plant->model) {
+    case EPID_PY_FOPDT:
+        (void)epid_plant_fopdt_init(&plant->ctx.fopdt, mem, (size_t)n, (uint32_t)delay);
+        plant->y = plant->ctx.fopdt.y;
+        break;
+    case EPID_PY_SO:
+        (void)epid_plant_so_init(&plant->ctx.so, mem, (size_t)n);
+        plant->y = plant->ctx.so.y;
+        break;
+    case EPID_PY_INT:
+        (void)epid_plant_int_init(&plant->ctx.integ, mem, (size_t)n);
+        plant->y = plant->ctx.integ.y;
+        break;
+    default:
+        (void)epid_plant_thermal_init(&plant->ctx.thermal, mem, (size_t)n);
+        plant->y = plant->ctx.thermal.y;
+        break;
+    }
+
+    for (Py_ssize_t i = 0; (i < n) && (err == EPID_ERR_NONE); i++) {
+        switch (plant->model) {
+        case EPID_PY_FOPDT:
+            err = epid_plant_fopdt_set(&plant->ctx.fopdt, (size_t)i, p[0][i], p[1][i], dt, p[2][i], p[3][i]);
+            break;
+        case EPID_PY_SO:
+            err = epid_plant_so_set(&plant->ctx.so, (size_t)i, p[0][i], p[1][i], p[2][i], dt, p[3][i]);
+            break;
+        case EPID_PY_INT:
+            err = epid_plant_int_set(&plant->ctx.integ, (size_t)i, p[0][i], dt, p[1][i]);
+            break;
+        default:
+            err = epid_plant_thermal_set(&plant->ctx.thermal, (size_t)i, p[0][i], p[1][i], p[2][i], dt, p[3][i]);
+            break;
+        }
+        if (err != EPID_ERR_NONE) {
+            PyErr_Format(PyExc_ValueError, "epid_plant_*_set() error, loop %zd", i);
+        }
+    }
+    ret = (err == EPID_ERR_NONE) ? 0 : -1;
+
+out:
+    for (int k = 0; k < 4; k++) {
+        PyMem_Free(p[k]);
+    }
+    if (ret != 0) {
+        PyMem_Free(plant->raw);
+        plant->raw = NULL;
+    }
+    return ret;
+}
+
+
+static void epid_py_plant_step(epid_py_plant_t *plant, const float *u)
+{
+    switch (plant->model) {
+    case EPID_PY_FOPDT: epid_plant_fopdt_step(&plant->ctx.fopdt, u); break;
+    case EPID_PY_SO: epid_plant_so_step(&plant->ctx.so, u); break;
+    case EPID_PY_INT: epid_plant_int_step(&plant->ctx.integ, u); break;
+    default: epid_plant_thermal_step(&plant->ctx.thermal, u); break;
+    }
+}
+
+
+PyDoc_STRVAR(simulate_doc,
+"simulate(plant, controller, n_steps)\n"
+"Run `n_steps` samples of closed loops in C, one loop per controller,\n"
+"controllers processed as a `Bank`. Every sample:\n"
+"`PV[k]` is measured, the controllers step, then the plant steps with `CV[k]`.\n"
+"\n"
+"plant: dict, a model of <pid_plant.h> for all loops\n"
+"  model: Name, and parameters as numbers or float32 arrays of `n` loops:\n"
+"    \"heating\" (default, `extras/testing/main.c`), \"thermal\":\n"
+"      C (418.6 J/C), h (0.1695 W/C), ambient (20.0), y0 (20.0);\n"
+"    \"first_order\", \"fopdt\": K (1.0), tau (1.0), y0 (0.0), u0 (0.0),\n"
+"      and delay, the dead time in samples (0);\n"
+"    \"second_order\": K (1.0), wn (1.0), zeta (1.0), y0 (0.0);\n"
+"    \"integrating\": K (1.0), y0 (0.0).\n"
+"  dt: Sample period (default 0.1).\n"
+"controller: dict\n"
+"  kp, ki, kd: Gains, numbers or float32 arrays of `n` loops, `n` is the\n"
+"    gains arrays length, 1 without (default 500.0, 10.0, 200.0).\n"
+"  type: \"pid\" (default) or \"pi\".\n"
+"  out_min, out_max: Output limits (default 0.0, 500.0).\n"
+"  setpoint: Number, or float32 array of `n_steps` values (default 70.0).\n"
+"\n"
+"Return: dict of float32 arrays, \"time\" and \"sp\" of shape `(n_steps,)`,\n"
+"\"pv\" and \"cv\" of shape `(n_steps, n)`.");
+
+static PyObject *epid_py_simulate(PyObject *self, PyObject *args)
+{
+    PyObject *plant_obj, *ctrl_obj, *type_obj;
+    PyObject *time_arr = NULL, *sp_arr = NULL, *pv_arr = NULL, *cv_arr = NULL, *ret = NULL;
+    Py_ssize_t n_steps, n = 0, n_sp;
+    epid_py_plant_t plant = {0};
+    float dt;
+    float *kp = NULL, *ki = NULL, *kd = NULL, *sp_in = NULL;
+    float *time_out, *sp_out, *pv_out, *cv_out;
+    float *sp_k = NULL, *mem;
+    void *raw = NULL;
+    float out_min, out_max;
+    epid_bank_t bank;
+    int pid = 1;
+
+    (void)self;
+    if (!PyArg_ParseTuple(args, "O!O!n", &PyDict_Type, &plant_obj, &PyDict_Type, &ctrl_obj, &n_steps)) {
+        return NULL;
+    }
+    if (n_steps <= 0) {
+        PyErr_SetString(PyExc_ValueError, "n_steps: Expected `n_steps > 0`");
+        return NULL;
+    }
+
+    if (epid_py_dict_float(plant_obj, "dt", 0.1f, &dt) != 0) {
+        return NULL;
+    }
+
+    /* Controllers: `n` from the first gains array, numbers are broadcast. */
+    type_obj = PyDict_GetItemString(ctrl_obj, "type");
+    if (type_obj != NULL) {
+        if (PyUnicode_Check(type_obj) && (PyUnicode_CompareWithASCIIString(type_obj, "pi") == 0)) {
+            pid = 0;
+        }
+        else if (!PyUnicode_Check(type_obj) || (PyUnicode_CompareWithASCIIString(type_obj, "pid") != 0)) {
+            PyErr_SetString(PyExc_ValueError, "controller: Unknown type");
+            return NULL;
+        }
+    }
+    {
+        static const char *const keys[] = {"kp", "ki", "kd"};
+        for (int k = 0; k < 3; k++) {
+            PyObject *v = PyDict_GetItemString(ctrl_obj, keys[k]);
+            if ((v != NULL) && PyObject_CheckBuffer(v)) {
+                Py_buffer view;
+                if (epid_py_floats(v, &view, -1, keys[k]) != 0) {
+                    return NULL;
+                }
+                n = view.len / view.itemsize;
+                PyBuffer_Release(&view);
+                break;
+            }
+        }
+        n = (n != 0) ? n : 1;
+    }
+    n_sp = n_steps;
+    if ((epid_py_dict_floats(ctrl_obj, "kp", 500.0f, &n, n, &kp) != 0)
+     || (epid_py_dict_floats(ctrl_obj, "ki", 10.0f, &n, n, &ki) != 0)
+     || (epid_py_dict_floats(ctrl_obj, "kd", 200.0f, &n, n, &kd) != 0)
+     || (epid_py_dict_floats(ctrl_obj, "setpoint", 70.0f, &n_sp, n_steps, &sp_in) != 0)
+     || (epid_py_dict_float(ctrl_obj, "out_min", 0.0f, &out_min) != 0)
+     || (epid_py_dict_float(ctrl_obj, "out_max", 500.0f, &out_max) != 0)
+    ) {
+        goto out;
+    }
+
+    if (epid_py_plant_open(&plant, plant_obj, n, dt) != 0) {
+        goto out;
+    }
+    if (((mem = epid_py_alloc(EPID_BANK_MEM_LEN((size_t)n), &raw)) == NULL)
+     || ((sp_k = (float *)PyMem_Malloc((size_t)n * sizeof(float))) == NULL)
+    ) {
+        PyErr_NoMemory();
+        goto out;
+    }
+    (void)epid_bank_init(&bank, mem, (size_t)n);
+    for (Py_ssize_t i = 0; i < n; i++) {
+        /* At rest: `x[k-1] = x[k-2] = y[0]` of the plant. */
+        if (epid_bank_set(&bank, (size_t)i, plant.y[i], plant.y[i], 0.0f, kp[i], ki[i], kd[i]) != EPID_ERR_NONE) {
+            PyErr_Format(PyExc_ValueError, "epid_bank_set() error, loop %zd", i);
+            goto out;
+        }
+    }
+
+    if (((time_arr = epid_py_new_array(n_steps, 0, &time_out)) == NULL)
+     || ((sp_arr = epid_py_new_array(n_steps, 0, &sp_out)) == NULL)
+     || ((pv_arr = epid_py_new_array(n_steps, n, &pv_out)) == NULL)
+     || ((cv_arr = epid_py_new_array(n_steps, n, &cv_out)) == NULL)
+    ) {
+        goto out;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (Py_ssize_t k = 0; k < n_steps; k++) {
+        const float sp = sp_in[k];
+        float *pv = pv_out + (k * n);
+
+        for (Py_ssize_t i = 0; i < n; i++) {
+            sp_k[i] = sp;
+        }
+        memcpy(pv, plant.y, (size_t)n * sizeof(float)); /* Measure */
+        if (pid) {
+            epid_bank_pid_step(&bank, sp_k, pv, out_min, out_max, (size_t)n);
+        }
+        else {
+            epid_bank_pi_step(&bank, sp_k, pv, out_min, out_max, (size_t)n);
+        }
+        epid_py_plant_step(&plant, bank.y_out);
+
+        memcpy(cv_out + (k * n), bank.y_out, (size_t)n * sizeof(float));
+        time_out[k] = (float)((double)k * (double)dt);
+        sp_out[k] = sp;
+    }
+    Py_END_ALLOW_THREADS
+
+    ret = Py_BuildValue("{sOsOsOsO}", "time", time_arr, "sp", sp_arr, "pv", pv_arr, "cv", cv_arr);
+
+out:
+    Py_XDECREF(time_arr);
+    Py_XDECREF(sp_arr);
+    Py_XDECREF(pv_arr);
+    Py_XDECREF(cv_arr);
+    PyMem_Free(sp_k);
+    PyMem_Free(raw);
+    PyMem_Free(plant.raw);
+    PyMem_Free(sp_in);
+    PyMem_Free(kd);
+    PyMem_Free(ki);
+    PyMem_Free(kp);
+    return ret;
+}
+
+
+static PyObject *epid_py_kernel_name(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+    return PyUnicode_FromString(epid_bank_kernel_name());
+}
+
+
+static PyMethodDef epid_py_methods[] = {
+    {"simulate", epid_py_simulate, METH_VARARGS, simulate_doc},
+    {"kernel_name", epid_py_kernel_name, METH_NOARGS,
+     "kernel_name()\nName of the banks kernel, see `epid_bank_kernel_name()`."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef epid_py_module = {
+    PyModuleDef_HEAD_INIT,
+    "epid",
+    "EPID controllers and LPF banks over NumPy arrays, and closed loop simulations.",
+    -1,
+    epid_py_methods,
+    NULL, NULL, NULL, NULL
+};
+
+
+PyMODINIT_FUNC PyInit_epid(void)
+{
+    PyObject *m, *numpy;
+
+    if ((PyType_Ready(&Bank_type) < 0) || (PyType_Ready(&LpfBank_type) < 0)) {
+        return NULL;
+    }
+    if ((m = PyModule_Create(&epid_py_module)) == NULL) {
+        return NULL;
+    }
+
+    /* NumPy is optional, views are `memoryview` objects without it. */
+    numpy = PyImport_ImportModule("numpy");
+    if (numpy != NULL) {
+        numpy_asarray = PyObject_GetAttrString(numpy, "asarray");
+        Py_DECREF(numpy);
+    }
+    PyErr_Clear();
+
+    Py_INCREF(&Bank_type);
+    Py_INCREF(&LpfBank_type);
+    if ((PyModule_AddObject(m, "Bank", (PyObject *)&Bank_type) < 0)
+     || (PyModule_AddObject(m, "LpfBank", (PyObject *)&LpfBank_type) < 0)
+     || (PyModule_AddStringConstant(m, "__version__", EPID_LIB_VERSION) < 0)
+    ) {
+        Py_DECREF(&LpfBank_type);
+        Py_DECREF(&Bank_type);
+        Py_DECREF(m);
+        return NULL;
+    }
+
+    return m;
+}
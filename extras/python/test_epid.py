@@ -0,0 +1,168 @@
+# SPDX-License-Identifier: ISC
+# Copyright (c) 2020 Abderraouf Adjal
+"""Smoke test of the `epid` module (`epidmodule.c`), run from its build directory.
+
+    python3 test_epid.py [main]
+
+- Views: `Bank` and `LpfBank` arrays are views of the bank memory block
+  (writes by a view or by a step are seen by the others, no copies).
+- `simulate()`: The "heating" model matches `extras/testing/main.c` output
+  up to its first disturbance (t = 100 s), as printed (`%f`). `main` is the
+  path of a `main.c` build; Without it, `main.c` is built with `cc` by the
+  command of its first lines, in a temporary directory.
+- Errors: Arguments of wrong lengths or formats raise, and are not used.
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+
+import epid
+
+TESTING = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "testing")
+
+fails = 0
+
+
+def check(ok, what):
+    global fails
+    if not ok:
+        print("Failed: %s" % what, file=sys.stderr)
+        fails += 1
+
+
+def raises(exc, fn, *args):
+    try:
+        fn(*args)
+    except exc:
+        return True
+    except Exception as e:  # Another exception type.
+        print("  %r" % e, file=sys.stderr)
+    return False
+
+
+def check_views():
+    n = 37  # Not a multiple of the vectors lanes.
+    bank = epid.Bank(n)
+    kp = bank.kp  # Taken before the writes.
+    y_out = bank.y_out
+    block = np.frombuffer(bank, dtype=np.float32)
+
+    check(isinstance(kp, np.ndarray) and (kp.dtype == np.float32) and (kp.shape == (n,)),
+          "Bank.kp: float32 array of n values")
+    check(np.shares_memory(kp, block) and np.shares_memory(y_out, block),
+          "Bank views share the bank memory block")
+
+    bank.set(3, 20.0, 20.0, 0.0, 2.0, 0.5, 0.25)
+    check((kp[3] == 2.0) and (bank.ki[3] == 0.5), "Bank.set() seen by a view")
+
+    kp[4] = 7.0
+    check(bank.kp[4] == 7.0, "View write seen by another view")
+
+    for i in range(n):
+        bank.set(i, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0)
+    sp = np.ones(n, dtype=np.float32)
+    pv = np.zeros(n, dtype=np.float32)
+    bank.pi_step(sp, pv, -10.0, 10.0)
+    # `y[1] = y[0] + Kp * (x[0] - x[1]) + Ki * (SP - x[1])` = 1
+    check(np.array_equal(y_out, np.ones(n, dtype=np.float32)), "Bank.pi_step() seen by a view")
+
+    lpf = epid.LpfBank(n)
+    y = lpf.y
+    for i in range(n):
+        lpf.set(i, 0.5, 0.0)
+    lpf.calc(np.full(n, 2.0, dtype=np.float32))
+    check(np.array_equal(y, np.ones(n, dtype=np.float32)), "LpfBank.calc() seen by a view")
+    check(np.shares_memory(y, np.frombuffer(lpf, dtype=np.float32)),
+          "LpfBank views share the bank memory block")
+
+
+def main_rows(main):
+    """Rows of `main.c` output: (t, PV, CV) strings."""
+    tmp = None
+    if main is None:
+        cc = shutil.which("cc") or shutil.which("gcc")
+        if cc is None:
+            return None
+        tmp = tempfile.mkdtemp()
+        main = os.path.join(tmp, "main")
+        # As the command of `main.c`, first lines.
+        subprocess.run([cc, "-std=c99", "-O2", "main.c", "../../src/pid_plant.c",
+                        "../../src/pid_trace.c", "-lm", "-o", main],
+                       cwd=TESTING, check=True)
+    try:
+        out = subprocess.run([main], check=True, stdout=subprocess.PIPE,
+                             universal_newlines=True).stdout
+    finally:
+        if tmp is not None:
+            shutil.rmtree(tmp)
+    return [line.split("\t")[:3] for line in out.splitlines()[1:]]
+
+
+def check_simulate(main):
+    rows = main_rows(main)
+    if rows is None:
+        print("simulate\tskipped (no C compiler)")
+        return
+    # Before the disturbance of `main.c` at t = 100 s.
+    rows = [r for r in rows if float(r[0]) < 100.0]
+    r = epid.simulate({"model": "heating", "dt": 0.1}, {"setpoint": 70.0}, len(rows))
+
+    check((r["pv"].shape == (len(rows), 1)) and (r["pv"].dtype == np.float32),
+          "simulate(): pv shape and type")
+    same = all((("%f" % r["pv"][k, 0]) == rows[k][1]) and (("%f" % r["cv"][k, 0]) == rows[k][2])
+               for k in range(len(rows)))
+    check(same, "simulate() versus main.c")
+    print("simulate\t%d steps versus main.c" % len(rows))
+
+
+def check_errors():
+    n = 8
+    bank = epid.Bank(n)
+    lpf = epid.LpfBank(n)
+    f32 = np.zeros(n, dtype=np.float32)
+    before = bank.y_out.copy()
+
+    check(raises(ValueError, bank.pid_step, np.zeros(n - 1, dtype=np.float32), f32, 0.0, 1.0),
+          "Bank.pid_step(): setpoints length")
+    check(raises(ValueError, bank.pid_step, f32, np.zeros(n + 1, dtype=np.float32), 0.0, 1.0),
+          "Bank.pid_step(): measures length")
+    check(raises(TypeError, bank.pi_step, np.zeros(n, dtype=np.float64), f32, 0.0, 1.0),
+          "Bank.pi_step(): float64 setpoints")
+    check(raises(TypeError, bank.pi_step, f32, np.zeros(n, dtype=np.int32), 0.0, 1.0),
+          "Bank.pi_step(): int32 measures")
+    check(raises((BufferError, ValueError), bank.pi_step, np.zeros(2 * n, dtype=np.float32)[::2], f32, 0.0, 1.0),
+          "Bank.pi_step(): Not contiguous setpoints")
+    check(raises(TypeError, bank.pi_step, [0.0] * n, f32, 0.0, 1.0),
+          "Bank.pi_step(): Not a buffer")
+    check(np.array_equal(bank.y_out, before), "Bank: No step on errors")
+    check(raises(ValueError, lpf.calc, np.zeros(n - 1, dtype=np.float32)),
+          "LpfBank.calc(): inputs length")
+    check(raises(TypeError, lpf.calc, np.zeros(n, dtype=np.float64)),
+          "LpfBank.calc(): float64 inputs")
+    check(raises(ValueError, epid.Bank, 0), "Bank(0)")
+    check(raises(ValueError, bank.set, n, 0.0, 0.0, 0.0, 1.0, 1.0, 0.0), "Bank.set(): index")
+
+    check(raises(ValueError, epid.simulate, {}, {"setpoint": np.zeros(9, dtype=np.float32)}, 10),
+          "simulate(): setpoint length")
+    check(raises(TypeError, epid.simulate, {}, {"kp": np.ones(4)}, 10),
+          "simulate(): float64 gains")
+    check(raises(ValueError, epid.simulate, {}, {"kp": np.ones(4, dtype=np.float32),
+                                                 "ki": np.ones(3, dtype=np.float32)}, 10),
+          "simulate(): gains lengths")
+    check(raises(ValueError, epid.simulate, {"model": "nope"}, {}, 10), "simulate(): model")
+    check(raises(ValueError, epid.simulate, {}, {"type": "pd"}, 10), "simulate(): type")
+    check(raises(ValueError, epid.simulate, {}, {}, 0), "simulate(): n_steps")
+
+
+if __name__ == "__main__":
+    print("Banks kernel: %s" % epid.kernel_name())
+    check_views()
+    check_simulate(sys.argv[1] if len(sys.argv) > 1 else None)
+    check_errors()
+    print("%d failure(s)." % fails, file=sys.stderr)
+    sys.exit(0 if fails == 0 else 1)
@@ -0,0 +1,87 @@
+# SPDX-License-Identifier: ISC
+# Copyright (c) 2020 Abderraouf Adjal
+"""Zero-copy NumPy loader of EPID trace files (`src/pid_trace.h`).
+
+The file is memory-mapped and every column is a NumPy view of the map, so
+opening a trace does not read it: Pages are read from the file when used.
+
+    import epid_trace
+    tr = epid_trace.load("pid.trc")
+    tr.time          # float32, (count,)
+    tr["pv"]         # float32, (count, loops); `tr["pv"][:, 0]` for loop 0.
+    df = tr.frame()  # pandas DataFrame of a loop (a copy).
+"""
+
+import struct
+
+import numpy as np
+
+MAGIC = b"EPIDTRC\0"
+VERSION = 1
+BYTE_ORDER = 0x01020304
+COLUMNS = ("time", "sp", "pv", "cv", "p", "i", "d")
+
+# magic, version, header_size, byte_order, columns, loops, capacity, count, t0, dt, reserved
+_HEADER = "8sHHIIIQQddQ"
+
+
+class Trace:
+    """Columns of a trace file, as read-only views of the file map."""
+
+    def __init__(self, path):
+        self.path = path
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        if self._map.size < struct.calcsize("<" + _HEADER):
+            raise ValueError("%s: Not an EPID trace" % path)
+
+        raw = self._map[:struct.calcsize("<" + _HEADER)].tobytes()
+        endian = "<" if struct.unpack_from("<I", raw, 12)[0] == BYTE_ORDER else ">"
+        (magic, version, header_size, byte_order, columns, loops,
+         capacity, count, t0, dt, _) = struct.unpack(endian + _HEADER, raw)
+        if ((magic != MAGIC) or (byte_order != BYTE_ORDER)
+                or not (1 <= version <= VERSION) or (columns < len(COLUMNS))
+                or (loops < 1) or (count > capacity)
+                or (self._map.size < header_size + 4 * capacity * (1 + 6 * loops))):
+            raise ValueError("%s: Not an EPID trace, or an unsupported version" % path)
+
+        self.version = version
+        self.loops = loops
+        self.capacity = capacity
+        self.count = count
+        self.t0 = t0
+        self.dt = dt
+
+        dtype = np.dtype(endian + "f4")
+        self.columns = {}
+        offset = header_size
+        for name in COLUMNS:
+            width = 1 if name == "time" else loops
+            column = self._map[offset:offset + 4 * count * width].view(dtype)
+            self.columns[name] = column if name == "time" else column.reshape(count, loops)
+            offset += 4 * capacity * width
+
+    def __getitem__(self, name):
+        return self.columns[name]
+
+    @property
+    def time(self):
+        return self.columns["time"]
+
+    def exact_time(self):
+        """Times as `t0 + k * dt` in float64, for uniform traces (a copy)."""
+        if self.dt == 0.0:
+            return self.time.astype(np.float64)
+        return self.t0 + self.dt * np.arange(self.count, dtype=np.float64)
+
+    def frame(self, loop=0):
+        """pandas DataFrame of one loop, columns `COLUMNS` (a copy)."""
+        import pandas as pd
+        data = {"time": self.time}
+        for name in COLUMNS[1:]:
+            data[name] = self.columns[name][:, loop]
+        return pd.DataFrame(data)
+
+
+def load(path):
+    """Open a trace file, see `Trace`."""
+    return Trace(path)
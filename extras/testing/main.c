@@ -1,11 +1,19 @@
-/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
-/* gcc -std=c99 -Wall -Wextra main.c -o main */
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX host. */
+/* gcc -std=c99 -Wall -Wextra main.c ../../src/pid_plant.c ../../src/pid_trace.c -lm -o main */
+
+/* Output: Tab-separated text on `stdout`, or with a `path` argument,
+ * an EPID trace file (see <pid_trace.h> and `epid_trace.py`).
+ * Usage: ./main [path]
+ */
 
 #include <stdio.h>
 #include <math.h>
 
-#include "../src/pid.h"
-#include "../src/pid.c"
+/* Header-only mode, to let the compiler inline the library calls. */
+#define EPID_HEADER_ONLY 1
+#include "../../src/pid.h"
+#include "../../src/pid_plant.h"
+#include "../../src/pid_trace.h"
 
 
 /* Controller parameters */
@@ -29,40 +37,57 @@
 
 epid_t c;
 
+epid_trace_writer_t trace;
+int tracing = 0;
+
+/* Heating system parameters, water to air heat exchanger made in mild steel
+ * (5cm*5cm=0.0025m^2): q [W/(m^2)] = (11.3 W/(m^2 K)) (temp_c-room_temp)
+ */
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
 /* Simulate heating something, run every `Ts` */
-float heating_system_temp_c = 20.0f; /* Sytem memory for measurement. */
-void heating_system(float energy_watt)
+epid_plant_thermal_t heating_system;
+float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+
+
+/* Output a row of the simulation. */
+void output(double t, float setpoint, float measurement)
 {
-    const float room_temp = 20.0f;
-    const float specific_heat = 4.186f; /* Water: joule/gram °C */
-    const float mass = 100.0f; /* mass in grams */
-    const float surface = 6.0f*0.0025f; /* 6 faces of cube in meters^2 */
-    /* Water to Air Heat Exchanger made in Mild Steel (5cm*5cm=0.0025m^2) */
-    /* q [W/(m^2)] = (11.3 W/(m^2 K)) (temp_c-room_temp) */
-    const float q = 11.3*(heating_system_temp_c-room_temp)*surface;
-    float joules = - SAMPLE_TIME_S*(q); /* Get cold, energy out. */
-
-    if (energy_watt > 0.0) {
-        /* Add energy to heat. */
-        joules += SAMPLE_TIME_S*(energy_watt);
+    if (tracing) {
+        if (epid_trace_writer_append_ctx(&trace, (float)t, setpoint, &c) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_trace_writer_append_ctx() error.\n");
+        }
+    }
+    else {
+        printf("%.2f\t%f\t%f\t%f\n", t, measurement, c.y_out, (c.p_term+c.i_term+c.d_term));
     }
-
-    heating_system_temp_c = heating_system_temp_c + (joules/(specific_heat*mass));
 }
 
 
-int main()
+int main(int argc, char *argv[])
 {
     epid_info_t epid_err;
+    /* Initialize the simulated system, at room temperature */
+    if ((epid_plant_thermal_init(&heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_plant_thermal_*() error.\n");
+        return -1;
+    }
+
     /* Initialize PID controller */
 #ifdef EPID_TI
     epid_err = epid_init_T(&c,
-        heating_system_temp_c, heating_system_temp_c, 0.0f
+        heating_system.y[0], heating_system.y[0], 0.0f
         EPID_KP, EPID_TI, EPID_TD,
         SAMPLE_TIME_S);
 #else
     epid_err = epid_init(&c,
-        heating_system_temp_c, heating_system_temp_c, 0.0f,
+        heating_system.y[0], heating_system.y[0], 0.0f,
         EPID_KP, EPID_KI, EPID_KD);
 #endif
 
@@ -76,63 +101,80 @@ int main()
     float measurement;
     float deadband_delta;
 
-    printf("Time (s)\tSystem Sensor (C)\tController Output (W)\tPID Delta\n");
+    if (argc > 1) {
+        /* Capacity: All samples, `t0` 0, uniform times. */
+        if (epid_trace_writer_open(&trace, argv[1],
+                1U, (uint64_t)(SIMULATION_TIME_MAX/SAMPLE_TIME_S) + 2U,
+                0.0, SAMPLE_TIME_S) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_trace_writer_open() error.\n");
+            return -1;
+        }
+        tracing = 1;
+    }
+    else {
+        printf("Time (s)\tSystem Sensor (C)\tController Output (W)\tPID Delta\n");
+    }
     
     double t = 0.0;
     for (; t <= 100.0; t += SAMPLE_TIME_S) {
-        measurement = heating_system_temp_c; /* Get measurement from system */
+        measurement = heating_system.y[0]; /* Get measurement from system */
         epid_pid_calc(&c, setpoint, measurement); /* Calc PID terms values */
         /* Apply deadband filter to `delta[k]`. */
         deadband_delta = c.p_term + c.i_term + c.d_term;
         if ((isfinite(deadband_delta) == 0) || (fabsf(deadband_delta) >= DEADBAND)) {
             epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX); /* Compute new control signal output */
         }
-        heating_system(c.y_out); /* Apply signal to the system */
-        printf("%.2f\t%f\t%f\t%f\n", t, measurement, c.y_out, (c.p_term+c.i_term+c.d_term));
+        epid_plant_thermal_step(&heating_system, &c.y_out); /* Apply signal to the system */
+        output(t, setpoint, measurement);
     }
     /* Simulate putting cold water in the hot container after X s. */
-    heating_system_temp_c = heating_system_temp_c - 7.0f;
+    heating_system.y[0] = heating_system.y[0] - 7.0f;
 
     for (; t <= 150.0; t += SAMPLE_TIME_S) {
-        measurement = heating_system_temp_c; /* Get measurement from system */
+        measurement = heating_system.y[0]; /* Get measurement from system */
         epid_pid_calc(&c, setpoint, measurement); /* Calc PID terms values */
         /* Apply deadband filter to `delta[k]`. */
         deadband_delta = c.p_term + c.i_term + c.d_term;
         if ((isfinite(deadband_delta) == 0) || (fabsf(deadband_delta) >= DEADBAND)) {
             epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX); /* Compute new control signal output */
         }
-        heating_system(c.y_out); /* Apply signal to the system */
-        printf("%.2f\t%f\t%f\t%f\n", t, measurement, c.y_out, (c.p_term+c.i_term+c.d_term));
+        epid_plant_thermal_step(&heating_system, &c.y_out); /* Apply signal to the system */
+        output(t, setpoint, measurement);
     }
     /* Simulate setpoint change. */
     setpoint = setpoint + 7.0f;
 
     for (; t <= 220.0; t += SAMPLE_TIME_S) {
-        measurement = heating_system_temp_c; /* Get measurement from system */
+        measurement = heating_system.y[0]; /* Get measurement from system */
         epid_pid_calc(&c, setpoint, measurement); /* Calc PID terms values */
         /* Apply deadband filter to `delta[k]`. */
         deadband_delta = c.p_term + c.i_term + c.d_term;
         if ((isfinite(deadband_delta) == 0) || (fabsf(deadband_delta) >= DEADBAND)) {
             epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX); /* Compute new control signal output */
         }
-        heating_system(c.y_out); /* Apply signal to the system */
+        epid_plant_thermal_step(&heating_system, &c.y_out); /* Apply signal to the system */
 
-        printf("%.2f\t%f\t%f\t%f\n", t, measurement, c.y_out, (c.p_term+c.i_term+c.d_term));
+        output(t, setpoint, measurement);
     }
     /* Simulate setpoint change. */
     setpoint = setpoint - 2.0f;
 
     for (; t <= SIMULATION_TIME_MAX; t += SAMPLE_TIME_S) {
-        measurement = heating_system_temp_c; /* Get measurement from system */
+        measurement = heating_system.y[0]; /* Get measurement from system */
         epid_pid_calc(&c, setpoint, measurement); /* Calc PID terms values */
         /* Apply deadband filter to `delta[k]`. */
         deadband_delta = c.p_term + c.i_term + c.d_term;
         if ((isfinite(deadband_delta) == 0) || (fabsf(deadband_delta) >= DEADBAND)) {
             epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX); /* Compute new control signal output */
         }
-        heating_system(c.y_out); /* Apply signal to the system */
+        epid_plant_thermal_step(&heating_system, &c.y_out); /* Apply signal to the system */
 
-        printf("%.2f\t%f\t%f\t%f\n", t, measurement, c.y_out, (c.p_term+c.i_term+c.d_term));
+        output(t, setpoint, measurement);
+    }
+
+    if (tracing && (epid_trace_writer_close(&trace) != EPID_ERR_NONE)) {
+        fprintf(stderr, "epid_trace_writer_close() error.\n");
+        return -1;
     }
 
     return 0;
@@ -0,0 +1,233 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -O2 -march=native -Wall -Wextra test_bank.c ../../src/pid.c -lm -o test_bank.bin */
+
+/* Controller banks versus `epid_t` controllers processed by
+ * `epid_pi_calc()` + `epid_pi_sum()` and `epid_pid_calc()` + `epid_pid_sum()`,
+ * and LPF banks versus `epid_lpf_t` filters by `epid_util_lpf_calc()`:
+ * Check that states and outputs are bit for bit identical, for every kernel
+ * that can be dispatched on this CPU (scalar, SSE2, AVX2, AVX-512F, NEON),
+ * with vectors tails (`n % lanes != 0`) and NaN/INF inputs.
+ * Build also without `-std=` and with `-march=native`: GCC contracts
+ * multiply-adds by default, which the library sources must turn off.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h> /* For `NAN` and `INFINITY`. */
+
+#include "../../src/pid.h"
+/* For the kernels, which are static. */
+#include "../../src/pid_bank.c"
+
+
+#define N_MAX 1021U
+#define STEPS 200U
+
+#define PID_LIM_MIN -100.0f
+#define PID_LIM_MAX 100.0f
+
+
+typedef struct {
+    const char *name;
+    epid_bank_kernel_t pi;
+    epid_bank_kernel_t pid;
+    epid_lpf_bank_kernel_t lpf;
+} kernel_t;
+
+static const size_t sizes[] = { 1U, 3U, 4U, 7U, 8U, 15U, 16U, 17U, 31U, 33U, 63U, 65U, N_MAX };
+
+static float bank_mem[EPID_BANK_MEM_LEN(N_MAX)] EPID_ALIGNED(EPID_BANK_ALIGN);
+static float lpf_mem[EPID_LPF_BANK_MEM_LEN(N_MAX)] EPID_ALIGNED(EPID_BANK_ALIGN);
+static epid_t ref[N_MAX];
+static epid_lpf_t lpf_ref[N_MAX];
+static float setpoints[N_MAX];
+static float measures[N_MAX];
+static uint32_t seed;
+
+
+static float rand_range(float lo, float hi)
+{
+    seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+    return lo + (hi - lo) * ((float)(seed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/* Mostly finite inputs, some NaN and INF, and some large enough for INF outputs. */
+static float rand_input(void)
+{
+    const float r = rand_range(0.0f, 1.0f);
+
+    if (r < 0.01f) {
+        return NAN;
+    }
+    else if (r < 0.02f) {
+        return INFINITY;
+    }
+    else if (r < 0.03f) {
+        return -INFINITY;
+    }
+    else if (r < 0.05f) {
+        return rand_range(-3.0e38f, 3.0e38f);
+    }
+    return rand_range(-50.0f, 50.0f);
+}
+
+
+/* Same bit-patterns, or both NaN (NaN payloads are not specified, NaN outputs
+ * are only kept without `EPID_FEATURE_VALID_FLT`).
+ */
+static int same_bits(float a, float b)
+{
+    return (memcmp(&a, &b, sizeof(a)) == 0) || ((a != a) && (b != b));
+}
+
+
+/* Run a kernel and the reference for `STEPS` steps, return the mismatches. */
+static unsigned long check(const kernel_t *k, int is_pid, size_t n)
+{
+    epid_bank_t bank;
+    unsigned long fails = 0UL;
+
+    seed = (uint32_t)n;
+    epid_bank_init(&bank, bank_mem, n);
+    for (size_t i = 0U; i < n; i++) {
+        const float x = rand_range(-50.0f, 50.0f);
+        const float kp = rand_range(0.01f, 10.0f);
+        const float ki = rand_range(0.01f, 10.0f);
+        const float kd = (i % 5U) ? rand_range(0.0f, 10.0f) : 0.0f;
+
+        if ((epid_init(&ref[i], x, x, 0.0f, kp, ki, kd) != EPID_ERR_NONE)
+         || (epid_bank_set(&bank, i, x, x, 0.0f, kp, ki, kd) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (size_t s = 0U; s < STEPS; s++) {
+        for (size_t i = 0U; i < n; i++) {
+            setpoints[i] = rand_input();
+            measures[i] = rand_input();
+        }
+
+        (is_pid ? k->pid : k->pi)(&bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, n);
+
+        for (size_t i = 0U; i < n; i++) {
+            if (is_pid) {
+                epid_pid_calc(&ref[i], setpoints[i], measures[i]);
+                epid_pid_sum(&ref[i], PID_LIM_MIN, PID_LIM_MAX);
+            }
+            else {
+                epid_pi_calc(&ref[i], setpoints[i], measures[i]);
+                epid_pi_sum(&ref[i], PID_LIM_MIN, PID_LIM_MAX);
+            }
+
+            if (!same_bits(bank.y_out[i], ref[i].y_out)
+             || !same_bits(bank.xk_1[i], ref[i].xk_1)
+             || (is_pid && !same_bits(bank.xk_2[i], ref[i].xk_2))
+            ) {
+                fails++;
+            }
+        }
+    }
+
+    return fails;
+}
+
+
+/* Run a LPF kernel and the reference for `STEPS` steps, return the mismatches. */
+static unsigned long check_lpf(const kernel_t *k, size_t n)
+{
+    epid_lpf_bank_t bank;
+    unsigned long fails = 0UL;
+
+    seed = (uint32_t)n;
+    epid_lpf_bank_init(&bank, lpf_mem, n);
+    for (size_t i = 0U; i < n; i++) {
+        const float x = rand_range(-50.0f, 50.0f);
+        /* Mostly small factors (`f_cut` well under the sample rate). */
+        const float a = (i % 3U) ? rand_range(0.001f, 0.2f) : rand_range(0.2f, 0.999f);
+
+        if ((epid_util_lpf_init(&lpf_ref[i], a, x) != EPID_ERR_NONE)
+         || (epid_lpf_bank_set(&bank, i, a, x) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*lpf*_init() error.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (size_t s = 0U; s < STEPS; s++) {
+        for (size_t i = 0U; i < n; i++) {
+            measures[i] = rand_input();
+        }
+
+        k->lpf(&bank, measures, n);
+
+        for (size_t i = 0U; i < n; i++) {
+            epid_util_lpf_calc(&lpf_ref[i], measures[i]);
+
+            if (!same_bits(bank.y[i], lpf_ref[i].y)) {
+                fails++;
+            }
+        }
+    }
+
+    return fails;
+}
+
+
+int main()
+{
+    kernel_t kernels[6];
+    size_t n_kernels = 0U;
+    unsigned long fails = 0UL;
+
+    kernels[n_kernels++] = (kernel_t){ "scalar", epid_bank_pi_portable, epid_bank_pid_portable,
+                                       epid_lpf_bank_portable };
+    /* The dispatched entry points, as used by applications. */
+    kernels[n_kernels++] = (kernel_t){ "dispatch", epid_bank_pi_step, epid_bank_pid_step,
+                                       epid_lpf_bank_calc };
+#if defined(EPID_BANK_X86)
+    kernels[n_kernels++] = (kernel_t){ "sse2", epid_bank_pi_sse2, epid_bank_pid_sse2,
+                                       epid_lpf_bank_sse2 };
+# if defined(EPID_BANK_X86_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels[n_kernels++] = (kernel_t){ "avx2", epid_bank_pi_avx2, epid_bank_pid_avx2,
+                                           epid_lpf_bank_avx2 };
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels[n_kernels++] = (kernel_t){ "avx512f", epid_bank_pi_avx512f, epid_bank_pid_avx512f,
+                                           epid_lpf_bank_avx512f };
+    }
+# endif
+#elif defined(EPID_BANK_NEON)
+    kernels[n_kernels++] = (kernel_t){ "neon", epid_bank_pi_neon, epid_bank_pid_neon,
+                                       epid_lpf_bank_neon };
+#endif
+
+    printf("Kernel\tController\tMismatches\n"); /* "LPF" for the filters. */
+    for (size_t k = 0U; k < n_kernels; k++) {
+        for (int is_pid = 0; is_pid < 2; is_pid++) {
+            unsigned long kernel_fails = 0UL;
+
+            for (size_t j = 0U; j < (sizeof(sizes) / sizeof(sizes[0])); j++) {
+                kernel_fails += check(&kernels[k], is_pid, sizes[j]);
+            }
+            printf("%s\t%s\t%lu\n", kernels[k].name, is_pid ? "PID" : "PI", kernel_fails);
+            fails += kernel_fails;
+        }
+
+        unsigned long lpf_fails = 0UL;
+        for (size_t j = 0U; j < (sizeof(sizes) / sizeof(sizes[0])); j++) {
+            lpf_fails += check_lpf(&kernels[k], sizes[j]);
+        }
+        printf("%s\tLPF\t%lu\n", kernels[k].name, lpf_fails);
+        fails += lpf_fails;
+    }
+
+    fprintf(stderr, "Dispatched kernel: %s, %lu failure(s).\n", epid_bank_kernel_name(), fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -Wall -Wextra test_coef.c ../../src/pid_plant.c -lm -o test_coef.bin */
+
+/* Difference equation form (`epid_coef_pid_step()`) versus
+ * `epid_pid_calc()` + `epid_pid_sum()`: Check `delta[k]` is within
+ * `EPID_COEF_ERR_EPS * FLT_EPSILON * M` on the heating simulation of `main.c`
+ * and on random inputs, and that reconstructed terms match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include <math.h>
+
+/* Header-only mode, to let the compiler inline the library calls. */
+#define EPID_HEADER_ONLY 1
+#include "../../src/pid.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+/* Maximum run-time of simulation */
+#define SIMULATION_TIME_MAX (6.0*60.0)
+
+#define RANDOM_TESTS 1000000UL
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+
+/* Simulate heating something, run every `Ts` */
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(1)];
+
+
+static float rand_range(float lo, float hi)
+{
+    return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+
+/* Check one step of both forms from the same state, return 0 if in bound. */
+static int check_step(epid_t *ref, epid_t *fast, const epid_coef_t *coef,
+                      float setpoint, float measure, float *err_max)
+{
+    const float m = fabsf(coef->a0 * measure) + fabsf(coef->a1 * fast->xk_1)
+                  + fabsf(coef->a2 * fast->xk_2) + fabsf(coef->b * setpoint);
+    const float bound = (float)EPID_COEF_ERR_EPS * FLT_EPSILON * m;
+
+    epid_pid_calc(ref, setpoint, measure);
+    const float delta_ref = ref->p_term + ref->i_term + ref->d_term;
+    epid_pid_sum(ref, PID_LIM_MIN, PID_LIM_MAX);
+
+    const float delta = epid_coef_pid_step(coef, fast, setpoint, measure,
+                                           PID_LIM_MIN, PID_LIM_MAX);
+    epid_coef_terms(fast, setpoint, delta);
+
+    const float err = fabsf(delta - delta_ref);
+    if ((m > 0.0f) && ((err / m) > *err_max)) {
+        *err_max = err / m;
+    }
+
+    return (err > bound)
+        || (fast->p_term != ref->p_term)
+        || (fast->i_term != ref->i_term)
+        || (fabsf(fast->d_term - ref->d_term) > bound);
+}
+
+
+int main()
+{
+    epid_t ref, fast;
+    epid_coef_t coef;
+    float setpoint = 70.0f;
+    float err_max = 0.0f;
+    unsigned long fails = 0UL;
+
+    if ((epid_plant_thermal_init(&heating_system, heating_system_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&heating_system, 0U,
+            HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+            SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+     || (epid_init(&ref, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f,
+                   EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+     || (epid_coef_init(&coef, &ref) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return -1;
+    }
+
+    printf("Time (s)\tSystem Sensor (C)\tController Output (W)\tPID Delta\tCoef Delta\n");
+
+    for (double t = 0.0; t <= SIMULATION_TIME_MAX; t += SAMPLE_TIME_S) {
+        /* Same disturbances as `main.c`. */
+        if (fabs(t - 100.0) < (SAMPLE_TIME_S / 2.0)) {
+            heating_system.y[0] -= 7.0f;
+        }
+        else if (fabs(t - 150.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint += 7.0f;
+        }
+        else if (fabs(t - 220.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint -= 2.0f;
+        }
+
+        /* Both forms start every step from the reference state. */
+        fast = ref;
+        fails += (unsigned long)check_step(&ref, &fast, &coef, setpoint, heating_system.y[0], &err_max);
+
+        printf("%.2f\t%f\t%f\t%f\t%f\n", t, heating_system.y[0], ref.y_out,
+               ref.p_term + ref.i_term + ref.d_term,
+               fast.p_term + fast.i_term + fast.d_term);
+
+        epid_plant_thermal_step(&heating_system, &ref.y_out);
+    }
+
+    srand(1U);
+    for (unsigned long n = 0UL; n < RANDOM_TESTS; n++) {
+        if (epid_init(&ref, rand_range(-1000.0f, 1000.0f), rand_range(-1000.0f, 1000.0f),
+                      rand_range(PID_LIM_MIN, PID_LIM_MAX),
+                      rand_range(0.001f, 1000.0f), rand_range(0.001f, 100.0f),
+                      rand_range(0.0f, 1000.0f)) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_init() error.\n");
+            return -1;
+        }
+        epid_coef_init(&coef, &ref);
+        fast = ref;
+        fails += (unsigned long)check_step(&ref, &fast, &coef,
+                                           rand_range(-1000.0f, 1000.0f),
+                                           rand_range(-1000.0f, 1000.0f), &err_max);
+    }
+
+    fprintf(stderr, "Max |delta error| / M: %g FLT_EPSILON (bound %u), %lu failure(s).\n",
+            err_max / FLT_EPSILON, EPID_COEF_ERR_EPS, fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
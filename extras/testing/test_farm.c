@@ -0,0 +1,135 @@
+/* ISO/IEC C standard: C11 (ISO/IEC 9899:2011) or later, POSIX.1-2001 host. */
+/* gcc -std=c11 -O2 -Wall -Wextra -pthread test_farm.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_farm.c -lm -o test_farm.bin */
+
+/* Controller farm (`epid_farm_p*_step()`) versus one `epid_bank_p*_step()`
+ * call per tick, for 1 to `THREADS_MAX` threads, PI and PID: The whole bank
+ * memory must be bit for bit identical after every tick. `FARM_N` is not a
+ * multiple of `EPID_FARM_CHUNK`, so the last chunk is partial, and there are
+ * fewer chunks than threads for the largest counts. Inputs change every tick,
+ * with some NaN and INF.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_farm.h"
+
+
+#define FARM_N ((3U * EPID_FARM_CHUNK) + 123U)
+#define THREADS_MAX 7U
+#define TICKS 50U
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+static float mem_ref[EPID_BANK_MEM_LEN(FARM_N)];
+static float mem_farm[EPID_BANK_MEM_LEN(FARM_N)];
+static float setpoints[FARM_N];
+static float measures[FARM_N];
+static uint32_t seed;
+static unsigned long fails = 0UL;
+
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+static float rand_range(float lo, float hi)
+{
+    seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+    return lo + (hi - lo) * ((float)(seed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/* Same controllers in both banks. */
+static int setup(epid_bank_t *ref, epid_bank_t *bank)
+{
+    memset(mem_ref, 0, sizeof(mem_ref));
+    memset(mem_farm, 0, sizeof(mem_farm));
+    if ((epid_bank_init(ref, mem_ref, FARM_N) != EPID_ERR_NONE)
+     || (epid_bank_init(bank, mem_farm, FARM_N) != EPID_ERR_NONE)
+    ) {
+        return 0;
+    }
+
+    seed = 1U;
+    for (size_t i = 0U; i < FARM_N; i++) {
+        const float x = rand_range(20.0f, 80.0f);
+        const float ki = 10.0f + (float)(i % 7U);
+
+        if ((epid_bank_set(ref, i, x, x, 0.0f, 500.0f, ki, 200.0f) != EPID_ERR_NONE)
+         || (epid_bank_set(bank, i, x, x, 0.0f, 500.0f, ki, 200.0f) != EPID_ERR_NONE)
+        ) {
+            return 0;
+        }
+        setpoints[i] = 70.0f;
+    }
+
+    return 1;
+}
+
+
+/* Return the ticks with a bank memory mismatch. */
+static unsigned long run(size_t threads, int is_pid)
+{
+    epid_bank_t ref, bank;
+    epid_farm_t farm;
+    unsigned long mismatches = 0UL;
+
+    if (!setup(&ref, &bank) || (epid_farm_init(&farm, threads) != EPID_ERR_NONE)) {
+        check(0, "epid_bank_*() or epid_farm_init()");
+        return 1UL;
+    }
+
+    for (uint32_t k = 0U; k < TICKS; k++) {
+        for (size_t i = 0U; i < FARM_N; i++) {
+            const float r = rand_range(0.0f, 1.0f);
+
+            measures[i] = (r < 0.001f) ? NAN : ((r < 0.002f) ? INFINITY : rand_range(20.0f, 80.0f));
+        }
+
+        if (is_pid) {
+            epid_bank_pid_step(&ref, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, FARM_N);
+            epid_farm_pid_step(&farm, &bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, FARM_N);
+        }
+        else {
+            epid_bank_pi_step(&ref, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, FARM_N);
+            epid_farm_pi_step(&farm, &bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX, FARM_N);
+        }
+
+        if (memcmp(mem_ref, mem_farm, sizeof(mem_ref)) != 0) {
+            mismatches++;
+        }
+    }
+
+    epid_farm_deinit(&farm);
+
+    return mismatches;
+}
+
+
+int main()
+{
+    printf("Threads\tPI mismatches\tPID mismatches\n");
+    for (size_t threads = 1U; threads <= THREADS_MAX; threads++) {
+        const unsigned long pi = run(threads, 0);
+        const unsigned long pid = run(threads, 1);
+
+        printf("%lu\t%lu\t%lu\n", (unsigned long)threads, pi, pid);
+        check(pi == 0UL, "epid_farm_pi_step() versus epid_bank_pi_step()");
+        check(pid == 0UL, "epid_farm_pid_step() versus epid_bank_pid_step()");
+    }
+
+    fprintf(stderr, "%lu failure(s).\n", fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
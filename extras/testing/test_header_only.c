@@ -0,0 +1,95 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -O2 -Wall -Wextra -Winline -Werror test_header_only.c -lm -o test_header_only.bin */
+
+/* Header-only mode (`EPID_HEADER_ONLY`): The functions of <pid.h> must be
+ * inlined in the callers. GCC reports (`-Winline`, an error by `-Werror`)
+ * the calls not inlined for an attributes mismatch, as with an `optimize`
+ * pragma in "pid.c". No call is left in the binary:
+ *   objdump -d test_header_only.bin | grep "call.*<epid_"
+ * (The init and control loop functions; `epid_set_gains*()` calls are cold
+ * paths, GCC may not inline them by size heuristics.)
+ * Also checks the fused `epid_p*_step()` versus `epid_p*_calc()` +
+ * `epid_util_ilim()` + `epid_p*_sum()`, as inlined.
+ */
+
+#include <stdio.h>
+
+#define EPID_HEADER_ONLY
+#include "../../src/pid.h"
+
+
+#define STEPS 1000U
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+#define I_LIM 100.0f
+
+
+static unsigned long fails = 0UL;
+
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+int main()
+{
+    epid_t a, b, c;
+    epid_coef_t coef;
+    epid_lpf_t lpf;
+    float measure = 20.0f;
+    float y_coef = 0.0f;
+
+    if ((epid_init_T(&a, 20.0f, 20.0f, 0.0f, 500.0f, 50.0f, 0.4f, 0.1f) != EPID_ERR_NONE)
+     || (epid_util_lpf_init(&lpf, 0.5f, 20.0f) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return -1;
+    }
+    b = a;
+    c = a;
+    if (epid_coef_init(&coef, &c) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_coef_init() error.\n");
+        return -1;
+    }
+
+    for (uint32_t k = 0U; k < STEPS; k++) {
+        const float setpoint = (k < (STEPS / 2U)) ? 70.0f : 60.0f;
+
+        epid_util_lpf_calc(&lpf, measure);
+
+        epid_pid_step(&a, setpoint, lpf.y, -I_LIM, I_LIM, PID_LIM_MIN, PID_LIM_MAX);
+        epid_pid_calc(&b, setpoint, lpf.y);
+        epid_util_ilim(&b, -I_LIM, I_LIM);
+        epid_pid_sum(&b, PID_LIM_MIN, PID_LIM_MAX);
+
+        y_coef = epid_coef_pid_step(&coef, &c, setpoint, lpf.y, PID_LIM_MIN, PID_LIM_MAX);
+        epid_coef_terms(&c, setpoint, y_coef);
+
+        /* First-order plant, 500 W for 50 °C over room. */
+        measure += 0.01f * ((20.0f + (a.y_out * 0.1f)) - measure);
+    }
+    check((a.y_out == b.y_out) && (a.i_term == b.i_term) && (a.flags == b.flags),
+          "epid_pid_step() versus epid_pid_calc() + epid_util_ilim() + epid_pid_sum()");
+
+    b = a;
+    for (uint32_t k = 0U; k < STEPS; k++) {
+        const float x = 60.0f + (float)(k % 7U);
+
+        epid_pi_step(&a, 65.0f, x, -I_LIM, I_LIM, PID_LIM_MIN, PID_LIM_MAX);
+        epid_pi_calc(&b, 65.0f, x);
+        epid_util_ilim(&b, -I_LIM, I_LIM);
+        epid_pi_sum(&b, PID_LIM_MIN, PID_LIM_MAX);
+    }
+    check((a.y_out == b.y_out) && (a.i_term == b.i_term) && (a.flags == b.flags),
+          "epid_pi_step() versus epid_pi_calc() + epid_util_ilim() + epid_pi_sum()");
+
+    fprintf(stderr, "y: %f, coef y: %f; %lu failure(s).\n", a.y_out, y_coef, fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
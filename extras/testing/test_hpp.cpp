@@ -0,0 +1,187 @@
+/* ISO/IEC C++ standard: C++17 (ISO/IEC 14882:2017) or later. */
+/* g++ -std=c++17 -O2 -Wall -Wextra -ffp-contract=off test_hpp.cpp ../../src/pid.c -lm -o test_hpp.bin */
+
+/* `epid::Pid<float, ...>` of <pid.hpp> versus the `float` functions of
+ * "pid.c" (built here as C++, `extern "C"`): PID and PI with a fixed I-term
+ * limit, random inputs and NaN/INF, and the example of <pid.hpp> on the
+ * heating system of `main.c`. States, terms and outputs must be bit for bit
+ * identical. Build also with `-march=native`: Without
+ * `-ffp-contract=off`, GCC contracts the header to FMA and outputs differ
+ * (see <pid.hpp>). The NaN/INF tests are also checked at compile-time,
+ * so they must hold with `-ffast-math` (which reassociates the sums, so
+ * outputs are not compared then).
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "../../src/pid.h"
+#include "../../src/pid.hpp"
+
+
+#define STEPS 100000U
+
+#define PID_LIM_MIN -50.0f
+#define PID_LIM_MAX 50.0f
+#define I_LIM 20 /* Integer for `epid::ILimits` in C++17. */
+
+
+/* Bit-pattern tests in constant expressions, not folded by `-ffast-math`. */
+static_assert(epid::detail::is_nan(std::numeric_limits<float>::quiet_NaN()), "is_nan(NaN)");
+static_assert(!epid::detail::is_nan(std::numeric_limits<float>::infinity()), "is_nan(INF)");
+static_assert(!epid::detail::is_nan(1.0f), "is_nan(1)");
+static_assert(!epid::detail::is_finite(std::numeric_limits<float>::infinity()), "is_finite(INF)");
+static_assert(!epid::detail::is_finite(std::numeric_limits<double>::quiet_NaN()), "is_finite(NaN)");
+static_assert(epid::detail::is_finite(-2.5), "is_finite(-2.5)");
+
+using Pid = epid::Pid<float, epid::CheckNaN, epid::ILimits<-I_LIM, I_LIM>>;
+using Pi = epid::Pid<float, epid::PI, epid::CheckNaN, epid::ILimits<-I_LIM, I_LIM>>;
+/* As the example of <pid.hpp>: Gains folded at compile-time. */
+using Heater = epid::Pid<float, epid::OutLimits<0, 500>>;
+constexpr Heater heater_0 = Heater::from_gains(20.0f, 20.0f, 0.0f, 500.0f, 10.0f, 200.0f);
+
+
+static unsigned long fails = 0UL;
+static uint32_t seed = 1U;
+
+
+static float rand_range(float lo, float hi)
+{
+    seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+    return lo + (hi - lo) * ((float)(seed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/* Mostly finite inputs, some NaN and INF. */
+static float rand_input(void)
+{
+    const float r = rand_range(0.0f, 1.0f);
+
+    if (r < 0.005f) {
+        return std::numeric_limits<float>::quiet_NaN();
+    }
+    else if (r < 0.01f) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return rand_range(-30.0f, 30.0f);
+}
+
+
+/* Same bit-patterns, or both NaN (NaN payloads are not specified). */
+static bool same_bits(float a, float b)
+{
+    return (std::memcmp(&a, &b, sizeof(a)) == 0) || ((a != a) && (b != b));
+}
+
+
+static void check(bool ok, const char *what)
+{
+    if (!ok) {
+        std::fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+template <typename P>
+static unsigned long run(bool is_pid)
+{
+    P cpp{};
+    epid_t c;
+    unsigned long mismatches = 0UL;
+
+    if ((cpp.init_T(0.0f, 0.0f, 0.0f, 2.0f, 0.5f, 0.05f, 0.01f) != EPID_ERR_NONE)
+     || (epid_init_T(&c, 0.0f, 0.0f, 0.0f, 2.0f, 0.5f, is_pid ? 0.05f : 0.0f, 0.01f) != EPID_ERR_NONE)
+    ) {
+        std::fprintf(stderr, "init_T() error.\n");
+        return 1UL;
+    }
+    check((cpp.kp == c.kp) && (cpp.ki == c.ki) && (!is_pid || (cpp.kd == c.kd)),
+          "init_T() gains versus epid_init_T()");
+
+    for (uint32_t k = 0U; k < STEPS; k++) {
+        const float setpoint = (k % 1000U) ? rand_range(-30.0f, 30.0f) : rand_input();
+        const float measure = rand_input();
+
+        const float y = cpp.step(setpoint, measure, PID_LIM_MIN, PID_LIM_MAX);
+        if (is_pid) {
+            epid_pid_calc(&c, setpoint, measure);
+            epid_util_ilim(&c, -I_LIM, I_LIM);
+            epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX);
+        }
+        else {
+            epid_pi_calc(&c, setpoint, measure);
+            epid_util_ilim(&c, -I_LIM, I_LIM);
+            epid_pi_sum(&c, PID_LIM_MIN, PID_LIM_MAX);
+        }
+
+        if (!same_bits(y, c.y_out)
+         || !same_bits(cpp.y_out, c.y_out)
+         || !same_bits(cpp.p_term, c.p_term)
+         || !same_bits(cpp.i_term, c.i_term)
+         || !same_bits(cpp.xk_1, c.xk_1)
+         || (is_pid && (!same_bits(cpp.d_term, c.d_term) || !same_bits(cpp.xk_2, c.xk_2)))
+        ) {
+            mismatches++;
+        }
+    }
+
+    return mismatches;
+}
+
+
+/* `Heater` on the heating system of `main.c`, return the mismatches. */
+static unsigned long run_heater(void)
+{
+    Heater heater = heater_0;
+    epid_t c;
+    float temp_c = 20.0f;
+    unsigned long mismatches = 0UL;
+
+    if (epid_init(&c, 20.0f, 20.0f, 0.0f, 500.0f, 10.0f, 200.0f) != EPID_ERR_NONE) {
+        std::fprintf(stderr, "epid_init() error.\n");
+        return 1UL;
+    }
+
+    for (uint32_t k = 0U; k < STEPS; k++) {
+        /* Measurement noise, and setpoint steps. */
+        const float measure = temp_c + rand_range(-0.5f, 0.5f);
+        const float setpoint = ((k / 5000U) % 2U) ? 60.0f : 70.0f;
+
+        const float y = heater.step(setpoint, measure);
+        epid_pid_calc(&c, setpoint, measure);
+        epid_pid_sum(&c, 0.0f, 500.0f);
+
+        if (!same_bits(y, c.y_out) || !same_bits(heater.d_term, c.d_term)) {
+            mismatches++;
+        }
+        /* `main.c` model, `Ts` 0.1 s. */
+        temp_c += (0.1f * (y - (11.3f * 6.0f * 0.0025f * (temp_c - 20.0f)))) / (4.186f * 100.0f);
+    }
+
+    return mismatches;
+}
+
+
+int main()
+{
+    const unsigned long pid_mismatches = run<Pid>(true);
+    const unsigned long pi_mismatches = run<Pi>(false);
+    const unsigned long heater_mismatches = run_heater();
+
+    std::printf("Controller\tMismatches\nPID\t%lu\nPI\t%lu\nHeater\t%lu\n",
+                pid_mismatches, pi_mismatches, heater_mismatches);
+    check(pid_mismatches == 0UL, "epid::Pid versus epid_pid_*()");
+    check(pi_mismatches == 0UL, "epid::Pid<PI> versus epid_pi_*()");
+    check(heater_mismatches == 0UL, "epid::Pid<OutLimits> versus epid_pid_*()");
+
+    /* NaN init arguments, with `CheckNaN`. */
+    Pid p{};
+    check(p.init(std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f, 1.0f, 1.0f, 0.0f) == EPID_ERR_FLT,
+          "init() NaN check");
+
+    std::fprintf(stderr, "%lu failure(s).\n", fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
@@ -8,8 +8,9 @@
 # define M_PI 3.14159265358979323846
 #endif
 
-#include "../src/pid.h"
-#include "../src/pid.c"
+/* Header-only mode, to let the compiler inline the library calls. */
+#define EPID_HEADER_ONLY 1
+#include "../../src/pid.h"
 
 #define SAMPLE_TIME_S 0.001 /* 2 times max noise freq. at least: 4x */
 #define SAMPLES_N 250U /* About SAMPLE_TIME_S*SAMPLES_N = 0.25s */
@@ -0,0 +1,234 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -O2 -Wall -Wextra test_plant.c ../../src/pid_plant.c -lm -o test_plant.bin */
+
+/* Plant models of "pid_plant.c":
+ * - `epid_plant_fopdt_t`: The dead time ring versus a shift register moved by
+ *   `memmove()` each step, bit for bit, for delays 0, 1, 2 and more, with
+ *   `n` not a multiple of the vectors lanes.
+ * - `epid_plant_so_t`: The Jury test boundaries, `c2 == 2` and
+ *   `c1 + 2*c2 == 4` are rejected, and the closest stable set is accepted.
+ * - `epid_plant_thermal_t`: The heating system of `main.c` versus its former
+ *   private model, within `THERMAL_TOL` over the `main.c` scenario (the
+ *   factors `Ts/C` and `Ts*loss/C` are rounded once, at set time).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../src/pid_plant.h"
+
+
+#define N_MAX 37U /* Not a multiple of the vectors lanes. */
+#define DELAY_MAX 9U
+#define STEPS 200U
+
+#define SAMPLE_TIME_S 0.1f
+/* Maximum run-time of simulation */
+#define SIMULATION_TIME_MAX (6.0*60.0)
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+#define THERMAL_TOL 5e-5 /* °C */
+
+
+static float plant_mem[EPID_PLANT_FOPDT_MEM_LEN(N_MAX, DELAY_MAX)];
+static float so_mem[EPID_PLANT_SO_MEM_LEN(1U)];
+static float thermal_mem[EPID_PLANT_THERMAL_MEM_LEN(1U)];
+static float line[N_MAX][DELAY_MAX]; /* Reference: `u[k-delay]` first. */
+static float y_ref[N_MAX];
+static float u[N_MAX];
+static uint32_t seed;
+static unsigned long fails = 0UL;
+
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+static float rand_range(float lo, float hi)
+{
+    seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+    return lo + (hi - lo) * ((float)(seed >> 8) * (1.0f / 16777216.0f));
+}
+
+
+/* The former model of `main.c`, run every `SAMPLE_TIME_S`. */
+static float heating_system(float temp_c, float energy_watt)
+{
+    const float room_temp = 20.0f;
+    const float specific_heat = 4.186f; /* Water: joule/gram °C */
+    const float mass = 100.0f; /* mass in grams */
+    const float surface = 6.0f*0.0025f; /* 6 faces of cube in meters^2 */
+    const float q = 11.3f*(temp_c-room_temp)*surface;
+    float joules = - SAMPLE_TIME_S*(q); /* Get cold, energy out. */
+
+    if (energy_watt > 0.0f) {
+        /* Add energy to heat. */
+        joules += SAMPLE_TIME_S*(energy_watt);
+    }
+
+    return temp_c + (joules/(specific_heat*mass));
+}
+
+
+/* FOPDT ring versus a `memmove()` shift register, return the mismatches. */
+static unsigned long check_fopdt(size_t n, uint32_t delay)
+{
+    epid_plant_fopdt_t plant;
+    unsigned long mismatches = 0UL;
+
+    seed = (uint32_t)((n * 31U) + delay);
+    if (epid_plant_fopdt_init(&plant, plant_mem, n, delay) != EPID_ERR_NONE) {
+        check(0, "epid_plant_fopdt_init()");
+        return 1UL;
+    }
+    for (size_t i = 0U; i < n; i++) {
+        const float u_0 = rand_range(-5.0f, 5.0f);
+
+        y_ref[i] = rand_range(-10.0f, 10.0f);
+        if (epid_plant_fopdt_set(&plant, i, rand_range(0.1f, 3.0f), rand_range(0.05f, 5.0f),
+                                 SAMPLE_TIME_S, y_ref[i], u_0) != EPID_ERR_NONE) {
+            check(0, "epid_plant_fopdt_set()");
+            return 1UL;
+        }
+        for (uint32_t k = 0U; k < delay; k++) {
+            line[i][k] = u_0;
+        }
+    }
+
+    for (uint32_t s = 0U; s < STEPS; s++) {
+        for (size_t i = 0U; i < n; i++) {
+            u[i] = rand_range(-5.0f, 5.0f);
+        }
+
+        epid_plant_fopdt_step(&plant, u);
+
+        for (size_t i = 0U; i < n; i++) {
+            float u_delayed = u[i];
+
+            if (delay > 0U) {
+                u_delayed = line[i][0];
+                memmove(&line[i][0], &line[i][1], (delay - 1U) * sizeof(float));
+                line[i][delay - 1U] = u[i];
+            }
+            y_ref[i] = y_ref[i] + plant.a[i] * ((plant.gain[i] * u_delayed) - y_ref[i]);
+
+            if (memcmp(&y_ref[i], &plant.y[i], sizeof(float)) != 0) {
+                mismatches++;
+            }
+        }
+    }
+
+    return mismatches;
+}
+
+
+/* Second-order, `(wn * Ts)` 1 so `c1` 1 and `c2` `2 * zeta` (exact). */
+static void check_so(void)
+{
+    epid_plant_so_t plant;
+    float one = 1.0f;
+
+    if (epid_plant_so_init(&plant, so_mem, 1U) != EPID_ERR_NONE) {
+        check(0, "epid_plant_so_init()");
+        return;
+    }
+
+    /* `c2 == 2` (and `c1 + 2*c2 == 5`). */
+    check(epid_plant_so_set(&plant, 0U, 1.0f, 2.0f, 1.0f, 0.5f, 0.0f) == EPID_ERR_INIT,
+          "epid_plant_so_set(): c2 == 2 rejected");
+    /* `c1 + 2*c2 == 4`, `c2` 1.5. */
+    check(epid_plant_so_set(&plant, 0U, 1.0f, 2.0f, 0.75f, 0.5f, 0.0f) == EPID_ERR_INIT,
+          "epid_plant_so_set(): c1 + 2*c2 == 4 rejected");
+    /* `c2` 2, with `c1` tiny: `wn * Ts` 2^-10, `zeta` 2^10. */
+    check(epid_plant_so_set(&plant, 0U, 1.0f, 1.0f / 1024.0f, 1024.0f, 1.0f, 0.0f) == EPID_ERR_INIT,
+          "epid_plant_so_set(): c2 == 2, c1 + 2*c2 < 5 rejected");
+
+    /* Stable, closest under `c1 + 2*c2 == 4`: Bounded step response. */
+    check((epid_plant_so_set(&plant, 0U, 1.0f, 2.0f, nextafterf(0.75f, 0.0f), 0.5f, 0.0f) == EPID_ERR_NONE)
+       && (plant.c1[0] == 1.0f) && ((plant.c1[0] + (2.0f * plant.c2[0])) < 4.0f),
+          "epid_plant_so_set(): c1 + 2*c2 < 4 accepted");
+    for (uint32_t s = 0U; s < (100U * STEPS); s++) {
+        epid_plant_so_step(&plant, &one);
+    }
+    check(fabsf(plant.y[0] - 1.0f) < 0.5f, "epid_plant_so_step(): Stable near the boundary");
+}
+
+
+/* Thermal versus the former model of `main.c`, same scenario, return the max difference. */
+static double check_thermal(void)
+{
+    epid_plant_thermal_t plant;
+    float temp_c = ROOM_TEMP_C;
+    float setpoint = 70.0f;
+    double diff_max = 0.0;
+
+    if ((epid_plant_thermal_init(&plant, thermal_mem, 1U) != EPID_ERR_NONE)
+     || (epid_plant_thermal_set(&plant, 0U, HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+                                SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE)
+    ) {
+        check(0, "epid_plant_thermal_*()");
+        return 0.0;
+    }
+
+    for (double t = 0.0; t <= SIMULATION_TIME_MAX; t += SAMPLE_TIME_S) {
+        /* Same disturbances as `main.c`. */
+        if (fabs(t - 100.0) < (SAMPLE_TIME_S / 2.0)) {
+            temp_c -= 7.0f;
+            plant.y[0] -= 7.0f;
+        }
+        else if (fabs(t - 150.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint += 7.0f;
+        }
+        else if (fabs(t - 220.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint -= 2.0f;
+        }
+
+        /* On/off heater of 500 W, from the plant output: Both models see the
+         * same inputs, so only the model difference is measured.
+         */
+        const float power = (plant.y[0] < setpoint) ? 500.0f : -1.0f;
+
+        temp_c = heating_system(temp_c, power);
+        epid_plant_thermal_step(&plant, &power);
+
+        diff_max = fmax(diff_max, fabs((double)plant.y[0] - temp_c));
+    }
+
+    return diff_max;
+}
+
+
+int main()
+{
+    static const size_t sizes[] = { 1U, 3U, 8U, 17U, N_MAX };
+    static const uint32_t delays[] = { 0U, 1U, 2U, 5U, DELAY_MAX };
+    double thermal_diff;
+
+    printf("n\tdelay\tMismatches\n");
+    for (size_t j = 0U; j < (sizeof(sizes) / sizeof(sizes[0])); j++) {
+        for (size_t d = 0U; d < (sizeof(delays) / sizeof(delays[0])); d++) {
+            const unsigned long mismatches = check_fopdt(sizes[j], delays[d]);
+
+            printf("%lu\t%lu\t%lu\n", (unsigned long)sizes[j], (unsigned long)delays[d], mismatches);
+            check(mismatches == 0UL, "epid_plant_fopdt_step() versus memmove() reference");
+        }
+    }
+
+    check_so();
+
+    thermal_diff = check_thermal();
+    check(thermal_diff <= THERMAL_TOL, "epid_plant_thermal_step() versus main.c model");
+
+    fprintf(stderr, "Max |thermal - main.c model|: %g C; %lu failure(s).\n", thermal_diff, fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -Wall -Wextra test_q.c ../../src/pid_plant.c -lm -o test_q.bin */
+
+/* Fixed-point (Q31, Q15) versus floating-point controllers, both driving
+ * the heating simulation of `main.c` with the same gains.
+ * Signals are normalized to fractions: PV by `TEMP_FULL_SCALE`,
+ * CV by `POWER_FULL_SCALE`, so gains are scaled by `TEMP_FULL_SCALE/POWER_FULL_SCALE`.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+/* Header-only mode, to let the compiler inline the library calls. */
+#define EPID_HEADER_ONLY 1
+#include "../../src/pid.h"
+#include "../../src/pid_q.h"
+#include "../../src/pid_q.c"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+/* Maximum run-time of simulation */
+#define SIMULATION_TIME_MAX (6.0*60.0)
+
+/* Fixed-point signals full-scale. */
+#define TEMP_FULL_SCALE 128.0f /* Temperature in C */
+#define POWER_FULL_SCALE 512.0f /* Power in W */
+#define GAIN_SCALE (TEMP_FULL_SCALE / POWER_FULL_SCALE)
+
+/* Gains fractional bits, the largest gain `Kp*GAIN_SCALE = 125` must fit. */
+#define Q31_GAIN_FRAC 16U
+#define Q15_GAIN_FRAC 8U
+
+/* Max accepted CV difference from the floating-point closed loop, in W.
+ * The output is limited to `PID_LIM_MAX` at start, which must not set the
+ * `overflow` flag (no Q range saturation with these gains).
+ */
+#define Q31_CV_TOL 0.05f
+#define Q15_CV_TOL 5.0f
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+
+/* Simulate heating something, run every `Ts`: One system per controller,
+ * 0 for `float`, 1 for Q31, 2 for Q15.
+ */
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(3)];
+
+
+static float q31_to_float(int32_t x, float full_scale)
+{
+    return ((float)x / 2147483648.0f) * full_scale;
+}
+
+static int32_t float_to_q31(float x, float full_scale)
+{
+    return (int32_t)lroundf((x / full_scale) * 2147483648.0f);
+}
+
+static float q15_to_float(int16_t x, float full_scale)
+{
+    return ((float)x / 32768.0f) * full_scale;
+}
+
+static int16_t float_to_q15(float x, float full_scale)
+{
+    return (int16_t)lroundf((x / full_scale) * 32768.0f);
+}
+
+
+int main()
+{
+    epid_t c;
+    epid_q31_t c31;
+    epid_q15_t c15;
+    float u[3];
+    float setpoint = 70.0f;
+    float err_31 = 0.0f, err_15 = 0.0f;
+
+    if (epid_plant_thermal_init(&heating_system, heating_system_mem, 3U) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_plant_thermal_init() error.\n");
+        return -1;
+    }
+    for (size_t i = 0U; i < 3U; i++) {
+        if (epid_plant_thermal_set(&heating_system, i,
+                HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+                SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_plant_thermal_set() error.\n");
+            return -1;
+        }
+    }
+
+    if ((epid_init(&c, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f,
+                   EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+     || (epid_q31_init(&c31,
+            float_to_q31(ROOM_TEMP_C, TEMP_FULL_SCALE), float_to_q31(ROOM_TEMP_C, TEMP_FULL_SCALE), 0,
+            EPID_Q31_CONST(EPID_KP*GAIN_SCALE, Q31_GAIN_FRAC),
+            EPID_Q31_CONST(EPID_KI*GAIN_SCALE, Q31_GAIN_FRAC),
+            EPID_Q31_CONST(EPID_KD*GAIN_SCALE, Q31_GAIN_FRAC),
+            Q31_GAIN_FRAC) != EPID_ERR_NONE)
+     || (epid_q15_init(&c15,
+            float_to_q15(ROOM_TEMP_C, TEMP_FULL_SCALE), float_to_q15(ROOM_TEMP_C, TEMP_FULL_SCALE), 0,
+            EPID_Q15_CONST(EPID_KP*GAIN_SCALE, Q15_GAIN_FRAC),
+            EPID_Q15_CONST(EPID_KI*GAIN_SCALE, Q15_GAIN_FRAC),
+            EPID_Q15_CONST(EPID_KD*GAIN_SCALE, Q15_GAIN_FRAC),
+            Q15_GAIN_FRAC) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return -1;
+    }
+
+    printf("Time (s)\tSensor float (C)\tOutput float (W)"
+           "\tSensor Q31 (C)\tOutput Q31 (W)\tSensor Q15 (C)\tOutput Q15 (W)\n");
+
+    for (double t = 0.0; t <= SIMULATION_TIME_MAX; t += SAMPLE_TIME_S) {
+        /* Same disturbances as `main.c`. */
+        if (fabs(t - 100.0) < (SAMPLE_TIME_S / 2.0)) {
+            for (size_t i = 0U; i < 3U; i++) {
+                heating_system.y[i] -= 7.0f;
+            }
+        }
+        else if (fabs(t - 150.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint += 7.0f;
+        }
+        else if (fabs(t - 220.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint -= 2.0f;
+        }
+
+        epid_pid_calc(&c, setpoint, heating_system.y[0]);
+        epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX);
+
+        epid_q31_pid_calc(&c31, float_to_q31(setpoint, TEMP_FULL_SCALE),
+                          float_to_q31(heating_system.y[1], TEMP_FULL_SCALE));
+        epid_q31_pid_sum(&c31, float_to_q31(PID_LIM_MIN, POWER_FULL_SCALE),
+                         float_to_q31(PID_LIM_MAX, POWER_FULL_SCALE));
+
+        epid_q15_pid_calc(&c15, float_to_q15(setpoint, TEMP_FULL_SCALE),
+                          float_to_q15(heating_system.y[2], TEMP_FULL_SCALE));
+        epid_q15_pid_sum(&c15, float_to_q15(PID_LIM_MIN, POWER_FULL_SCALE),
+                         float_to_q15(PID_LIM_MAX, POWER_FULL_SCALE));
+
+        const float y_31 = q31_to_float(c31.y_out, POWER_FULL_SCALE);
+        const float y_15 = q15_to_float(c15.y_out, POWER_FULL_SCALE);
+
+        printf("%.2f\t%f\t%f\t%f\t%f\t%f\t%f\n",
+               t, heating_system.y[0], c.y_out, heating_system.y[1], y_31, heating_system.y[2], y_15);
+
+        /* Every controller drives its own simulated system. */
+        if (fabsf(y_31 - c.y_out) > err_31) {
+            err_31 = fabsf(y_31 - c.y_out);
+        }
+        if (fabsf(y_15 - c.y_out) > err_15) {
+            err_15 = fabsf(y_15 - c.y_out);
+        }
+
+        u[0] = c.y_out;
+        u[1] = y_31;
+        u[2] = y_15;
+        epid_plant_thermal_step(&heating_system, u);
+    }
+
+    fprintf(stderr, "Max CV difference: Q31 %f W (overflow %u), Q15 %f W (overflow %u).\n",
+            err_31, (unsigned)c31.overflow, err_15, (unsigned)c15.overflow);
+
+    if ((err_31 > Q31_CV_TOL) || (err_15 > Q15_CV_TOL)) {
+        fprintf(stderr, "Fixed-point controllers differ from floating-point.\n");
+        return 1;
+    }
+    if ((c31.overflow != 0U) || (c15.overflow != 0U)) {
+        fprintf(stderr, "Output limiting set the overflow flag.\n");
+        return 1;
+    }
+
+    /* P-term saturated to the max, I-term near the min: The output is not
+     * limited, it differs from the exact one, so `overflow` must be set.
+     */
+    if (epid_q15_init(&c15, 16384, 16384, 0,
+            EPID_Q15_CONST(100.0, 8U), EPID_Q15_CONST(1.0, 8U), 0, 8U) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_q15_init() error.\n");
+        return -1;
+    }
+    epid_q15_pi_calc(&c15, -19661, 8192);
+    epid_q15_pi_sum(&c15, INT16_MIN, INT16_MAX);
+    if (c15.overflow != 1U) {
+        fprintf(stderr, "Unabsorbed term saturation did not set the overflow flag.\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -O2 -Wall -Wextra test_sched.c ../../src/pid.c ../../src/pid_bank.c ../../src/pid_sched.c -lm -o test_sched.bin */
+
+/* Multi-rate scheduler (`epid_sched_pid_step()`) versus `epid_t` controllers
+ * processed by `epid_pid_calc()` + `epid_pid_sum()` when
+ * `(tick - phase) % period == 0`: Check the due groups of every tick, and
+ * that outputs are bit for bit identical, over enough ticks to cascade all
+ * timer wheel levels. Reports the controller updates done versus updating
+ * every controller every tick.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_bank.h"
+#include "../../src/pid_sched.h"
+
+
+#define N 1000U
+#define TICKS 2000000UL /* Past 2^20 ticks: The third wheel level cascades. */
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f
+
+
+static const struct {
+    size_t begin;
+    size_t n;
+    uint32_t period;
+    uint32_t phase;
+} groups[] = {
+    /* 10% of loops every tick (1 kHz), */
+    {0U, 100U, 1U, 0U},
+    /* 90% every 1000 ticks (1 Hz), spread over 8 phases. */
+    {100U, 112U, 1000U, 0U},
+    {212U, 112U, 1000U, 125U},
+    {324U, 112U, 1000U, 250U},
+    {436U, 112U, 1000U, 375U},
+    {548U, 112U, 1000U, 500U},
+    {660U, 112U, 1000U, 625U},
+    {772U, 112U, 1000U, 750U},
+    {884U, 100U, 1000U, 875U},
+    /* Odd periods for every wheel level. */
+    {984U, 4U, 7U, 3U},
+    {988U, 4U, 300U, 299U},
+    {992U, 4U, 20000U, 1U},
+    {996U, 2U, 70000U, 65536U},
+    {998U, 2U, 1500000U, 1234567U},
+};
+#define GROUPS_N (sizeof(groups) / sizeof(groups[0]))
+
+
+static epid_t ctxs[N];
+static epid_bank_t bank;
+static EPID_ALIGNED(EPID_BANK_ALIGN) float bank_mem[EPID_BANK_MEM_LEN(N)];
+static float setpoints[N];
+static float measures[N];
+static float y_ref[N];
+static epid_sched_t sched;
+
+
+int main()
+{
+    uint32_t seed = 1U;
+    unsigned long fails = 0UL;
+    unsigned long long updates = 0ULL;
+
+    if ((epid_bank_init(&bank, bank_mem, N) != EPID_ERR_NONE)
+     || (epid_sched_init(&sched) != EPID_ERR_NONE)
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return -1;
+    }
+
+    for (size_t i = 0U; i < N; i++) {
+        setpoints[i] = 70.0f;
+        measures[i] = 20.0f;
+        if ((epid_init(&ctxs[i], 20.0f, 20.0f, 0.0f, 5.0f, 0.1f + (float)(i % 5U), 2.0f) != EPID_ERR_NONE)
+         || (epid_bank_set(&bank, i, 20.0f, 20.0f, 0.0f, 5.0f, 0.1f + (float)(i % 5U), 2.0f) != EPID_ERR_NONE)
+        ) {
+            fprintf(stderr, "epid_*init() error.\n");
+            return -1;
+        }
+    }
+
+    for (size_t g = 0U; g < GROUPS_N; g++) {
+        if (epid_sched_add(&sched, groups[g].begin, groups[g].n,
+                           groups[g].period, groups[g].phase) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_sched_add() error.\n");
+            return -1;
+        }
+    }
+    /* Overlapping range. */
+    if (epid_sched_add(&sched, 50U, 10U, 2U, 0U) != EPID_ERR_INIT) {
+        fprintf(stderr, "epid_sched_add() overlap not detected.\n");
+        fails++;
+    }
+
+    for (unsigned long tick = 0UL; tick < TICKS; tick++) {
+        uint8_t due[GROUPS_N];
+        size_t n_due = 0U;
+
+        /* New measures for every controller, only due ones read them. */
+        for (size_t i = 0U; i < N; i++) {
+            seed = (seed * 1103515245U) + 12345U; /* LCG, fixed sequence. */
+            measures[i] = 20.0f + (float)(seed >> 16) * (60.0f / 65536.0f);
+        }
+
+        for (size_t g = 0U; g < GROUPS_N; g++) {
+            if ((tick >= groups[g].phase)
+             && (((tick - groups[g].phase) % groups[g].period) == 0UL)) {
+                for (size_t i = groups[g].begin; i < (groups[g].begin + groups[g].n); i++) {
+                    epid_pid_calc(&ctxs[i], setpoints[i], measures[i]);
+                    epid_pid_sum(&ctxs[i], PID_LIM_MIN, PID_LIM_MAX);
+                }
+                updates += groups[g].n;
+                due[n_due++] = (uint8_t)g;
+            }
+        }
+
+        epid_sched_pid_step(&sched, &bank, setpoints, measures, PID_LIM_MIN, PID_LIM_MAX);
+
+        /* Same groups, sorted by `begin` as `groups[]`. */
+        if ((sched.n_due != n_due) || (memcmp(sched.due, due, n_due) != 0)) {
+            fprintf(stderr, "Tick %lu: %lu due group(s), expected %lu.\n",
+                    tick, (unsigned long)sched.n_due, (unsigned long)n_due);
+            fails++;
+        }
+    }
+
+    for (size_t i = 0U; i < N; i++) {
+        y_ref[i] = ctxs[i].y_out;
+    }
+    if (memcmp(y_ref, bank.y_out, N * sizeof(float)) != 0) {
+        fprintf(stderr, "Outputs differ from `epid_t` controllers.\n");
+        fails++;
+    }
+
+    fprintf(stderr, "%lu ticks: %llu controller updates, %.2f%% of %u every tick, %lu failure(s).\n",
+            TICKS, updates, (100.0 * (double)updates) / ((double)TICKS * (double)N), N, fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
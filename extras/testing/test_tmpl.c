@@ -0,0 +1,205 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later. */
+/* gcc -std=c99 -O2 -Wall -Wextra test_tmpl.c ../../src/pid.c ../../src/pid_d.c ../../src/pid_h.c ../../src/pid_plant.c -lm -o test_tmpl.bin */
+
+/* Builds generated from "pid_tmpl.h" (`epid_d_*()`, and `epid_h_*()` if
+ * `EPID_H_AVAILABLE`) versus the `float` build of "pid.c", on the heating
+ * simulation of `main.c`: One thermal plant per build, the temperatures and
+ * outputs of the `double` build must be within `D_TEMP_TOL` and `D_OUT_TOL`
+ * of the `float` ones, and within `H_*_TOL` for `_Float16` storage.
+ * Also checks the behaviors the template must keep in sync with "pid.c":
+ * Sticky flags, NaN outputs guard, `*_set_gains_T()` versus `*_init_T()`,
+ * and the fused `*_pid_step()` versus `*_pid_calc()` + `*_util_ilim()` +
+ * `*_pid_sum()`.
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_d.h"
+#include "../../src/pid_h.h"
+#include "../../src/pid_plant.h"
+
+
+/* Controller parameters, as `main.c` */
+#define EPID_KP  500.0f
+#define EPID_KI  10.0f
+#define EPID_KD  200.0f
+
+#define PID_LIM_MIN 0.0f
+#define PID_LIM_MAX 500.0f /* Heater max power in W */
+
+#define SAMPLE_TIME_S 0.1f
+/* Maximum run-time of simulation */
+#define SIMULATION_TIME_MAX (6.0*60.0)
+
+#define HEATING_CAPACITY (4.186f*100.0f) /* Water: 4.186 joule/gram °C, 100 grams */
+#define HEATING_LOSS (11.3f*6.0f*0.0025f) /* 6 faces of cube in meters^2 */
+#define ROOM_TEMP_C 20.0f
+
+/* Max differences with the `float` build. `_Float16` terms have 11 bits of
+ * precision: With `Kp` 500, an output resolution of 0.25 W or worse, and the
+ * loop settles off by up to ~2 °C.
+ */
+#define D_TEMP_TOL 1e-3 /* °C */
+#define D_OUT_TOL 0.5 /* W */
+#define H_TEMP_TOL 2.5
+#define H_OUT_TOL 100.0
+
+/* Plants: 0 for `float`, 1 for `double`, 2 for `_Float16`. */
+#define PLANTS 3U
+
+
+static epid_plant_thermal_t heating_system;
+static float heating_system_mem[EPID_PLANT_THERMAL_MEM_LEN(PLANTS)];
+static unsigned long fails = 0UL;
+
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+/* The sticky flags, NaN guard and gains of the `double` build. */
+static void check_behaviors(void)
+{
+    epid_d_t a, b;
+
+    check((epid_d_init_T(&a, 20.0, 20.0, 0.0, 500.0, 2.5, 0.4, 0.1) == EPID_ERR_NONE)
+       && (epid_d_set_gains_T(&a, 500.0, 2.5, 0.4) == EPID_ERR_NONE)
+       && (epid_d_init_T(&b, 20.0, 20.0, 0.0, 500.0, 2.5, 0.4, 0.1) == EPID_ERR_NONE),
+          "epid_d_init_T()/epid_d_set_gains_T()");
+    check((a.kp == b.kp) && (a.ki == b.ki) && (fabs(a.kd - b.kd) <= (1e-15 * b.kd)),
+          "epid_d_set_gains_T() gains of epid_d_init_T()");
+    check((epid_d_init(&a, 20.0, 20.0, 0.0, 1.0, 1.0, 0.0) == EPID_ERR_NONE)
+       && (epid_d_set_gains_T(&a, 1.0, 1.0, 0.0) == EPID_ERR_INIT),
+          "epid_d_set_gains_T() without a sample period");
+
+#ifdef EPID_FEATURE_VALID_FLT
+    check(epid_d_init(&a, NAN, 20.0, 0.0, 1.0, 1.0, 0.0) == EPID_ERR_FLT,
+          "epid_d_init() NaN check");
+    check(epid_d_set_gains(&a, 1.0, INFINITY, 0.0) == EPID_ERR_FLT,
+          "epid_d_set_gains() INF check");
+
+    /* NaN measure: `y[k-1]` is kept, and flagged. */
+    epid_d_init(&a, 20.0, 20.0, 42.0, 1.0, 1.0, 1.0);
+    epid_d_pid_calc(&a, 70.0, NAN);
+    epid_d_pid_sum(&a, 0.0, 500.0);
+    check((a.y_out == 42.0) && (a.flags == EPID_FLAG_NAN), "epid_d_pid_sum() NaN guard");
+
+    /* INF then limits. */
+    epid_d_init(&a, 20.0, 20.0, 42.0, 1.0, 1.0, 1.0);
+    epid_d_pi_calc(&a, INFINITY, 20.0);
+    epid_d_pi_sum(&a, 0.0, 500.0);
+    check((a.y_out == 500.0) && (a.flags == (EPID_FLAG_INF | EPID_FLAG_SAT_HI)),
+          "epid_d_pi_sum() INF flag and limit");
+#endif
+
+    /* Fused step versus the three calls. */
+    epid_d_init(&a, 20.0, 19.0, 10.0, 3.0, 0.5, 2.0);
+    b = a;
+    for (int k = 0; k < 100; k++) {
+        const double measure = 20.0 + (0.3 * k) - (0.002 * k * k);
+
+        epid_d_pid_step(&a, 30.0, measure, -5.0, 5.0, -50.0, 50.0);
+        epid_d_pid_calc(&b, 30.0, measure);
+        epid_d_util_ilim(&b, -5.0, 5.0);
+        epid_d_pid_sum(&b, -50.0, 50.0);
+    }
+    check((a.y_out == b.y_out) && (a.i_term == b.i_term) && (a.flags == b.flags),
+          "epid_d_pid_step() versus epid_d_pid_calc() + epid_d_util_ilim() + epid_d_pid_sum()");
+}
+
+
+int main()
+{
+    epid_t c;
+    epid_d_t c_d;
+#ifdef EPID_H_AVAILABLE
+    epid_h_t c_h;
+#endif
+    double d_temp_max = 0.0, d_out_max = 0.0;
+    double h_temp_max = 0.0, h_out_max = 0.0;
+    float u[PLANTS] = { 0.0f, 0.0f, 0.0f };
+    float setpoint = 70.0f;
+
+    if (epid_plant_thermal_init(&heating_system, heating_system_mem, PLANTS) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_plant_thermal_init() error.\n");
+        return -1;
+    }
+    for (size_t i = 0U; i < PLANTS; i++) {
+        if (epid_plant_thermal_set(&heating_system, i,
+                HEATING_CAPACITY, HEATING_LOSS, ROOM_TEMP_C,
+                SAMPLE_TIME_S, ROOM_TEMP_C) != EPID_ERR_NONE) {
+            fprintf(stderr, "epid_plant_thermal_set() error.\n");
+            return -1;
+        }
+    }
+
+    if ((epid_init(&c, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+     || (epid_d_init(&c_d, ROOM_TEMP_C, ROOM_TEMP_C, 0.0, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+#ifdef EPID_H_AVAILABLE
+     || (epid_h_init(&c_h, ROOM_TEMP_C, ROOM_TEMP_C, 0.0f, EPID_KP, EPID_KI, EPID_KD) != EPID_ERR_NONE)
+#endif
+    ) {
+        fprintf(stderr, "epid_*init() error.\n");
+        return -1;
+    }
+
+    printf("Time (s)\tfloat (C)\tdouble (C)\t_Float16 (C)\tfloat (W)\tdouble (W)\t_Float16 (W)\n");
+
+    for (double t = 0.0; t <= SIMULATION_TIME_MAX; t += SAMPLE_TIME_S) {
+        /* Same disturbances as `main.c`. */
+        if (fabs(t - 100.0) < (SAMPLE_TIME_S / 2.0)) {
+            for (size_t i = 0U; i < PLANTS; i++) {
+                heating_system.y[i] -= 7.0f;
+            }
+        }
+        else if (fabs(t - 150.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint += 7.0f;
+        }
+        else if (fabs(t - 220.0) < (SAMPLE_TIME_S / 2.0)) {
+            setpoint -= 2.0f;
+        }
+
+        epid_pid_calc(&c, setpoint, heating_system.y[0]);
+        epid_pid_sum(&c, PID_LIM_MIN, PID_LIM_MAX);
+        u[0] = c.y_out;
+
+        epid_d_pid_calc(&c_d, setpoint, heating_system.y[1]);
+        epid_d_pid_sum(&c_d, PID_LIM_MIN, PID_LIM_MAX);
+        u[1] = (float)c_d.y_out;
+#ifdef EPID_H_AVAILABLE
+        epid_h_pid_calc(&c_h, setpoint, heating_system.y[2]);
+        epid_h_pid_sum(&c_h, PID_LIM_MIN, PID_LIM_MAX);
+        u[2] = (float)c_h.y_out;
+#endif
+
+        printf("%.2f\t%f\t%f\t%f\t%f\t%f\t%f\n", t,
+               heating_system.y[0], heating_system.y[1], heating_system.y[2], u[0], u[1], u[2]);
+
+        d_temp_max = fmax(d_temp_max, fabs((double)heating_system.y[1] - heating_system.y[0]));
+        d_out_max = fmax(d_out_max, fabs((double)u[1] - u[0]));
+        h_temp_max = fmax(h_temp_max, fabs((double)heating_system.y[2] - heating_system.y[0]));
+        h_out_max = fmax(h_out_max, fabs((double)u[2] - u[0]));
+
+        epid_plant_thermal_step(&heating_system, u);
+    }
+
+    check((d_temp_max <= D_TEMP_TOL) && (d_out_max <= D_OUT_TOL), "double versus float");
+#ifdef EPID_H_AVAILABLE
+    check((h_temp_max <= H_TEMP_TOL) && (h_out_max <= H_OUT_TOL), "_Float16 versus float");
+#endif
+    check((c_d.flags == c.flags), "double flags versus float flags");
+
+    check_behaviors();
+
+    fprintf(stderr, "Max |double - float|: %g C, %g W; Max |_Float16 - float|: %g C, %g W;"
+            " %lu failure(s).\n", d_temp_max, d_out_max, h_temp_max, h_out_max, fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/* ISO/IEC C standard: C99 (ISO/IEC 9899:1999) or later, POSIX.1-2008 host. */
+/* gcc -std=c99 -O2 -Wall -Wextra test_trace.c ../../src/pid.c ../../src/pid_trace.c -lm -o test_trace.bin */
+
+/* Trace files: A trace written by `epid_trace_writer_*()` is read back by
+ * `epid_trace_reader_open()` with the same values, and headers that do not
+ * fit the file are rejected: `header_size` past the end of the file, and
+ * `capacity` (so columns offsets and sizes) past the end of the file, as a
+ * truncated or a crafted file. A rejected file must not be mapped, so no
+ * column read can be out of the file.
+ * Files are written in `dir` (default "/tmp") and removed.
+ * Usage: ./test_trace.bin [dir]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../src/pid.h"
+#include "../../src/pid_trace.h"
+
+
+#define LOOPS 3U
+#define SAMPLES 100U
+
+
+static unsigned long fails = 0UL;
+
+
+static void check(int ok, const char *what)
+{
+    if (!ok) {
+        fprintf(stderr, "Failed: %s\n", what);
+        fails++;
+    }
+}
+
+
+/* Write a file of `size` bytes, a header and zeros. */
+static int write_file(const char *path, const epid_trace_header_t *h, size_t size)
+{
+    FILE *f = fopen(path, "wb");
+    int ok = (f != NULL);
+
+    if (ok) {
+        ok = (fwrite(h, sizeof(*h), 1U, f) == 1U);
+        for (size_t i = sizeof(*h); ok && (i < size); i++) {
+            ok = (fputc(0, f) != EOF);
+        }
+        ok = (fclose(f) == 0) && ok;
+    }
+    return ok;
+}
+
+
+/* Open a crafted file, expected to be rejected. */
+static void check_rejected(const char *path, const epid_trace_header_t *h,
+                           size_t size, const char *what)
+{
+    epid_trace_reader_t r;
+    int rejected = 1;
+
+    if (write_file(path, h, size) == 0) {
+        check(0, "crafted file write");
+        return;
+    }
+    if (epid_trace_reader_open(&r, path) == EPID_ERR_NONE) {
+        rejected = 0;
+        epid_trace_reader_close(&r);
+    }
+    check(rejected, what);
+    printf("%s\t%s\n", what, rejected ? "rejected" : "accepted");
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *dir = (argc > 1) ? argv[1] : "/tmp";
+    char path[4096];
+    epid_trace_writer_t w;
+    epid_trace_reader_t r;
+    epid_trace_header_t valid, h;
+    float sp[LOOPS], pv[LOOPS], cv[LOOPS], p[LOOPS], i[LOOPS], d[LOOPS];
+    long file_size = 0L;
+
+    snprintf(path, sizeof(path), "%s/test_trace_%ld.trace", dir, (long)getpid());
+
+    /* Valid trace. */
+    if (epid_trace_writer_open(&w, path, LOOPS, SAMPLES, 0.0, 0.1) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_trace_writer_open() error.\n");
+        return -1;
+    }
+    for (uint32_t k = 0U; k < SAMPLES; k++) {
+        for (uint32_t l = 0U; l < LOOPS; l++) {
+            sp[l] = (float)(k + l);
+            pv[l] = sp[l] + 0.5f;
+            cv[l] = sp[l] + 0.25f;
+            p[l] = -sp[l];
+            i[l] = 2.0f * sp[l];
+            d[l] = 3.0f * sp[l];
+        }
+        check(epid_trace_writer_append(&w, 0.1f * (float)k, sp, pv, cv, p, i, d) == EPID_ERR_NONE,
+              "epid_trace_writer_append()");
+    }
+    check(epid_trace_writer_close(&w) == EPID_ERR_NONE, "epid_trace_writer_close()");
+
+    if (epid_trace_reader_open(&r, path) != EPID_ERR_NONE) {
+        fprintf(stderr, "epid_trace_reader_open() error on a valid trace.\n");
+        (void)unlink(path);
+        return -1;
+    }
+    check(r.header.count == SAMPLES, "Samples count");
+    {
+        const float *c_i = epid_trace_reader_column(&r, EPID_TRACE_I);
+        const float *c_d = epid_trace_reader_column(&r, EPID_TRACE_D);
+        int same = 1;
+
+        for (uint32_t k = 0U; k < SAMPLES; k++) {
+            for (uint32_t l = 0U; l < LOOPS; l++) {
+                same = same && (c_i[(k * LOOPS) + l] == (2.0f * (float)(k + l)))
+                            && (c_d[(k * LOOPS) + l] == (3.0f * (float)(k + l)));
+            }
+        }
+        check(same, "Columns values");
+    }
+    valid = r.header;
+    file_size = (long)r.map_size;
+    epid_trace_reader_close(&r);
+    printf("valid\t%ld bytes\n", file_size);
+
+    /* `header_size` past the end of a 64 bytes file, with columns offsets
+     * far out of the file if not rejected.
+     */
+    h = valid;
+    h.header_size = 60000U;
+    h.capacity = UINT64_C(1) << 20;
+    h.count = h.capacity;
+    check_rejected(path, &h, sizeof(h), "header_size > file size");
+
+    /* `header_size` in the file, columns not. */
+    h = valid;
+    h.header_size = 4096U;
+    check_rejected(path, &h, 4096U + 64U, "header_size + columns > file size");
+
+    /* Truncated file: The last column is cut. */
+    h = valid;
+    check_rejected(path, &h, (size_t)file_size - sizeof(float), "Truncated file");
+
+    /* `capacity` such that `capacity * row_bytes` wraps around. */
+    h = valid;
+    h.capacity = (UINT64_C(1) << 62) / sizeof(float);
+    h.count = 1U;
+    check_rejected(path, &h, (size_t)file_size, "capacity overflow");
+
+    /* `loops` too large for the file. */
+    h = valid;
+    h.loops = UINT32_MAX;
+    check_rejected(path, &h, (size_t)file_size, "loops > file size");
+
+    h = valid;
+    h.count = h.capacity + 1U;
+    check_rejected(path, &h, (size_t)file_size, "count > capacity");
+
+    (void)unlink(path);
+
+    fprintf(stderr, "%lu failure(s).\n", fails);
+
+    return (fails == 0UL) ? 0 : 1;
+}
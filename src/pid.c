@@ -16,216 +16,158 @@
  */
 
 
+/* Guard for the header-only mode, where <pid.h> includes this file. */
+#ifndef EPID_C
+#define EPID_C 1
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #include "pid.h"
+#include "pid_flt.h"
+
+/* No FP contraction in these functions, whatever the compiler flags, so
+ * banks (<pid_bank.h>) give bit for bit the same results. Restored at the
+ * end of this file for the header-only mode.
+ * GCC has no `STDC FP_CONTRACT`, and its `optimize` pragma would stop the
+ * inlining of the header-only functions (optimize attributes mismatch with
+ * the callers): In header-only mode, build with `-ffp-contract=off` (the
+ * default with `-std=c*`) for bit for bit the results of the banks.
+ */
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+# ifndef EPID_HEADER_ONLY
+#  pragma GCC push_options
+#  pragma GCC optimize("fp-contract=off")
+# endif
+#else
+# pragma STDC FP_CONTRACT OFF
+#endif
 
 
-epid_info_t epid_init(epid_t *ctx,
-                      float xk_1, float xk_2, float y_previous,
-                      float kp, float ki, float kd)
+/* `epid_t`, `epid_lpf_t` functions, see <pid.h>: Same source as the other
+ * precisions (<pid_d.h>, <pid_h.h>).
+ */
+#define EPID_TMPL_NAME(name) epid_##name
+#define EPID_TMPL_STORE float
+#define EPID_TMPL_REAL float
+#define EPID_TMPL_UINT uint32_t
+#define EPID_TMPL_ABS_MASK UINT32_C(0x7FFFFFFF)
+#define EPID_TMPL_EXP_MASK UINT32_C(0x7F800000) /* Also the INF magnitude. */
+#define EPID_TMPL_API EPID_API
+#define EPID_TMPL_DEFINE 1
+#include "pid_tmpl.h"
+
+
+EPID_API epid_info_t epid_gains_init(epid_gains_t *gains, float kp, float ki, float kd)
 {
 #ifdef EPID_FEATURE_VALID_FLT
-    if ((isfinite(xk_1) == 0)
-     || (isfinite(xk_2) == 0)
-     || (isfinite(y_previous) == 0)
-     || (isfinite(kp) == 0)
-     || (isfinite(ki) == 0)
-     || (isfinite(kd) == 0) /* Okay to be zero for PI controller. */
+    if ((epid_flt_finite(kp) == 0)
+     || (epid_flt_finite(ki) == 0)
+     || (epid_flt_finite(kd) == 0)
     ) {
         return EPID_ERR_FLT;
     }
 #endif
 
-    if ((ctx == NULL)
+    if ((gains == NULL)
      || (kp <= EPID_FP_ZERO)
      || (ki <= EPID_FP_ZERO)
-     || (kd < EPID_FP_ZERO)
+     || (kd < EPID_FP_ZERO) /* Okay to be zero for PI controller. */
     ) {
         return EPID_ERR_INIT;
     }
 
-    /* Set previous states for equations. */
-    ctx->xk_1 = xk_1; /* Set `x[k-1]` */
-    ctx->xk_2 = xk_2; /* Set `x[k-1]` for D-term */
-    ctx->y_out = y_previous; /* Set `y[k-1]` */
-
-    /* Direct gains assignments. */
-    ctx->kp = kp; /* P-term gain constant. */
-    ctx->ki = ki; /* I-term gain constant. */
-    ctx->kd = kd; /* D-term gain constant. */
+    gains->kp = kp; /* P-term gain constant. */
+    gains->ki = ki; /* I-term gain constant. */
+    gains->kd = kd; /* D-term gain constant. */
 
     return EPID_ERR_NONE;
 }
 
 
-epid_info_t epid_init_T(epid_t *ctx,
-                        float xk_1, float xk_2, float y_previous,
-                        float kp, float ti, float td,
-                        float sample_period)
+EPID_API epid_info_t epid_coef_init(epid_coef_t *coef, const epid_t *ctx)
 {
-#ifdef EPID_FEATURE_VALID_FLT
-    if ((isfinite(ti) == 0)
-     || (isfinite(sample_period) == 0)
-    ) {
-        return EPID_ERR_FLT;
-    }
-#endif
-
-    if ((ti <= EPID_FP_ZERO)
-     || (td <  EPID_FP_ZERO) /* Okay to be zero for PI controller. */
-     || (sample_period <= EPID_FP_ZERO)
+    if ((coef == NULL)
+     || (ctx == NULL)
     ) {
         return EPID_ERR_INIT;
     }
-    
-    /* I-term gain constant; `Ki = Kp / (Ti / Ts) = (Kp * Ts) / Ti` */
-    const float ki = (kp * sample_period) / ti;
-    /* D-term gain constant; `Kd = Kp * (Td / Ts)` */
-    const float kd = kp * (td / sample_period);
-
-    return epid_init(ctx,
-                     xk_1, xk_2, y_previous,
-                     kp, ki, kd);
-}
-
-
-void epid_pi_calc(epid_t *ctx, float setpoint, float measure)
-{
-    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
-     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
-     */
-    ctx->p_term = ctx->kp * (ctx->xk_1 - measure);
-    ctx->i_term = ctx->ki * (setpoint - measure);
 
-    ctx->xk_1 = measure; /* `x[k-1] = x[k]` */
-}
-
-
-void epid_pid_calc(epid_t *ctx, float setpoint, float measure)
-{
-    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
-     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
-     * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+    /* `delta[k] = Kp*(x[k-1] - x[k]) + Ki*(SP - x[k]) + Kd*(2*x[k-1] - x[k-2] - x[k])`
+     * `         = -(Kp + Ki + Kd)*x[k] + (Kp + 2*Kd)*x[k-1] - Kd*x[k-2] + Ki*SP`
      */
-    ctx->p_term = ctx->xk_1 - measure;
-    ctx->d_term = ctx->kd * (ctx->xk_1 + ctx->p_term - ctx->xk_2);
-    ctx->p_term = ctx->kp * ctx->p_term;
-    ctx->i_term = ctx->ki * (setpoint - measure);
-
-    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
-    ctx->xk_1 = measure;   /* `x[k-1] = x[k]` */
-}
-
-
-void epid_pi_sum(epid_t *ctx, float out_min, float out_max)
-{
-#ifdef EPID_FEATURE_VALID_FLT
-    const float y_prev = ctx->y_out;
-#endif
-
-    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
-    ctx->y_out += ctx->p_term + ctx->i_term;
+    const float a0 = -(ctx->kp + ctx->ki + ctx->kd);
+    const float a1 = ctx->kp + (2.0f * ctx->kd);
 
 #ifdef EPID_FEATURE_VALID_FLT
-    if ((isnan(ctx->y_out) != 0)
-     || (isnan(ctx->p_term) != 0)
-     || (isnan(ctx->i_term) != 0)
+    if ((epid_flt_finite(a0) == 0)
+     || (epid_flt_finite(a1) == 0)
     ) {
-        ctx->y_out = y_prev;
+        return EPID_ERR_FLT;
     }
 #endif
 
-    /* Limit the new output `y[k]` (CV) to boundaries. */
-    if (ctx->y_out > out_max) {
-        ctx->y_out = out_max;
-    }
-    else if (ctx->y_out < out_min) {
-        ctx->y_out = out_min;
-    }
+    coef->a0 = a0;
+    coef->a1 = a1;
+    coef->a2 = -ctx->kd;
+    coef->b = ctx->ki;
+
+    return EPID_ERR_NONE;
 }
 
 
-void epid_pid_sum(epid_t *ctx, float out_min, float out_max)
+EPID_API float epid_coef_pid_step(const epid_coef_t *coef, epid_t *ctx,
+                                  float setpoint, float measure,
+                                  float out_min, float out_max)
 {
-#ifdef EPID_FEATURE_VALID_FLT
     const float y_prev = ctx->y_out;
+    /* `delta[k] = a0*x[k] + a1*x[k-1] + a2*x[k-2] + b*SP` */
+#ifdef FP_FAST_FMAF
+    /* Fused multiply-add is available in hardware. */
+    const float delta = fmaf(coef->a0, measure,
+                             fmaf(coef->a1, ctx->xk_1,
+                                  fmaf(coef->a2, ctx->xk_2, coef->b * setpoint)));
+#else
+    const float delta = (coef->a0 * measure)
+                      + (coef->a1 * ctx->xk_1)
+                      + (coef->a2 * ctx->xk_2)
+                      + (coef->b * setpoint);
 #endif
+    const float y = y_prev + delta;
 
-    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
-    ctx->y_out += ctx->p_term + ctx->i_term + ctx->d_term;
+    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = measure;   /* `x[k-1] = x[k]` */
 
-#ifdef EPID_FEATURE_VALID_FLT
-    if ((isnan(ctx->y_out) != 0)
-     || (isnan(ctx->p_term) != 0)
-     || (isnan(ctx->i_term) != 0)
-     || (isnan(ctx->d_term) != 0)
-    ) {
-        ctx->y_out = y_prev;
-    }
-#endif
+    ctx->y_out = epid_tmpl_out_guard(ctx, y, y_prev, out_min, out_max);
 
-    /* Limit the new output `y[k]` (CV) to boundaries. */
-    if (ctx->y_out > out_max) {
-        ctx->y_out = out_max;
-    }
-    else if (ctx->y_out < out_min) {
-        ctx->y_out = out_min;
-    }
+    return delta;
 }
 
 
-void epid_util_ilim(epid_t *ctx, float i_min, float i_max)
+EPID_API void epid_coef_terms(epid_t *ctx, float setpoint, float delta)
 {
-    /* Limit I-term `I[k]` value to boundaries as an integrator anti-windup. */
-    if (ctx->i_term > i_max) {
-        ctx->i_term = i_max;
-    }
-    else if (ctx->i_term < i_min) {
-        ctx->i_term = i_min;
-    }
+    /* After the step: `x[k] = xk_1`, `x[k-1] = xk_2`. */
+    ctx->p_term = ctx->kp * (ctx->xk_2 - ctx->xk_1);
+    ctx->i_term = ctx->ki * (setpoint - ctx->xk_1);
+    ctx->d_term = delta - ctx->p_term - ctx->i_term;
 }
 
 
-epid_info_t epid_util_lpf_init(epid_lpf_t *ctx, float smoothing_factor, float x_0)
-{
-#ifdef EPID_FEATURE_VALID_FLT
-    if ((isfinite(smoothing_factor) == 0)
-     || (isfinite(x_0) == 0)
-    ) {
-        return EPID_ERR_FLT;
-    }
+#if defined(__GNUC__) && !defined(__clang__)
+# ifndef EPID_HEADER_ONLY
+#  pragma GCC pop_options
+# endif
+#else
+# pragma STDC FP_CONTRACT DEFAULT
 #endif
 
-    if ((ctx == NULL)
-     || (smoothing_factor <= EPID_FP_ZERO)
-     || (smoothing_factor >= EPID_FP_ONE)
-    ) {
-        return EPID_ERR_INIT;
-    }
-
-    /* Filter's smoothing factor. `0 < a < 1` */
-    ctx->smoothing_factor = smoothing_factor;
-    /* `y[0] = smoothing_factor * x[0]` */
-    ctx->y = smoothing_factor * x_0;
-
-    return EPID_ERR_NONE;
-}
-
-
-void epid_util_lpf_calc(epid_lpf_t *ctx, float input)
-{
-    /* Infinite-impulse-response (IIR) single-pole low-pass filter,
-     * an exponentially weighted moving average (EMA).
-     * `y[k] = FILTER(x[k]) = y[k-1] + smoothing_factor * (x[k] - y[k-1])`
-     */
-    const float y_prev = ctx->y;
-    ctx->y = y_prev + ctx->smoothing_factor * (input - y_prev);
-}
-
 
 #ifdef __cplusplus
 }
 #endif
+
+#endif /* EPID_C */
@@ -53,11 +53,38 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h> /* For `NULL`. */
 
-/* A switch to define `EPID_FEATURE_VALID_FLT`. */
-#if 1
+/* A switch to define `EPID_FEATURE_VALID_FLT`,
+ * can also be turned off by defining `EPID_NO_VALID_FLT` (e.g. for benchmarks).
+ */
+#if 1 && !defined(EPID_NO_VALID_FLT)
 # define EPID_FEATURE_VALID_FLT 1 /* To check against floating-point errors. */
 /* For `isfinite(), isnan()` (implementation defined). */
 # include <math.h>
+# include <string.h> /* For `memcpy()` of FP bit-patterns. */
+#endif
+
+/* A switch to define `EPID_FEATURE_ATOMICS`, the memory model of the lock-free
+ * channels (<pid_tune.h>, <pid_telem.h>): C11 atomics for multi-core hosts,
+ * else `volatile` 8-bits indexes for single-core MCUs. Set by configuration,
+ * not by the language mode, so C99, C11 and C++ units share one layout.
+ * Turned off by defining `EPID_NO_ATOMICS`, and on AVR (no lock-free 32-bits
+ * atomics).
+ */
+#if 1 && !defined(EPID_NO_ATOMICS) && !defined(__AVR__)
+# define EPID_FEATURE_ATOMICS 1 /* "pid_tune.c" and "pid_telem.c" are empty without C11 atomics. */
+#endif
+
+/* Header-only mode: Define `EPID_HEADER_ONLY` before including <pid.h>
+ * to get `static inline` definitions of all functions in this header,
+ * for full inlining in ISR and tight loops without link-time optimization.
+ * Without it, functions are compiled once in "pid.c" as usual.
+ * With GCC, build with `-ffp-contract=off` (or `-std=c*`) for the results
+ * of the banks bit for bit, see "pid.c".
+ */
+#ifdef EPID_HEADER_ONLY
+# define EPID_API static inline
+#else
+# define EPID_API
 #endif
 
 /* API and behavior semantic versioning. */
@@ -67,13 +94,27 @@ extern "C" {
 #define EPID_FP_ZERO 0.0f
 #define EPID_FP_ONE 1.0f
 
+/* Max error of `epid_coef_pid_step()` in `FLT_EPSILON` units, see it. */
+#define EPID_COEF_ERR_EPS (8U)
+
 /* For errors management; Type: epid_info_t */
 #define EPID_ERR_INIT (0U) /* Bad Initialization. */
 #define EPID_ERR_FLT (1U) /* Floating-point error. */
 #define EPID_ERR_NONE (2U) /* No error detected. */
 
+/* Sticky status flags of `epid_t`; Type: epid_flags_t
+ * Set by `epid_*_sum()`, `epid_*_step()`, cleared only by `epid_init*()`
+ * or the user, so health can be checked once per batch of steps.
+ * NaN/INF flags need `EPID_FEATURE_VALID_FLT`.
+ */
+#define EPID_FLAG_NAN (1U << 0) /* `y[k]` was NaN, `y[k-1]` was kept. */
+#define EPID_FLAG_INF (1U << 1) /* `y[k]` was INF (before the limits). */
+#define EPID_FLAG_SAT_HI (1U << 2) /* `y[k]` was limited to `out_max`. */
+#define EPID_FLAG_SAT_LO (1U << 3) /* `y[k]` was limited to `out_min`. */
+
 
 typedef uint_fast8_t epid_info_t; /* An unsigned type for errors flag. */
+typedef uint_fast8_t epid_flags_t; /* An unsigned type for `EPID_FLAG_*` bits. */
 
 typedef struct {
     /* Controller settings. */
@@ -91,8 +132,33 @@ typedef struct {
     float d_term; /* The D-term calculated value `D[k]`. */
 
     float y_out; /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+
+    epid_flags_t flags; /* Sticky `EPID_FLAG_*` bits, write zero to clear. */
+
+    /* Cached by `epid_init_T()` for `epid_set_gains_T()`, zero if unknown. */
+    float sample_period; /* `Ts` */
+    float sample_rate; /* `1 / Ts` */
 } epid_t;
 
+typedef struct {
+    /* Gains profile, can be shared by many controllers referencing it by index,
+     * see <pid_pool.h> and <pid_bank.h>.
+     */
+    float kp; /* Gain constant `Kp` for P-term. */
+    float ki; /* Gain constant `Ki` for I-term. */
+    float kd; /* Gain constant `Kd` for D-term. */
+} epid_gains_t;
+
+typedef struct {
+    /* Difference equation coefficients of `delta[k]`:
+     * `delta[k] = a0*x[k] + a1*x[k-1] + a2*x[k-2] + b*SP`
+     */
+    float a0; /* `-(Kp + Ki + Kd)` */
+    float a1; /* `Kp + 2*Kd` */
+    float a2; /* `-Kd` */
+    float b;  /* `Ki` */
+} epid_coef_t;
+
 typedef struct {
     float smoothing_factor; /* Filter's smoothing factor. `0 <= a <= 1` */
     float y; /* `y[k] = FILTER(x[k])` */
@@ -101,7 +167,8 @@ typedef struct {
 
 /**
  * Initialize or reset a `epid_t` context by direct gains assignment,
- * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}.
+ * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}, and clear `flags`.
+ * No sample period is cached, see `epid_init_T()`.
  * 
  * ctx: Pointer to the `epid_t` context.
  * xk_1: A process variable (PV) point `x[k-1]`.
@@ -120,14 +187,15 @@ typedef struct {
  *   - `EPID_ERR_INIT` if initialization error occurred.
  *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
  */
-epid_info_t epid_init(epid_t *ctx,
-                      float xk_1, float xk_2, float y_previous,
-                      float kp, float ki, float kd);
+EPID_API epid_info_t epid_init(epid_t *ctx,
+                               float xk_1, float xk_2, float y_previous,
+                               float kp, float ki, float kd);
 
 
 /**
  * Initialize or reset a `epid_t` context by `Kp` gain and time constants `Ti` and `Td`,
- * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}.
+ * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}, and clear `flags`.
+ * `Ts` and `1 / Ts` are cached in the context for `epid_set_gains_T()`.
  * `Ki = Kp / (Ti / Ts) = (Kp * Ts) / Ti`
  * `Kd = Kp * (Td / Ts)`
  * 
@@ -149,10 +217,69 @@ epid_info_t epid_init(epid_t *ctx,
  *   - `EPID_ERR_INIT` if initialization error occurred.
  *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
  */
-epid_info_t epid_init_T(epid_t *ctx,
-                        float xk_1, float xk_2, float y_previous,
-                        float kp, float ti, float td,
-                        float sample_period);
+EPID_API epid_info_t epid_init_T(epid_t *ctx,
+                                 float xk_1, float xk_2, float y_previous,
+                                 float kp, float ti, float td,
+                                 float sample_period);
+
+
+/**
+ * Set new gains of a `epid_t` context by direct assignment, with the same
+ * checks as `epid_init()`, keeping {`x[k-1]`, `x[k-2]`, `y[k-1]`} and `flags`.
+ * Bumpless: The Type-C output is `y[k] = y[k-1] + delta[k]`, so the output
+ * does not jump when the gains change, only `delta[k]` follows the new gains.
+ * On errors the gains are not modified.
+ * 
+ * ctx: Pointer to the `epid_t` context.
+ * kp: Gain constant `Kp` for P-term.
+ * ki: Gain constant `Ki` for I-term.
+ * kd: Gain constant `Kd` for D-term.
+ * 
+ * Return: See `epid_gains_init()`.
+ */
+EPID_API epid_info_t epid_set_gains(epid_t *ctx, float kp, float ki, float kd);
+
+
+/**
+ * Set new gains of a `epid_t` context by `Kp` gain and time constants `Ti`
+ * and `Td` for the sample period cached by `epid_init_T()`, keeping states
+ * as `epid_set_gains()`. One division per call (by `Ti`), as `1 / Ts` is cached.
+ * `Ki = (Kp * Ts) / Ti`
+ * `Kd = Kp * Td * (1 / Ts)`, may differ from `epid_init_T()` by one rounding.
+ * 
+ * ctx: Pointer to the `epid_t` context, initialized by `epid_init_T()`.
+ * kp: Gain constant `Kp` for P-term.
+ * ti: Rate time constant for I-term [1 / time-unit]; `Ti = Kp / Ki`.
+ * td: Reset time constant for D-term [time-unit]; `Td = Kd / Kp`.
+ * 
+ * - {kp, ti, td} must not be negative, {kp, ti} must not be zero.
+ * - {kp, ti, td} must not be NAN, or INF.
+ * 
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if an argument is invalid, or if the context has no
+ *     cached sample period (initialized by `epid_init()`).
+ *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
+ */
+EPID_API epid_info_t epid_set_gains_T(epid_t *ctx, float kp, float ti, float td);
+
+
+/**
+ * Initialize a `epid_gains_t` gains profile, with the same checks as `epid_init()`.
+ * Controllers referencing a profile use its new gains from their next step,
+ * so one write retunes all of them.
+ * 
+ * gains: Pointer to the `epid_gains_t` profile.
+ * kp: Gain constant `Kp` for P-term.
+ * ki: Gain constant `Ki` for I-term.
+ * kd: Gain constant `Kd` for D-term.
+ * 
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
+ */
+EPID_API epid_info_t epid_gains_init(epid_gains_t *gains, float kp, float ki, float kd);
 
 
 /**
@@ -163,7 +290,7 @@ epid_info_t epid_init_T(epid_t *ctx,
  * setpoint: The desired setpoint (SP).
  * measure: Measured process variable (PV).
  */
-void epid_pi_calc(epid_t *ctx, float setpoint, float measure);
+EPID_API void epid_pi_calc(epid_t *ctx, float setpoint, float measure);
 
 
 /**
@@ -175,7 +302,7 @@ void epid_pi_calc(epid_t *ctx, float setpoint, float measure);
  * setpoint: The desired setpoint (SP).
  * measure: Measured process variable (PV).
  */
-void epid_pid_calc(epid_t *ctx, float setpoint, float measure);
+EPID_API void epid_pid_calc(epid_t *ctx, float setpoint, float measure);
 
 
 /**
@@ -184,12 +311,14 @@ void epid_pid_calc(epid_t *ctx, float setpoint, float measure);
  * `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]`
  * Note: If `y[k-1]` was FP NaN this will never result normal `y[k]` FP value,
  * so checking `epid_init*()` errors is recommended.
+ * Note: Updates `EPID_FLAG_*` in `flags`, NaN/INF are detected by
+ * bit-pattern tests, so they work with `-ffast-math`.
  * 
  * ctx: Pointer to the `epid_t` context.
  * out_min: Min output from controller.
  * out_max: Max output from controller.
  */
-void epid_pi_sum(epid_t *ctx, float out_min, float out_max);
+EPID_API void epid_pi_sum(epid_t *ctx, float out_min, float out_max);
 
 
 /**
@@ -199,12 +328,13 @@ void epid_pi_sum(epid_t *ctx, float out_min, float out_max);
  * Note: There is NO noise filtering on the derivative-term (`D[k]`).
  * Note: If `y[k-1]` was FP NaN this will never result normal `y[k]` FP value,
  * so checking `epid_init*()` errors is recommended.
+ * Note: Updates `EPID_FLAG_*` in `flags`, as `epid_pi_sum()`.
  * 
  * ctx: Pointer to the `epid_t` context.
  * out_min: Min output from controller.
  * out_max: Max output from controller.
  */
-void epid_pid_sum(epid_t *ctx, float out_min, float out_max);
+EPID_API void epid_pid_sum(epid_t *ctx, float out_min, float out_max);
 
 
 /**
@@ -215,7 +345,100 @@ void epid_pid_sum(epid_t *ctx, float out_min, float out_max);
  * i_min: Min `I[k]` value.
  * i_max: Max `I[k]` value.
  */
-void epid_util_ilim(epid_t *ctx, float i_min, float i_max);
+EPID_API void epid_util_ilim(epid_t *ctx, float i_min, float i_max);
+
+
+/**
+ * Do processing as a Type-C PI controller in one call, same as
+ * `epid_pi_calc()`, `epid_util_ilim()` then `epid_pi_sum()`,
+ * and update terms {`P[k]`, `I[k]`} and `y[k]` in `epid_t` context.
+ * 
+ * ctx: Pointer to the `epid_t` context.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ * i_min: Min `I[k]` value.
+ * i_max: Max `I[k]` value.
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ */
+EPID_API void epid_pi_step(epid_t *ctx, float setpoint, float measure,
+                           float i_min, float i_max,
+                           float out_min, float out_max);
+
+
+/**
+ * Do processing as a Type-C PID controller in one call, same as
+ * `epid_pid_calc()`, `epid_util_ilim()` then `epid_pid_sum()`,
+ * and update terms {`P[k]`, `I[k]`, `D[k]`} and `y[k]` in `epid_t` context.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ * 
+ * ctx: Pointer to the `epid_t` context.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ * i_min: Min `I[k]` value.
+ * i_max: Max `I[k]` value.
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ */
+EPID_API void epid_pid_step(epid_t *ctx, float setpoint, float measure,
+                            float i_min, float i_max,
+                            float out_min, float out_max);
+
+
+/**
+ * Initialize a `epid_coef_t` from the gains of an `epid_t` context,
+ * for the difference equation form of the Type-C PID controller:
+ * `delta[k] = a0*x[k] + a1*x[k-1] + a2*x[k-2] + b*SP`
+ * Use this function again after any change of the gains.
+ * 
+ * coef: Pointer to the `epid_coef_t` coefficients.
+ * ctx: Pointer to the `epid_t` context, initialized by `epid_init*()`.
+ * 
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
+ */
+EPID_API epid_info_t epid_coef_init(epid_coef_t *coef, const epid_t *ctx);
+
+
+/**
+ * Do processing as a Type-C PID controller by the difference equation form,
+ * and update the control variable (`y[k]`) and states in `epid_t` context.
+ * Same as `epid_pid_calc()` then `epid_pid_sum()`, without computing
+ * and storing terms {`P[k]`, `I[k]`, `D[k]`}.
+ * 
+ * Accuracy: The difference with `P[k] + I[k] + D[k]` of `epid_pid_calc()`
+ * is at most `EPID_COEF_ERR_EPS` times `FLT_EPSILON` times
+ * `M = |a0*x[k]| + |a1*x[k-1]| + |a2*x[k-2]| + |b*SP|` (cancellation
+ * between terms make a bound relative to `delta[k]` itself meaningless).
+ * Note: Updates `EPID_FLAG_*` in `flags`, as `epid_pid_sum()`.
+ * 
+ * coef: Pointer to the `epid_coef_t` coefficients.
+ * ctx: Pointer to the `epid_t` context.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ * 
+ * Return: `delta[k]`, to be given to `epid_coef_terms()` if needed.
+ */
+EPID_API float epid_coef_pid_step(const epid_coef_t *coef, epid_t *ctx,
+                                  float setpoint, float measure,
+                                  float out_min, float out_max);
+
+
+/**
+ * Reconstruct terms {`P[k]`, `I[k]`, `D[k]`} in `epid_t` context after
+ * `epid_coef_pid_step()`, for telemetry.
+ * `P[k]` and `I[k]` are exact, `D[k] = delta[k] - P[k] - I[k]` has the
+ * accuracy of `delta[k]`.
+ * 
+ * ctx: Pointer to the `epid_t` context.
+ * setpoint: The setpoint (SP) given to `epid_coef_pid_step()`.
+ * delta: The value returned by `epid_coef_pid_step()`.
+ */
+EPID_API void epid_coef_terms(epid_t *ctx, float setpoint, float delta);
 
 
 /**
@@ -235,7 +458,7 @@ void epid_util_ilim(epid_t *ctx, float i_min, float i_max);
  *   - `EPID_ERR_INIT` if initialization error occurred.
  *   - `EPID_ERR_FLT` if floating-point arithmetic error occurred.
  */
-epid_info_t epid_util_lpf_init(epid_lpf_t *ctx, float smoothing_factor, float x_0);
+EPID_API epid_info_t epid_util_lpf_init(epid_lpf_t *ctx, float smoothing_factor, float x_0);
 
 
 /**
@@ -249,11 +472,15 @@ epid_info_t epid_util_lpf_init(epid_lpf_t *ctx, float smoothing_factor, float x_
  * ctx: Pointer to the `epid_lpf_t` context.
  * input: Input `x[x]` value to filter.
  */
-void epid_util_lpf_calc(epid_lpf_t *ctx, float input);
+EPID_API void epid_util_lpf_calc(epid_lpf_t *ctx, float input);
 
 
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef EPID_HEADER_ONLY
+# include "pid.c"
+#endif
+
 #endif /* EPID_H */
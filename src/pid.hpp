@@ -0,0 +1,356 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID C++17 header-only interface: `epid::Pid<T, Features...>`.
+ *
+ * Same Type-C equations as <pid.h> for any scalar type `T`, with options
+ * resolved at compile-time so unused branches are not generated:
+ *   - `epid::PI`: PI controller, no D-term (default: PID).
+ *   - `epid::CheckNaN`: Like `EPID_FEATURE_VALID_FLT`, check init arguments
+ *     for NaN/INF and keep `y[k-1]` if `y[k]` is NaN.
+ *   - `epid::OutLimits<Min, Max>`: Fixed output limits (CV),
+ *     else limits are given to `step()`.
+ *   - `epid::ILimits<Min, Max>`: Fixed I-term anti-windup limits.
+ * Limits are integers in C++17, floating-point values are allowed from C++20.
+ *
+ * All functions are `constexpr`, so a controller initialized with `init_T()`
+ * in a constant expression has its gains folded as immediates.
+ *
+ * `Pid<float, CheckNaN>` gives bit for bit the outputs of the `float`
+ * functions of <pid.h> (check: `extras/testing/test_hpp.cpp`) if the
+ * multiply-adds are not contracted to FMA: Clang is told so in this header,
+ * but GCC has no pragma for it that keeps the inlining, so build with
+ * `-ffp-contract=off` (GCC contracts C++ by default, e.g. with `-march=native`).
+ * NaN/INF tests are bit-patterns (`std::bit_cast` or `__builtin_bit_cast`)
+ * for IEEE-754 `float` and `double`, so they keep working with `-ffast-math`.
+ *
+ * Example:
+ *   using Heater = epid::Pid<float, epid::CheckNaN, epid::OutLimits<0, 500>>;
+ *   constexpr Heater heater_0 = Heater::from_T(20.0f, 20.0f, 0.0f,
+ *                                              500.0f, 50.0f, 0.4f, 0.1f);
+ *   Heater heater = heater_0;
+ *   float cv = heater.step(setpoint, measure);
+ */
+
+
+#ifndef EPID_HPP
+#define EPID_HPP 1
+
+#if (__cplusplus < 201703L) && (!defined(_MSVC_LANG) || (_MSVC_LANG < 201703L))
+# error "<pid.hpp> requires C++17 or later."
+#endif
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#if (__cplusplus >= 202002L)
+# include <bit>
+#endif
+
+#include "pid.h" /* For `epid_info_t` and `EPID_ERR_*`. */
+
+/* `constexpr` bit-pattern of a floating-point value. */
+#if defined(__cpp_lib_bit_cast)
+# define EPID_HPP_BIT_CAST(To, x) std::bit_cast<To>(x)
+#elif defined(__has_builtin)
+# if __has_builtin(__builtin_bit_cast)
+#  define EPID_HPP_BIT_CAST(To, x) __builtin_bit_cast(To, x)
+# endif
+#endif
+
+/* No FP contraction in a function body, as "pid.c". */
+#if defined(__clang__)
+# define EPID_HPP_NO_CONTRACT _Pragma("clang fp contract(off)")
+#else
+# define EPID_HPP_NO_CONTRACT
+#endif
+
+
+namespace epid {
+
+/* Controller options. */
+struct PI {};
+struct CheckNaN {};
+
+template <auto Min, auto Max>
+struct OutLimits {
+    static constexpr auto min = Min;
+    static constexpr auto max = Max;
+};
+
+template <auto Min, auto Max>
+struct ILimits {
+    static constexpr auto min = Min;
+    static constexpr auto max = Max;
+};
+
+
+namespace detail {
+
+template <template <auto, auto> class Option, typename Feature>
+struct is_limits : std::false_type {};
+
+template <template <auto, auto> class Option, auto Min, auto Max>
+struct is_limits<Option, Option<Min, Max>> : std::true_type {};
+
+/* First `Option<Min, Max>` of `Features...`, or `void`. */
+template <template <auto, auto> class Option, typename... Features>
+struct find_limits { using type = void; };
+
+template <template <auto, auto> class Option, typename First, typename... Rest>
+struct find_limits<Option, First, Rest...> {
+    using type = std::conditional_t<is_limits<Option, First>::value,
+                                    First,
+                                    typename find_limits<Option, Rest...>::type>;
+};
+
+/* IEEE-754 binary32 and binary64 formats, for the bit-pattern tests. */
+template <typename T>
+constexpr bool has_bits = std::numeric_limits<T>::is_iec559
+                       && ((sizeof(T) == sizeof(std::uint32_t)) || (sizeof(T) == sizeof(std::uint64_t)));
+
+template <typename T>
+using bits_t = std::conditional_t<sizeof(T) == sizeof(std::uint32_t), std::uint32_t, std::uint64_t>;
+
+template <typename T>
+constexpr bits_t<T> abs_mask = std::numeric_limits<bits_t<T>>::max() >> 1;
+
+template <typename T>
+constexpr bits_t<T> exp_mask = (sizeof(T) == sizeof(std::uint32_t))
+                             ? bits_t<T>(UINT32_C(0x7F800000))
+                             : bits_t<T>(UINT64_C(0x7FF0000000000000));
+
+/* `std::isnan()` and `std::isfinite()` are not `constexpr` in C++17, and
+ * `x != x` is assumed false with `-ffast-math`: Bit-patterns as "pid_flt.h"
+ * if possible, else comparisons (e.g. for fixed-point types).
+ */
+template <typename T>
+constexpr bool is_nan(T x) noexcept
+{
+#ifdef EPID_HPP_BIT_CAST
+    if constexpr (has_bits<T>) {
+        return (EPID_HPP_BIT_CAST(bits_t<T>, x) & abs_mask<T>) > exp_mask<T>;
+    }
+#endif
+    return x != x;
+}
+
+template <typename T>
+constexpr bool is_finite(T x) noexcept
+{
+#ifdef EPID_HPP_BIT_CAST
+    if constexpr (has_bits<T>) {
+        return (EPID_HPP_BIT_CAST(bits_t<T>, x) & exp_mask<T>) != exp_mask<T>;
+    }
+#endif
+    return (x - x) == (x - x); /* NaN for both NaN and INF. */
+}
+
+template <typename T>
+constexpr T clamp(T x, T lo, T hi) noexcept
+{
+    /* Same order as <pid.h>: `x > hi` first, keeps NaN. */
+    if (x > hi) {
+        return hi;
+    }
+    else if (x < lo) {
+        return lo;
+    }
+    return x;
+}
+
+} /* namespace detail */
+
+
+template <typename T, typename... Features>
+class Pid {
+public:
+    using value_type = T;
+
+    static constexpr bool is_pi = (std::is_same_v<Features, PI> || ...);
+    static constexpr bool check_nan = (std::is_same_v<Features, CheckNaN> || ...);
+
+    using out_limits = typename detail::find_limits<OutLimits, Features...>::type;
+    using i_limits = typename detail::find_limits<ILimits, Features...>::type;
+    static constexpr bool has_out_limits = !std::is_void_v<out_limits>;
+    static constexpr bool has_i_limits = !std::is_void_v<i_limits>;
+
+    /* Controller settings. */
+    T kp = T(0); /* Gain constant `Kp` for P-term. */
+    T ki = T(0); /* Gain constant `Ki` for I-term. */
+    T kd = T(0); /* Gain constant `Kd` for D-term, unused by `PI`. */
+
+    /* Controller states. */
+    T xk_1 = T(0); /* Physical measurement `PV[k-1]`. */
+    T xk_2 = T(0); /* Physical measurement `PV[k-2]`, unused by `PI`. */
+
+    /* Controller outputs. */
+    T p_term = T(0); /* The P-term calculated value `P[k]`. */
+    T i_term = T(0); /* The I-term calculated value `I[k]`. */
+    T d_term = T(0); /* The D-term calculated value `D[k]`, zero for `PI`. */
+
+    T y_out = T(0); /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+
+
+    /* Same as `epid_init()`. */
+    constexpr epid_info_t init(T xk_1_, T xk_2_, T y_previous,
+                               T kp_, T ki_, T kd_) noexcept
+    {
+        if constexpr (check_nan) {
+            if (!detail::is_finite(xk_1_)
+             || !detail::is_finite(xk_2_)
+             || !detail::is_finite(y_previous)
+             || !detail::is_finite(kp_)
+             || !detail::is_finite(ki_)
+             || !detail::is_finite(kd_)
+            ) {
+                return EPID_ERR_FLT;
+            }
+        }
+
+        if ((kp_ <= T(0))
+         || (ki_ <= T(0))
+         || (kd_ < T(0))
+        ) {
+            return EPID_ERR_INIT;
+        }
+
+        xk_1 = xk_1_;
+        xk_2 = xk_2_;
+        y_out = y_previous;
+        kp = kp_;
+        ki = ki_;
+        kd = kd_;
+
+        return EPID_ERR_NONE;
+    }
+
+
+    /* Same as `epid_init_T()`. */
+    constexpr epid_info_t init_T(T xk_1_, T xk_2_, T y_previous,
+                                 T kp_, T ti, T td, T sample_period) noexcept
+    {
+        EPID_HPP_NO_CONTRACT
+        if constexpr (check_nan) {
+            if (!detail::is_finite(ti)
+             || !detail::is_finite(sample_period)
+            ) {
+                return EPID_ERR_FLT;
+            }
+        }
+
+        if ((ti <= T(0))
+         || (td < T(0))
+         || (sample_period <= T(0))
+        ) {
+            return EPID_ERR_INIT;
+        }
+
+        return init(xk_1_, xk_2_, y_previous,
+                    kp_, (kp_ * sample_period) / ti, kp_ * (td / sample_period));
+    }
+
+
+    /* Make an initialized controller; Any init error leaves zero gains,
+     * so use `init_T()` to check errors.
+     */
+    static constexpr Pid from_T(T xk_1_, T xk_2_, T y_previous,
+                                T kp_, T ti, T td, T sample_period) noexcept
+    {
+        Pid ctx{};
+        ctx.init_T(xk_1_, xk_2_, y_previous, kp_, ti, td, sample_period);
+        return ctx;
+    }
+
+    static constexpr Pid from_gains(T xk_1_, T xk_2_, T y_previous,
+                                    T kp_, T ki_, T kd_) noexcept
+    {
+        Pid ctx{};
+        ctx.init(xk_1_, xk_2_, y_previous, kp_, ki_, kd_);
+        return ctx;
+    }
+
+
+    /* Same as `epid_pid_calc()`, or `epid_pi_calc()` for `PI`. */
+    constexpr void calc(T setpoint, T measure) noexcept
+    {
+        EPID_HPP_NO_CONTRACT
+        if constexpr (is_pi) {
+            p_term = kp * (xk_1 - measure);
+            i_term = ki * (setpoint - measure);
+        }
+        else {
+            const T dx = xk_1 - measure;
+            d_term = kd * (xk_1 + dx - xk_2);
+            p_term = kp * dx;
+            i_term = ki * (setpoint - measure);
+            xk_2 = xk_1; /* `x[k-2] = x[k-1]` */
+        }
+        xk_1 = measure; /* `x[k-1] = x[k]` */
+    }
+
+
+    /* Same as `epid_pid_sum()`, or `epid_pi_sum()` for `PI`. */
+    constexpr T sum(T out_min, T out_max) noexcept
+    {
+        EPID_HPP_NO_CONTRACT
+        const T y_prev = y_out;
+        T y = y_prev;
+
+        if constexpr (is_pi) {
+            y += p_term + i_term;
+        }
+        else {
+            y += p_term + i_term + d_term;
+        }
+
+        if constexpr (check_nan) {
+            /* A NaN term always gives a NaN `y[k]`. */
+            if (detail::is_nan(y)) {
+                y = y_prev;
+            }
+        }
+
+        y_out = detail::clamp(y, out_min, out_max);
+        return y_out;
+    }
+
+
+    /* One control step with the output limits given at run-time. */
+    constexpr T step(T setpoint, T measure, T out_min, T out_max) noexcept
+    {
+        calc(setpoint, measure);
+        if constexpr (has_i_limits) {
+            i_term = detail::clamp(i_term, T(i_limits::min), T(i_limits::max));
+        }
+        return sum(out_min, out_max);
+    }
+
+
+    /* One control step with the fixed `OutLimits<Min, Max>`. */
+    template <bool Enable = has_out_limits,
+              typename = std::enable_if_t<Enable>>
+    constexpr T step(T setpoint, T measure) noexcept
+    {
+        return step(setpoint, measure, T(out_limits::min), T(out_limits::max));
+    }
+};
+
+} /* namespace epid */
+
+#endif /* EPID_HPP */
@@ -0,0 +1,670 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_bank.h"
+#include "pid_flt.h"
+
+/* `restrict` is C99 only. */
+#if defined(__cplusplus)
+# define EPID_RESTRICT
+#else
+# define EPID_RESTRICT restrict
+#endif
+
+/* No FP contraction in this file, whatever the compiler flags: The AVX2 and
+ * AVX-512F kernels are built with `target()` attributes enabling FMA, which
+ * GCC contracts by default (`-ffp-contract=fast` without `-std=c*`), and
+ * fused multiply-adds round differently from `epid_pid_calc()`.
+ */
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT OFF
+# pragma clang fp contract(off)
+#elif defined(__GNUC__)
+# pragma GCC optimize("fp-contract=off")
+#else
+# pragma STDC FP_CONTRACT OFF
+#endif
+
+
+epid_info_t epid_bank_init(epid_bank_t *bank, float *mem, size_t n)
+{
+    if ((bank == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(n);
+
+    for (size_t i = 0U; i < EPID_BANK_MEM_LEN(n); i++) {
+        mem[i] = EPID_FP_ZERO;
+    }
+
+    bank->kp    = mem;
+    bank->ki    = mem + stride;
+    bank->kd    = mem + (2U * stride);
+    bank->xk_1  = mem + (3U * stride);
+    bank->xk_2  = mem + (4U * stride);
+    bank->y_out = mem + (5U * stride);
+    bank->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_bank_set(epid_bank_t *bank, size_t i,
+                          float xk_1, float xk_2, float y_previous,
+                          float kp, float ki, float kd)
+{
+    epid_t ctx;
+    epid_info_t err;
+
+    if ((bank == NULL)
+     || (i >= bank->n)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Same checks as a single controller. */
+    err = epid_init(&ctx, xk_1, xk_2, y_previous, kp, ki, kd);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    epid_bank_load(bank, i, &ctx);
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_bank_load(epid_bank_t *bank, size_t i, const epid_t *ctx)
+{
+    bank->kp[i] = ctx->kp;
+    bank->ki[i] = ctx->ki;
+    bank->kd[i] = ctx->kd;
+    bank->xk_1[i] = ctx->xk_1;
+    bank->xk_2[i] = ctx->xk_2;
+    bank->y_out[i] = ctx->y_out;
+}
+
+
+void epid_bank_store(const epid_bank_t *bank, size_t i, epid_t *ctx)
+{
+    ctx->kp = bank->kp[i];
+    ctx->ki = bank->ki[i];
+    ctx->kd = bank->kd[i];
+    ctx->xk_1 = bank->xk_1[i];
+    ctx->xk_2 = bank->xk_2[i];
+    ctx->y_out = bank->y_out[i];
+}
+
+
+epid_info_t epid_lpf_bank_init(epid_lpf_bank_t *bank, float *mem, size_t n)
+{
+    if ((bank == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(n);
+
+    for (size_t i = 0U; i < EPID_LPF_BANK_MEM_LEN(n); i++) {
+        mem[i] = EPID_FP_ZERO;
+    }
+
+    bank->smoothing_factor = mem;
+    bank->y = mem + stride;
+    bank->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_lpf_bank_set(epid_lpf_bank_t *bank, size_t i,
+                              float smoothing_factor, float x_0)
+{
+    epid_lpf_t ctx;
+    epid_info_t err;
+
+    if ((bank == NULL)
+     || (i >= bank->n)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Same checks as a single filter. */
+    err = epid_util_lpf_init(&ctx, smoothing_factor, x_0);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    bank->smoothing_factor[i] = ctx.smoothing_factor;
+    bank->y[i] = ctx.y;
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Scalar kernels over controllers `[begin, end)`, also used for vectors tails. */
+static void epid_bank_pi_scalar(epid_bank_t *bank,
+                                const float *setpoints, const float *measures,
+                                float out_min, float out_max,
+                                size_t begin, size_t end)
+{
+    const float *EPID_RESTRICT kp = bank->kp;
+    const float *EPID_RESTRICT ki = bank->ki;
+    float *EPID_RESTRICT xk_1 = bank->xk_1;
+    float *EPID_RESTRICT y_out = bank->y_out;
+
+    for (size_t i = begin; i < end; i++) {
+        const float measure = measures[i];
+        /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+         * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+         */
+        const float p_term = kp[i] * (xk_1[i] - measure);
+        const float i_term = ki[i] * (setpoints[i] - measure);
+        /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+        float y = y_out[i] + (p_term + i_term);
+
+        xk_1[i] = measure; /* `x[k-1] = x[k]` */
+
+#ifdef EPID_FEATURE_VALID_FLT
+        /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+        y = epid_flt_nan_keep(y, y_out[i]);
+#endif
+
+        /* Limit the new output `y[k]` (CV) to boundaries. */
+        if (y > out_max) {
+            y = out_max;
+        }
+        else if (y < out_min) {
+            y = out_min;
+        }
+
+        y_out[i] = y;
+    }
+}
+
+
+static void epid_bank_pid_scalar(epid_bank_t *bank,
+                                 const float *setpoints, const float *measures,
+                                 float out_min, float out_max,
+                                 size_t begin, size_t end)
+{
+    const float *EPID_RESTRICT kp = bank->kp;
+    const float *EPID_RESTRICT ki = bank->ki;
+    const float *EPID_RESTRICT kd = bank->kd;
+    float *EPID_RESTRICT xk_1 = bank->xk_1;
+    float *EPID_RESTRICT xk_2 = bank->xk_2;
+    float *EPID_RESTRICT y_out = bank->y_out;
+
+    for (size_t i = begin; i < end; i++) {
+        const float measure = measures[i];
+        const float x1 = xk_1[i];
+        /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+         * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+         * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+         * Same operations order as `epid_pid_calc()`.
+         */
+        const float dx = x1 - measure;
+        const float d_term = kd[i] * (x1 + dx - xk_2[i]);
+        const float p_term = kp[i] * dx;
+        const float i_term = ki[i] * (setpoints[i] - measure);
+        /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+        float y = y_out[i] + (p_term + i_term + d_term);
+
+        xk_2[i] = x1;      /* `x[k-2] = x[k-1]` */
+        xk_1[i] = measure; /* `x[k-1] = x[k]` */
+
+#ifdef EPID_FEATURE_VALID_FLT
+        /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+        y = epid_flt_nan_keep(y, y_out[i]);
+#endif
+
+        /* Limit the new output `y[k]` (CV) to boundaries. */
+        if (y > out_max) {
+            y = out_max;
+        }
+        else if (y < out_min) {
+            y = out_min;
+        }
+
+        y_out[i] = y;
+    }
+}
+
+
+/* Scalar kernel over filters `[begin, end)`, also used for vectors tails. */
+static void epid_lpf_bank_scalar(epid_lpf_bank_t *bank, const float *inputs,
+                                 size_t begin, size_t end)
+{
+    const float *EPID_RESTRICT a = bank->smoothing_factor;
+    float *EPID_RESTRICT y = bank->y;
+
+    for (size_t i = begin; i < end; i++) {
+        /* `y[k] = y[k-1] + smoothing_factor * (x[k] - y[k-1])` */
+        const float y_prev = y[i];
+        y[i] = y_prev + a[i] * (inputs[i] - y_prev);
+    }
+}
+
+
+/* Vector kernels.
+ * Every instruction set defines `VEC_*` operations then expands
+ * `EPID_BANK_VEC_KERNELS()`. No fused multiply-add is used (no intrinsics
+ * of it, and no contraction, see above), so lanes give the same results as
+ * the scalar kernels.
+ *
+ * `VEC_FIX(y, y_prev, lo, hi)` is the branchless form of the scalar
+ * `EPID_FEATURE_VALID_FLT` check and output limits: A NaN in any term
+ * propagates to `y[k]`, so a NaN lane mask of `y[k]` selects `y[k-1]`,
+ * then `y[k] > out_max` selects `out_max`, else `y[k] < out_min` selects `out_min`.
+ */
+#define EPID_BANK_VEC_KERNELS(isa, attr) \
+static attr void epid_bank_pi_##isa(epid_bank_t *bank, \
+                                    const float *setpoints, const float *measures, \
+                                    float out_min, float out_max, size_t n) \
+{ \
+    const size_t n_vec = n - (n % VEC_W); \
+    const VEC_T lo = VEC_SET1(out_min); \
+    const VEC_T hi = VEC_SET1(out_max); \
+    size_t i; \
+    for (i = 0U; i < n_vec; i += VEC_W) { \
+        const VEC_T measure = VEC_LD(measures + i); \
+        const VEC_T y_prev = VEC_LD(bank->y_out + i); \
+        const VEC_T p_term = VEC_MUL(VEC_LD(bank->kp + i), \
+                                     VEC_SUB(VEC_LD(bank->xk_1 + i), measure)); \
+        const VEC_T i_term = VEC_MUL(VEC_LD(bank->ki + i), \
+                                     VEC_SUB(VEC_LD(setpoints + i), measure)); \
+        VEC_T y = VEC_ADD(y_prev, VEC_ADD(p_term, i_term)); \
+        VEC_FIX(y, y_prev, lo, hi); \
+        VEC_ST(bank->xk_1 + i, measure); \
+        VEC_ST(bank->y_out + i, y); \
+    } \
+    epid_bank_pi_scalar(bank, setpoints, measures, out_min, out_max, n_vec, n); \
+} \
+\
+static attr void epid_bank_pid_##isa(epid_bank_t *bank, \
+                                     const float *setpoints, const float *measures, \
+                                     float out_min, float out_max, size_t n) \
+{ \
+    const size_t n_vec = n - (n % VEC_W); \
+    const VEC_T lo = VEC_SET1(out_min); \
+    const VEC_T hi = VEC_SET1(out_max); \
+    size_t i; \
+    for (i = 0U; i < n_vec; i += VEC_W) { \
+        const VEC_T measure = VEC_LD(measures + i); \
+        const VEC_T x1 = VEC_LD(bank->xk_1 + i); \
+        const VEC_T y_prev = VEC_LD(bank->y_out + i); \
+        const VEC_T dx = VEC_SUB(x1, measure); \
+        const VEC_T d_term = VEC_MUL(VEC_LD(bank->kd + i), \
+                                     VEC_SUB(VEC_ADD(x1, dx), VEC_LD(bank->xk_2 + i))); \
+        const VEC_T p_term = VEC_MUL(VEC_LD(bank->kp + i), dx); \
+        const VEC_T i_term = VEC_MUL(VEC_LD(bank->ki + i), \
+                                     VEC_SUB(VEC_LD(setpoints + i), measure)); \
+        VEC_T y = VEC_ADD(y_prev, VEC_ADD(VEC_ADD(p_term, i_term), d_term)); \
+        VEC_FIX(y, y_prev, lo, hi); \
+        VEC_ST(bank->xk_2 + i, x1); \
+        VEC_ST(bank->xk_1 + i, measure); \
+        VEC_ST(bank->y_out + i, y); \
+    } \
+    epid_bank_pid_scalar(bank, setpoints, measures, out_min, out_max, n_vec, n); \
+} \
+\
+static attr void epid_lpf_bank_##isa(epid_lpf_bank_t *bank, const float *inputs, size_t n) \
+{ \
+    const size_t n_vec = n - (n % VEC_W); \
+    size_t i; \
+    for (i = 0U; i < n_vec; i += VEC_W) { \
+        const VEC_T y_prev = VEC_LD(bank->y + i); \
+        const VEC_T y = VEC_ADD(y_prev, VEC_MUL(VEC_LD(bank->smoothing_factor + i), \
+                                                VEC_SUB(VEC_LD(inputs + i), y_prev))); \
+        VEC_ST(bank->y + i, y); \
+    } \
+    epid_lpf_bank_scalar(bank, inputs, n_vec, n); \
+}
+
+#ifdef EPID_FEATURE_VALID_FLT
+# define VEC_NAN_REVERT(y, y_prev) VEC_NAN_SEL(y, y_prev)
+#else
+# define VEC_NAN_REVERT(y, y_prev)
+#endif
+
+
+#if defined(EPID_FEATURE_SIMD) \
+ && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+# define EPID_BANK_X86 1
+# include <immintrin.h>
+
+/* SSE2: 4 lanes. */
+# define VEC_W (4U)
+# define VEC_T __m128
+# define VEC_LD(p) _mm_loadu_ps(p)
+# define VEC_ST(p, v) _mm_storeu_ps((p), (v))
+# define VEC_SET1(x) _mm_set1_ps(x)
+# define VEC_ADD(a, b) _mm_add_ps((a), (b))
+# define VEC_SUB(a, b) _mm_sub_ps((a), (b))
+# define VEC_MUL(a, b) _mm_mul_ps((a), (b))
+# define VEC_SSE_SEL(m, a, b) _mm_or_ps(_mm_and_ps((m), (b)), _mm_andnot_ps((m), (a)))
+# define VEC_NAN_SEL(y, y_prev) \
+    y = VEC_SSE_SEL(_mm_cmpunord_ps(y, y), y, y_prev);
+# define VEC_FIX(y, y_prev, lo, hi) do { \
+    VEC_NAN_REVERT(y, y_prev) \
+    y = VEC_SSE_SEL(_mm_cmpgt_ps(y, hi), \
+                    VEC_SSE_SEL(_mm_cmplt_ps(y, lo), y, lo), hi); \
+} while (0)
+EPID_BANK_VEC_KERNELS(sse2, )
+# undef VEC_W
+# undef VEC_T
+# undef VEC_LD
+# undef VEC_ST
+# undef VEC_SET1
+# undef VEC_ADD
+# undef VEC_SUB
+# undef VEC_MUL
+# undef VEC_NAN_SEL
+# undef VEC_FIX
+
+# if defined(__GNUC__) || defined(__clang__)
+#  define EPID_BANK_X86_AVX 1
+
+/* AVX2: 8 lanes. */
+#  define VEC_W (8U)
+#  define VEC_T __m256
+#  define VEC_LD(p) _mm256_loadu_ps(p)
+#  define VEC_ST(p, v) _mm256_storeu_ps((p), (v))
+#  define VEC_SET1(x) _mm256_set1_ps(x)
+#  define VEC_ADD(a, b) _mm256_add_ps((a), (b))
+#  define VEC_SUB(a, b) _mm256_sub_ps((a), (b))
+#  define VEC_MUL(a, b) _mm256_mul_ps((a), (b))
+#  define VEC_NAN_SEL(y, y_prev) \
+    y = _mm256_blendv_ps(y, y_prev, _mm256_cmp_ps(y, y, _CMP_UNORD_Q));
+#  define VEC_FIX(y, y_prev, lo, hi) do { \
+    VEC_NAN_REVERT(y, y_prev) \
+    y = _mm256_blendv_ps(_mm256_blendv_ps(y, lo, _mm256_cmp_ps(y, lo, _CMP_LT_OQ)), \
+                         hi, _mm256_cmp_ps(y, hi, _CMP_GT_OQ)); \
+} while (0)
+EPID_BANK_VEC_KERNELS(avx2, __attribute__((target("avx2"))))
+#  undef VEC_W
+#  undef VEC_T
+#  undef VEC_LD
+#  undef VEC_ST
+#  undef VEC_SET1
+#  undef VEC_ADD
+#  undef VEC_SUB
+#  undef VEC_MUL
+#  undef VEC_NAN_SEL
+#  undef VEC_FIX
+
+/* AVX-512F: 16 lanes. */
+#  define VEC_W (16U)
+#  define VEC_T __m512
+#  define VEC_LD(p) _mm512_loadu_ps(p)
+#  define VEC_ST(p, v) _mm512_storeu_ps((p), (v))
+#  define VEC_SET1(x) _mm512_set1_ps(x)
+#  define VEC_ADD(a, b) _mm512_add_ps((a), (b))
+#  define VEC_SUB(a, b) _mm512_sub_ps((a), (b))
+#  define VEC_MUL(a, b) _mm512_mul_ps((a), (b))
+#  define VEC_NAN_SEL(y, y_prev) \
+    y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, y, _CMP_UNORD_Q), y, y_prev);
+#  define VEC_FIX(y, y_prev, lo, hi) do { \
+    VEC_NAN_REVERT(y, y_prev) \
+    y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, hi, _CMP_GT_OQ), \
+            _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, lo, _CMP_LT_OQ), y, lo), hi); \
+} while (0)
+EPID_BANK_VEC_KERNELS(avx512f, __attribute__((target("avx512f"))))
+#  undef VEC_W
+#  undef VEC_T
+#  undef VEC_LD
+#  undef VEC_ST
+#  undef VEC_SET1
+#  undef VEC_ADD
+#  undef VEC_SUB
+#  undef VEC_MUL
+#  undef VEC_NAN_SEL
+#  undef VEC_FIX
+# endif /* defined(__GNUC__) || defined(__clang__) */
+
+#elif defined(EPID_FEATURE_SIMD) \
+ && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+# define EPID_BANK_NEON 1
+# include <arm_neon.h>
+
+/* NEON: 4 lanes. */
+# define VEC_W (4U)
+# define VEC_T float32x4_t
+# define VEC_LD(p) vld1q_f32(p)
+# define VEC_ST(p, v) vst1q_f32((p), (v))
+# define VEC_SET1(x) vdupq_n_f32(x)
+# define VEC_ADD(a, b) vaddq_f32((a), (b))
+# define VEC_SUB(a, b) vsubq_f32((a), (b))
+# define VEC_MUL(a, b) vmulq_f32((a), (b))
+# define VEC_NAN_SEL(y, y_prev) \
+    y = vbslq_f32(vceqq_f32(y, y), y, y_prev);
+# define VEC_FIX(y, y_prev, lo, hi) do { \
+    VEC_NAN_REVERT(y, y_prev) \
+    y = vbslq_f32(vcgtq_f32(y, hi), hi, vbslq_f32(vcltq_f32(y, lo), lo, y)); \
+} while (0)
+EPID_BANK_VEC_KERNELS(neon, )
+# undef VEC_W
+# undef VEC_T
+# undef VEC_LD
+# undef VEC_ST
+# undef VEC_SET1
+# undef VEC_ADD
+# undef VEC_SUB
+# undef VEC_MUL
+# undef VEC_NAN_SEL
+# undef VEC_FIX
+#endif
+
+
+typedef void (*epid_bank_kernel_t)(epid_bank_t *bank,
+                                   const float *setpoints, const float *measures,
+                                   float out_min, float out_max, size_t n);
+
+static void epid_bank_pi_portable(epid_bank_t *bank,
+                                  const float *setpoints, const float *measures,
+                                  float out_min, float out_max, size_t n)
+{
+    epid_bank_pi_scalar(bank, setpoints, measures, out_min, out_max, 0U, n);
+}
+
+static void epid_bank_pid_portable(epid_bank_t *bank,
+                                   const float *setpoints, const float *measures,
+                                   float out_min, float out_max, size_t n)
+{
+    epid_bank_pid_scalar(bank, setpoints, measures, out_min, out_max, 0U, n);
+}
+
+typedef void (*epid_lpf_bank_kernel_t)(epid_lpf_bank_t *bank, const float *inputs, size_t n);
+
+static void epid_lpf_bank_portable(epid_lpf_bank_t *bank, const float *inputs, size_t n)
+{
+    epid_lpf_bank_scalar(bank, inputs, 0U, n);
+}
+
+/* Selected kernels, `NULL` until the first dispatch. */
+static epid_bank_kernel_t epid_bank_pi_kernel = NULL;
+static epid_bank_kernel_t epid_bank_pid_kernel = NULL;
+static epid_lpf_bank_kernel_t epid_lpf_bank_kernel = NULL;
+static const char *epid_bank_kernel = "scalar";
+
+
+/* Select kernels once by the CPU features (`cpuid` on x86).
+ * Racing first calls from many threads store the same values.
+ */
+static void epid_bank_dispatch(void)
+{
+    epid_bank_kernel_t pi_kernel = epid_bank_pi_portable;
+    epid_bank_kernel_t pid_kernel = epid_bank_pid_portable;
+    epid_lpf_bank_kernel_t lpf_kernel = epid_lpf_bank_portable;
+    const char *name = "scalar";
+
+#if defined(EPID_BANK_X86)
+    pi_kernel = epid_bank_pi_sse2;
+    pid_kernel = epid_bank_pid_sse2;
+    lpf_kernel = epid_lpf_bank_sse2;
+    name = "sse2";
+# if defined(EPID_BANK_X86_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        pi_kernel = epid_bank_pi_avx512f;
+        pid_kernel = epid_bank_pid_avx512f;
+        lpf_kernel = epid_lpf_bank_avx512f;
+        name = "avx512f";
+    }
+    else if (__builtin_cpu_supports("avx2")) {
+        pi_kernel = epid_bank_pi_avx2;
+        pid_kernel = epid_bank_pid_avx2;
+        lpf_kernel = epid_lpf_bank_avx2;
+        name = "avx2";
+    }
+# endif
+#elif defined(EPID_BANK_NEON)
+    pi_kernel = epid_bank_pi_neon;
+    pid_kernel = epid_bank_pid_neon;
+    lpf_kernel = epid_lpf_bank_neon;
+    name = "neon";
+#endif
+
+    epid_bank_kernel = name;
+    epid_bank_pi_kernel = pi_kernel;
+    epid_bank_pid_kernel = pid_kernel;
+    epid_lpf_bank_kernel = lpf_kernel;
+}
+
+
+void epid_bank_pi_step(epid_bank_t *bank,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n)
+{
+    if (epid_bank_pi_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    epid_bank_pi_kernel(bank, setpoints, measures, out_min, out_max, n);
+}
+
+
+void epid_bank_pid_step(epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n)
+{
+    if (epid_bank_pid_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    epid_bank_pid_kernel(bank, setpoints, measures, out_min, out_max, n);
+}
+
+
+/* Gather gains of a block by index into the bank gains arrays, then run
+ * `kernel` on a bank view of the block, so the vector kernels are used
+ * unchanged for every instruction set. Blocks are large enough for the
+ * gathered gains to be out of the store buffer when the kernel loads them,
+ * and small enough to stay in cache.
+ */
+static void epid_bank_step_gains(epid_bank_kernel_t kernel, int with_kd,
+                                 epid_bank_t *bank,
+                                 const epid_gains_t *gains, const uint32_t *gains_index,
+                                 const float *setpoints, const float *measures,
+                                 float out_min, float out_max, size_t n)
+{
+    epid_bank_t view;
+
+    for (size_t begin = 0U; begin < n; begin += EPID_BANK_GATHER) {
+        const size_t len = ((n - begin) < EPID_BANK_GATHER) ? (n - begin) : EPID_BANK_GATHER;
+        float *EPID_RESTRICT kp = bank->kp + begin;
+        float *EPID_RESTRICT ki = bank->ki + begin;
+        float *EPID_RESTRICT kd = bank->kd + begin;
+
+        for (size_t j = 0U; j < len; j++) {
+            const epid_gains_t *g = &gains[gains_index[begin + j]];
+            kp[j] = g->kp;
+            ki[j] = g->ki;
+            if (with_kd) {
+                kd[j] = g->kd;
+            }
+        }
+
+        view.kp = kp;
+        view.ki = ki;
+        view.kd = kd;
+        view.xk_1 = bank->xk_1 + begin;
+        view.xk_2 = bank->xk_2 + begin;
+        view.y_out = bank->y_out + begin;
+        view.n = len;
+
+        kernel(&view, setpoints + begin, measures + begin, out_min, out_max, len);
+    }
+}
+
+
+void epid_bank_pi_step_gains(epid_bank_t *bank,
+                             const epid_gains_t *gains, const uint32_t *gains_index,
+                             const float *setpoints, const float *measures,
+                             float out_min, float out_max, size_t n)
+{
+    if (epid_bank_pi_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    epid_bank_step_gains(epid_bank_pi_kernel, 0, bank, gains, gains_index,
+                         setpoints, measures, out_min, out_max, n);
+}
+
+
+void epid_bank_pid_step_gains(epid_bank_t *bank,
+                              const epid_gains_t *gains, const uint32_t *gains_index,
+                              const float *setpoints, const float *measures,
+                              float out_min, float out_max, size_t n)
+{
+    if (epid_bank_pid_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    epid_bank_step_gains(epid_bank_pid_kernel, 1, bank, gains, gains_index,
+                         setpoints, measures, out_min, out_max, n);
+}
+
+
+const char *epid_bank_kernel_name(void)
+{
+    if (epid_bank_pid_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    return epid_bank_kernel;
+}
+
+
+void epid_lpf_bank_calc(epid_lpf_bank_t *bank, const float *inputs, size_t n)
+{
+    if (epid_lpf_bank_kernel == NULL) {
+        epid_bank_dispatch();
+    }
+    epid_lpf_bank_kernel(bank, inputs, n);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,275 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID controller bank: Many Type-C PID controllers stored as
+ * structure-of-arrays (SoA) and updated in one pass.
+ *
+ * Every controller `i` of a bank follows the same equations as an `epid_t`
+ * processed by `epid_pid_calc()` then `epid_pid_sum()`, and the results are
+ * bit for bit identical to the scalar functions (no `-ffast-math`).
+ * FP contraction into fused multiply-adds is turned off in "pid.c" and
+ * "pid_bank.c" by pragmas, as it is enabled by default on GCC and
+ * the vector kernels are built for instruction sets with FMA.
+ *
+ * Memory layout of a bank of `n` controllers, `stride = EPID_BANK_STRIDE(n)`:
+ * `kp[stride] ki[stride] kd[stride] xk_1[stride] xk_2[stride] y_out[stride]`
+ * If the memory block is aligned to `EPID_BANK_ALIGN` bytes, every array is.
+ */
+
+
+#ifndef EPID_BANK_H
+#define EPID_BANK_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+/* A switch to define `EPID_FEATURE_SIMD`. */
+#if 1
+/* Use SIMD kernels (SSE2, AVX2, AVX-512F, NEON) for banks processing,
+ * selected at run-time by the CPU features when available.
+ */
+# define EPID_FEATURE_SIMD 1
+#endif
+
+/* Floats per bank row padding; One 64-bytes cache line of 32-bits floats. */
+#define EPID_BANK_LANES (16U)
+/* Alignment in bytes of the bank memory block and of its arrays. */
+#define EPID_BANK_ALIGN (64U)
+
+/* Number of floats in every bank array for `n` controllers. */
+#define EPID_BANK_STRIDE(n) \
+    ((((size_t)(n)) + (EPID_BANK_LANES - 1U)) & ~((size_t)EPID_BANK_LANES - 1U))
+/* Number of floats in the memory block needed by a bank of `n` controllers. */
+#define EPID_BANK_MEM_LEN(n) (6U * EPID_BANK_STRIDE(n))
+/* Number of floats in the memory block needed by a LPF bank of `n` filters. */
+#define EPID_LPF_BANK_MEM_LEN(n) (2U * EPID_BANK_STRIDE(n))
+
+/* Controllers per gains gather block of `epid_bank_p*_step_gains()`,
+ * a multiple of `EPID_BANK_LANES`.
+ */
+#ifndef EPID_BANK_GATHER
+# define EPID_BANK_GATHER (512U)
+#endif
+
+/* Alignment attribute for a statically allocated bank memory block. */
+#if defined(__GNUC__) || defined(__clang__)
+# define EPID_ALIGNED(x) __attribute__((aligned(x)))
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+# define EPID_ALIGNED(x) _Alignas(x)
+#else
+# define EPID_ALIGNED(x)
+#endif
+
+
+typedef struct {
+    /* Controllers settings. */
+    float *kp; /* Gain constants `Kp` for P-term. */
+    float *ki; /* Gain constants `Ki` for I-term. */
+    float *kd; /* Gain constants `Kd` for D-term. */
+
+    /* Controllers states and outputs. */
+    float *xk_1; /* Physical measurements `PV[k-1]`. */
+    float *xk_2; /* Physical measurements `PV[k-2]`. */
+    float *y_out; /* The controllers outputs (CV). `y[k] = y[k-1] + delta[k]` */
+
+    size_t n; /* Number of controllers in the bank. */
+} epid_bank_t;
+
+typedef struct {
+    /* Many `epid_lpf_t` filters, same layout rules as `epid_bank_t`:
+     * `smoothing_factor[stride] y[stride]`
+     */
+    float *smoothing_factor; /* Filters smoothing factors. `0 < a < 1` */
+    float *y; /* `y[k] = FILTER(x[k])` */
+
+    size_t n; /* Number of filters in the bank. */
+} epid_lpf_bank_t;
+
+
+/**
+ * Initialize a `epid_bank_t` context over a memory block.
+ * All gains and states are set to zero, so every controller must be set by
+ * `epid_bank_set()` or `epid_bank_load()` before processing.
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * mem: Memory block of at least `EPID_BANK_MEM_LEN(n)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of controllers.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_bank_init(epid_bank_t *bank, float *mem, size_t n);
+
+
+/**
+ * Initialize or reset the controller `i` of a bank by direct gains assignment,
+ * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}, with the same checks as `epid_init()`.
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * i: Index of the controller, `i < bank->n`.
+ * Other arguments and return values: See `epid_init()`.
+ */
+epid_info_t epid_bank_set(epid_bank_t *bank, size_t i,
+                          float xk_1, float xk_2, float y_previous,
+                          float kp, float ki, float kd);
+
+
+/**
+ * Copy settings and states of an `epid_t` context into the controller `i`
+ * of a bank, to migrate a loop to the batched processing.
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * i: Index of the controller, `i < bank->n`.
+ * ctx: Pointer to the source `epid_t` context.
+ */
+void epid_bank_load(epid_bank_t *bank, size_t i, const epid_t *ctx);
+
+
+/**
+ * Copy settings and states of the controller `i` of a bank into
+ * an `epid_t` context. Terms {`P[k]`, `I[k]`, `D[k]`} are not modified.
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * i: Index of the controller, `i < bank->n`.
+ * ctx: Pointer to the destination `epid_t` context.
+ */
+void epid_bank_store(const epid_bank_t *bank, size_t i, epid_t *ctx);
+
+
+/**
+ * Do processing as Type-C PI controllers for the first `n` controllers of
+ * a bank, same as `epid_pi_calc()` then `epid_pi_sum()` for each one.
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * setpoints: The desired setpoints (SP), `n` values.
+ * measures: Measured process variables (PV), `n` values.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ * n: Number of controllers to process, `n <= bank->n`.
+ */
+void epid_bank_pi_step(epid_bank_t *bank,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n);
+
+
+/**
+ * Do processing as Type-C PID controllers for the first `n` controllers of
+ * a bank, same as `epid_pid_calc()` then `epid_pid_sum()` for each one.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ *
+ * bank: Pointer to the `epid_bank_t` context.
+ * setpoints: The desired setpoints (SP), `n` values.
+ * measures: Measured process variables (PV), `n` values.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ * n: Number of controllers to process, `n <= bank->n`.
+ */
+void epid_bank_pid_step(epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n);
+
+
+/**
+ * Same as `epid_bank_pi_step()`, with gains from shared `epid_gains_t`
+ * profiles referenced by index, so one profile write retunes all controllers
+ * referencing it. Gains are gathered by blocks of `EPID_BANK_GATHER`
+ * controllers into the bank gains arrays (overwritten, used as a cache),
+ * then processed by the same kernels as `epid_bank_pi_step()`.
+ *
+ * bank: Pointer to the `epid_bank_t` context, for states and outputs.
+ * gains: Gains profiles table, see `epid_gains_init()`.
+ * gains_index: Gains profile index of every controller, `n` values.
+ * Other arguments: See `epid_bank_pi_step()`.
+ */
+void epid_bank_pi_step_gains(epid_bank_t *bank,
+                             const epid_gains_t *gains, const uint32_t *gains_index,
+                             const float *setpoints, const float *measures,
+                             float out_min, float out_max, size_t n);
+
+
+/**
+ * Same as `epid_bank_pid_step()`, with gains from shared `epid_gains_t`
+ * profiles referenced by index, see `epid_bank_pi_step_gains()`.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ */
+void epid_bank_pid_step_gains(epid_bank_t *bank,
+                              const epid_gains_t *gains, const uint32_t *gains_index,
+                              const float *setpoints, const float *measures,
+                              float out_min, float out_max, size_t n);
+
+
+/**
+ * Get the name of the kernel used by `epid_bank_pi*_step()`,
+ * one of: "scalar", "sse2", "avx2", "avx512f", "neon".
+ *
+ * Return: A static string.
+ */
+const char *epid_bank_kernel_name(void);
+
+
+/**
+ * Initialize a `epid_lpf_bank_t` context over a memory block.
+ * All smoothing factors and outputs are set to zero (filters hold zero),
+ * so every filter should be set by `epid_lpf_bank_set()` before processing.
+ *
+ * bank: Pointer to the `epid_lpf_bank_t` context.
+ * mem: Memory block of at least `EPID_LPF_BANK_MEM_LEN(n)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of filters.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_lpf_bank_init(epid_lpf_bank_t *bank, float *mem, size_t n);
+
+
+/**
+ * Initialize or reset the filter `i` of a LPF bank,
+ * with the same checks as `epid_util_lpf_init()`.
+ *
+ * bank: Pointer to the `epid_lpf_bank_t` context.
+ * i: Index of the filter, `i < bank->n`.
+ * Other arguments and return values: See `epid_util_lpf_init()`.
+ */
+epid_info_t epid_lpf_bank_set(epid_lpf_bank_t *bank, size_t i,
+                              float smoothing_factor, float x_0);
+
+
+/**
+ * Apply the first `n` filters of a LPF bank to their inputs, same as
+ * `epid_util_lpf_calc()` for each one (bit for bit, see above).
+ *
+ * bank: Pointer to the `epid_lpf_bank_t` context.
+ * inputs: Inputs `x[k]`, `n` values, e.g. `y_out` of a controller bank.
+ * n: Number of filters to process, `n <= bank->n`.
+ */
+void epid_lpf_bank_calc(epid_lpf_bank_t *bank, const float *inputs, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_BANK_H */
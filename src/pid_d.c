@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_d.h"
+
+#ifdef EPID_D_AVAILABLE
+# define EPID_TMPL_NAME(name) epid_d_##name
+# define EPID_TMPL_STORE double
+# define EPID_TMPL_REAL double
+# define EPID_TMPL_UINT uint64_t
+# define EPID_TMPL_ABS_MASK UINT64_C(0x7FFFFFFFFFFFFFFF)
+# define EPID_TMPL_EXP_MASK UINT64_C(0x7FF0000000000000) /* Also the INF magnitude. */
+# define EPID_TMPL_DEFINE 1
+# include "pid_tmpl.h"
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_d_unavailable_t;
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID double precision build: `epid_d_t`, `epid_d_lpf_t` and `epid_d_*()`,
+ * generated from "pid_tmpl.h" with the same equations and API as the
+ * `float` functions of <pid.h> (e.g. `epid_d_pid_calc()` for `epid_pid_calc()`).
+ * For long-running integrators where `float` rounding of `y[k]` adds up.
+ * Available if `double` is IEEE-754 binary64 (`EPID_D_AVAILABLE` is defined),
+ * not where it is 32-bits (e.g. AVR), as the bit-pattern tests need it.
+ */
+
+
+#ifndef EPID_D_H
+#define EPID_D_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <float.h> /* For `DBL_MANT_DIG` and `DBL_MAX_EXP`. */
+
+#include "pid.h"
+
+#if (DBL_MANT_DIG == 53) && (DBL_MAX_EXP == 1024)
+# define EPID_D_AVAILABLE 1
+
+# define EPID_TMPL_NAME(name) epid_d_##name
+# define EPID_TMPL_STORE double
+# define EPID_TMPL_REAL double
+# define EPID_TMPL_DECLARE 1
+# include "pid_tmpl.h"
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_D_H */
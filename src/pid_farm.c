@@ -0,0 +1,270 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include "pid_farm.h"
+
+#ifdef EPID_FARM_AVAILABLE
+
+#define EPID_FARM_RANGE(head, tail) (((uint64_t)(tail) << 32) | (uint64_t)(head))
+#define EPID_FARM_HEAD(range) ((uint32_t)(range))
+#define EPID_FARM_TAIL(range) ((uint32_t)((range) >> 32))
+
+
+/* Process the chunk `c` of the current tick. */
+static void epid_farm_chunk(epid_farm_t *farm, uint32_t c)
+{
+    const size_t begin = (size_t)c * EPID_FARM_CHUNK;
+    const size_t len = ((farm->n - begin) < EPID_FARM_CHUNK) ? (farm->n - begin) : EPID_FARM_CHUNK;
+    epid_bank_t view;
+
+    view.kp = farm->bank->kp + begin;
+    view.ki = farm->bank->ki + begin;
+    view.kd = farm->bank->kd + begin;
+    view.xk_1 = farm->bank->xk_1 + begin;
+    view.xk_2 = farm->bank->xk_2 + begin;
+    view.y_out = farm->bank->y_out + begin;
+    view.n = len;
+
+    if (farm->is_pid) {
+        epid_bank_pid_step(&view, farm->setpoints + begin, farm->measures + begin,
+                           farm->out_min, farm->out_max, len);
+    }
+    else {
+        epid_bank_pi_step(&view, farm->setpoints + begin, farm->measures + begin,
+                          farm->out_min, farm->out_max, len);
+    }
+}
+
+
+/* Take a chunk from the front of a range (owner), or from its back (thief). */
+static int epid_farm_take(epid_farm_worker_t *w, int front, uint32_t *c)
+{
+    uint64_t range = atomic_load_explicit(&w->range, memory_order_acquire);
+
+    for (;;) {
+        const uint32_t head = EPID_FARM_HEAD(range);
+        const uint32_t tail = EPID_FARM_TAIL(range);
+        uint64_t next;
+
+        if (head >= tail) {
+            return 0;
+        }
+        next = front ? EPID_FARM_RANGE(head + 1U, tail) : EPID_FARM_RANGE(head, tail - 1U);
+
+        if (atomic_compare_exchange_weak_explicit(&w->range, &range, next,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *c = front ? head : (tail - 1U);
+            return 1;
+        }
+    }
+}
+
+
+/* Process chunks of the current tick until none is left, own range first. */
+static void epid_farm_work(epid_farm_t *farm, size_t self)
+{
+    epid_farm_worker_t *w = &farm->workers[self];
+    uint32_t c;
+
+    for (;;) {
+        int got = epid_farm_take(w, 1, &c);
+
+        /* Steal from the next threads, in order. */
+        for (size_t k = 1U; (!got) && (k < farm->n_threads); k++) {
+            got = epid_farm_take(&farm->workers[(self + k) % farm->n_threads], 0, &c);
+            if (got) {
+                w->steals++;
+            }
+        }
+        if (!got) {
+            return;
+        }
+
+        epid_farm_chunk(farm, c);
+        w->chunks++;
+
+        if (atomic_fetch_sub_explicit(&farm->remaining, 1U, memory_order_acq_rel) == 1U) {
+            /* Last chunk of the tick. */
+            pthread_mutex_lock(&farm->lock);
+            pthread_cond_signal(&farm->done);
+            pthread_mutex_unlock(&farm->lock);
+        }
+    }
+}
+
+
+static void *epid_farm_thread(void *arg)
+{
+    epid_farm_worker_t *w = (epid_farm_worker_t *)arg;
+    epid_farm_t *farm = w->farm;
+    uint64_t seen = 0U;
+
+    for (;;) {
+        pthread_mutex_lock(&farm->lock);
+        while ((farm->generation == seen) && (!farm->stop)) {
+            pthread_cond_wait(&farm->start, &farm->lock);
+        }
+        seen = farm->generation;
+        if (farm->stop) {
+            pthread_mutex_unlock(&farm->lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&farm->lock);
+
+        epid_farm_work(farm, w->index);
+    }
+}
+
+
+epid_info_t epid_farm_init(epid_farm_t *farm, size_t n_threads)
+{
+    if ((farm == NULL)
+     || (n_threads == 0U)
+     || (n_threads > EPID_FARM_THREADS_MAX)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    farm->n_threads = n_threads;
+    farm->bank = NULL;
+    farm->n = 0U;
+    farm->generation = 0U;
+    farm->stop = 0;
+    atomic_init(&farm->remaining, 0U);
+
+    if (pthread_mutex_init(&farm->lock, NULL) != 0) {
+        return EPID_ERR_INIT;
+    }
+    if (pthread_cond_init(&farm->start, NULL) != 0) {
+        pthread_mutex_destroy(&farm->lock);
+        return EPID_ERR_INIT;
+    }
+    if (pthread_cond_init(&farm->done, NULL) != 0) {
+        pthread_cond_destroy(&farm->start);
+        pthread_mutex_destroy(&farm->lock);
+        return EPID_ERR_INIT;
+    }
+
+    /* Select the bank kernels before threads use them. */
+    (void)epid_bank_kernel_name();
+
+    for (size_t t = 0U; t < n_threads; t++) {
+        epid_farm_worker_t *w = &farm->workers[t];
+        atomic_init(&w->range, EPID_FARM_RANGE(0U, 0U));
+        w->chunks = 0U;
+        w->steals = 0U;
+        w->farm = farm;
+        w->index = t;
+    }
+
+    /* Worker 0 is the calling thread. */
+    for (size_t t = 1U; t < n_threads; t++) {
+        if (pthread_create(&farm->workers[t].thread, NULL,
+                           epid_farm_thread, &farm->workers[t]) != 0) {
+            farm->n_threads = t; /* Join the started ones. */
+            epid_farm_deinit(farm);
+            return EPID_ERR_INIT;
+        }
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_farm_deinit(epid_farm_t *farm)
+{
+    pthread_mutex_lock(&farm->lock);
+    farm->stop = 1;
+    pthread_cond_broadcast(&farm->start);
+    pthread_mutex_unlock(&farm->lock);
+
+    for (size_t t = 1U; t < farm->n_threads; t++) {
+        pthread_join(farm->workers[t].thread, NULL);
+    }
+
+    pthread_cond_destroy(&farm->done);
+    pthread_cond_destroy(&farm->start);
+    pthread_mutex_destroy(&farm->lock);
+}
+
+
+/* Publish a tick, process it with the farm threads, and wait for its end. */
+static void epid_farm_run(epid_farm_t *farm, int is_pid, epid_bank_t *bank,
+                          const float *setpoints, const float *measures,
+                          float out_min, float out_max, size_t n)
+{
+    const size_t n_chunks = (n + (EPID_FARM_CHUNK - 1U)) / EPID_FARM_CHUNK;
+    const size_t n_threads = farm->n_threads;
+
+    if (n_chunks == 0U) {
+        return;
+    }
+
+    farm->bank = bank;
+    farm->setpoints = setpoints;
+    farm->measures = measures;
+    farm->out_min = out_min;
+    farm->out_max = out_max;
+    farm->n = n;
+    farm->is_pid = is_pid;
+    atomic_store_explicit(&farm->remaining, n_chunks, memory_order_relaxed);
+
+    /* Contiguous ranges, the same for the same thread every tick. */
+    for (size_t t = 0U; t < n_threads; t++) {
+        atomic_store_explicit(&farm->workers[t].range,
+                              EPID_FARM_RANGE((t * n_chunks) / n_threads,
+                                              ((t + 1U) * n_chunks) / n_threads),
+                              memory_order_release);
+    }
+
+    pthread_mutex_lock(&farm->lock);
+    farm->generation++;
+    pthread_cond_broadcast(&farm->start);
+    pthread_mutex_unlock(&farm->lock);
+
+    epid_farm_work(farm, 0U);
+
+    /* Tick barrier. */
+    pthread_mutex_lock(&farm->lock);
+    while (atomic_load_explicit(&farm->remaining, memory_order_acquire) != 0U) {
+        pthread_cond_wait(&farm->done, &farm->lock);
+    }
+    pthread_mutex_unlock(&farm->lock);
+}
+
+
+void epid_farm_pi_step(epid_farm_t *farm, epid_bank_t *bank,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n)
+{
+    epid_farm_run(farm, 0, bank, setpoints, measures, out_min, out_max, n);
+}
+
+
+void epid_farm_pid_step(epid_farm_t *farm, epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n)
+{
+    epid_farm_run(farm, 1, bank, setpoints, measures, out_min, out_max, n);
+}
+
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_farm_unavailable_t;
+#endif /* EPID_FARM_AVAILABLE */
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID controller farm: Multi-threaded processing of a controller bank
+ * (<pid_bank.h>) for hosts, one call per tick.
+ *
+ * A bank is sharded into chunks of `EPID_FARM_CHUNK` controllers (cache-sized),
+ * every tick the chunks are split in contiguous ranges over a fixed pool of
+ * threads (the same range for the same thread every tick, for cache reuse),
+ * and a thread that finished its range steals chunks from the end of other
+ * ranges. The step returns when all chunks are done (tick barrier).
+ *
+ * Every controller is processed once per tick by the bank kernels, whose
+ * results do not depend on the chunk boundaries, so results are bit for bit
+ * identical for any number of threads.
+ *
+ * Host only: Needs POSIX threads and C11 atomics (`-std=c11 -pthread`),
+ * `EPID_FARM_AVAILABLE` is defined if available, else "pid_farm.c" is empty.
+ */
+
+
+#ifndef EPID_FARM_H
+#define EPID_FARM_H 1
+
+#if (defined(__unix__) || defined(__APPLE__)) \
+ && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) \
+ && !defined(__STDC_NO_ATOMICS__) && !defined(__cplusplus)
+# define EPID_FARM_AVAILABLE 1
+#endif
+
+#ifdef EPID_FARM_AVAILABLE
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "pid_bank.h"
+
+/* Controllers per chunk, a multiple of `EPID_BANK_LANES`;
+ * 24 bytes of bank state and 8 bytes of inputs per controller: 64 KiB.
+ */
+#ifndef EPID_FARM_CHUNK
+# define EPID_FARM_CHUNK (2048U)
+#endif
+
+/* Max number of threads of a farm, including the calling thread. */
+#ifndef EPID_FARM_THREADS_MAX
+# define EPID_FARM_THREADS_MAX (64U)
+#endif
+
+
+struct epid_farm;
+
+typedef struct {
+    /* Chunks range of this thread, `head` in low 32-bits, `tail` in high 32-bits.
+     * The owner takes chunks at `head`, thieves at `tail - 1`.
+     * One cache line per thread, against false sharing.
+     */
+    _Alignas(64) _Atomic uint64_t range;
+    size_t chunks; /* Chunks processed, for statistics. */
+    size_t steals; /* Chunks stolen from other threads, for statistics. */
+    pthread_t thread;
+    struct epid_farm *farm; /* Owner farm. */
+    size_t index; /* Index of this worker in the farm. */
+} epid_farm_worker_t;
+
+typedef struct epid_farm {
+    epid_farm_worker_t workers[EPID_FARM_THREADS_MAX];
+    size_t n_threads; /* Threads including the calling thread (worker 0). */
+
+    /* Current tick job. */
+    epid_bank_t *bank;
+    const float *setpoints;
+    const float *measures;
+    float out_min;
+    float out_max;
+    size_t n;
+    int is_pid;
+
+    _Atomic size_t remaining; /* Chunks not done in the current tick. */
+    uint64_t generation; /* Ticks count, protected by `lock`. */
+    int stop;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start; /* New tick, or stop. */
+    pthread_cond_t done; /* `remaining` reached zero. */
+} epid_farm_t;
+
+
+/**
+ * Initialize a farm and start its threads.
+ *
+ * farm: Pointer to the `epid_farm_t` context.
+ * n_threads: Number of threads processing ticks, including the thread calling
+ *            the step functions, `1 <= n_threads <= EPID_FARM_THREADS_MAX`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_farm_init(epid_farm_t *farm, size_t n_threads);
+
+
+/**
+ * Stop and join the threads of a farm.
+ *
+ * farm: Pointer to the `epid_farm_t` context.
+ */
+void epid_farm_deinit(epid_farm_t *farm);
+
+
+/**
+ * Do processing of one tick as Type-C PI controllers for the first `n`
+ * controllers of a bank, same as `epid_bank_pi_step()`, by all farm threads.
+ * Not reentrant: One tick at a time per farm.
+ *
+ * farm: Pointer to the `epid_farm_t` context.
+ * Other arguments: See `epid_bank_pi_step()`.
+ */
+void epid_farm_pi_step(epid_farm_t *farm, epid_bank_t *bank,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n);
+
+
+/**
+ * Do processing of one tick as Type-C PID controllers for the first `n`
+ * controllers of a bank, same as `epid_bank_pid_step()`, by all farm threads.
+ * Not reentrant: One tick at a time per farm.
+ *
+ * farm: Pointer to the `epid_farm_t` context.
+ * Other arguments: See `epid_bank_pid_step()`.
+ */
+void epid_farm_pid_step(epid_farm_t *farm, epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n);
+
+#endif /* EPID_FARM_AVAILABLE */
+
+#endif /* EPID_FARM_H */
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID internal header of the library sources: IEEE-754 binary32
+ * bit-pattern tests of floating-point values. Unlike `isnan()` and
+ * `isfinite()`, they are not assumed false by the compiler with
+ * `-ffast-math`, and select without branches.
+ */
+
+
+#ifndef EPID_FLT_H
+#define EPID_FLT_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h> /* For `memcpy()` of FP bit-patterns. */
+
+#define EPID_FLT_ABS_MASK (0x7FFFFFFFUL)
+#define EPID_FLT_EXP_MASK (0x7F800000UL) /* Also the INF magnitude. */
+
+
+static inline uint32_t epid_flt_bits(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+
+/* Non-zero if `x` is neither NaN nor INF. */
+static inline int epid_flt_finite(float x)
+{
+    return (epid_flt_bits(x) & EPID_FLT_EXP_MASK) != EPID_FLT_EXP_MASK;
+}
+
+
+/* One if `x` is NaN, else zero. */
+static inline uint32_t epid_flt_is_nan(float x)
+{
+    return ((epid_flt_bits(x) & EPID_FLT_ABS_MASK) > EPID_FLT_EXP_MASK);
+}
+
+
+/* `y_prev` if `y` is NaN, else `y`; The guard of a new output `y[k]`. */
+static inline float epid_flt_nan_keep(float y, float y_prev)
+{
+    const uint32_t nan_mask = 0U - epid_flt_is_nan(y);
+    const uint32_t out_bits = (epid_flt_bits(y) & ~nan_mask) | (epid_flt_bits(y_prev) & nan_mask);
+
+    memcpy(&y, &out_bits, sizeof(y));
+    return y;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_FLT_H */
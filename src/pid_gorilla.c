@@ -0,0 +1,438 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h> /* For `memcpy()` of FP bit-patterns. */
+
+#include "pid_gorilla.h"
+
+/* XOR window "none": No leading zeros count is 32 for a non-zero XOR. */
+#define EPID_GORILLA_NO_WINDOW (32U)
+
+
+static inline uint32_t epid_gorilla_bits(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+
+static inline float epid_gorilla_float(uint32_t u)
+{
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+
+/* Leading and trailing zeros of a non-zero value. */
+#if defined(__GNUC__) || defined(__clang__)
+/* `unsigned long` is at least 32-bits, also on 16-bits targets. */
+static inline uint32_t epid_gorilla_clz(uint32_t x)
+{
+    return (uint32_t)__builtin_clzl((unsigned long)x) - (uint32_t)((sizeof(unsigned long) * 8U) - 32U);
+}
+
+static inline uint32_t epid_gorilla_ctz(uint32_t x)
+{
+    return (uint32_t)__builtin_ctzl((unsigned long)x);
+}
+#else
+static inline uint32_t epid_gorilla_clz(uint32_t x)
+{
+    uint32_t n = 0U;
+    while ((x & UINT32_C(0x80000000)) == 0U) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+
+static inline uint32_t epid_gorilla_ctz(uint32_t x)
+{
+    uint32_t n = 0U;
+    while ((x & 1U) == 0U) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+}
+#endif
+
+
+/* Float fields of a record, in stream order. */
+static inline void epid_gorilla_fields_get(const epid_telem_rec_t *rec, uint32_t *bits)
+{
+    bits[0] = epid_gorilla_bits(rec->setpoint);
+    bits[1] = epid_gorilla_bits(rec->measure);
+    bits[2] = epid_gorilla_bits(rec->p_term);
+    bits[3] = epid_gorilla_bits(rec->i_term);
+    bits[4] = epid_gorilla_bits(rec->d_term);
+    bits[5] = epid_gorilla_bits(rec->y_out);
+}
+
+
+static inline void epid_gorilla_fields_set(epid_telem_rec_t *rec, const uint32_t *bits)
+{
+    rec->setpoint = epid_gorilla_float(bits[0]);
+    rec->measure = epid_gorilla_float(bits[1]);
+    rec->p_term = epid_gorilla_float(bits[2]);
+    rec->i_term = epid_gorilla_float(bits[3]);
+    rec->d_term = epid_gorilla_float(bits[4]);
+    rec->y_out = epid_gorilla_float(bits[5]);
+}
+
+
+static void epid_gorilla_state_reset(epid_gorilla_state_t *st)
+{
+    st->tick = 0U;
+    st->delta = 1U; /* Expected: One tick per record. */
+    st->flags = 0U;
+    for (uint32_t f = 0U; f < EPID_GORILLA_FIELDS; f++) {
+        st->bits[f] = 0U;
+        st->lead[f] = (uint8_t)EPID_GORILLA_NO_WINDOW;
+        st->trail[f] = 0U;
+    }
+}
+
+
+/* Append the `n` low bits of `v`, `1 <= n <= 32`; Full 32-bits words are stored. */
+static inline void epid_gorilla_put(epid_gorilla_enc_t *enc, uint32_t v, uint32_t n)
+{
+    enc->acc = (enc->acc << n) | v;
+    enc->n_acc += n;
+
+    if (enc->n_acc >= 32U) {
+        uint8_t *p = &enc->buf[enc->pos];
+        uint32_t w;
+
+        enc->n_acc -= 32U;
+        w = (uint32_t)(enc->acc >> enc->n_acc);
+        p[0] = (uint8_t)(w >> 24);
+        p[1] = (uint8_t)(w >> 16);
+        p[2] = (uint8_t)(w >> 8);
+        p[3] = (uint8_t)w;
+        enc->pos += 4U;
+    }
+}
+
+
+epid_info_t epid_gorilla_enc_init(epid_gorilla_enc_t *enc, uint8_t *buf, size_t size)
+{
+    if ((enc == NULL)
+     || (buf == NULL)
+     || (size < (EPID_GORILLA_HEADER + EPID_GORILLA_REC_MAX))
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    enc->buf = buf;
+    enc->size = size;
+    enc->pos = EPID_GORILLA_HEADER;
+    enc->acc = 0U;
+    enc->n_acc = 0U;
+    enc->count = 0U;
+    epid_gorilla_state_reset(&enc->state);
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Ticks delta-of-delta `d` (modulo 2^32), by ranges of the signed value:
+ * `0`: 0; `10` + 7 bits: [-63, 64]; `110` + 9 bits: [-255, 256];
+ * `1110` + 12 bits: [-2047, 2048]; `1111` + 32 bits: Others.
+ */
+static inline void epid_gorilla_put_dod(epid_gorilla_enc_t *enc, uint32_t d)
+{
+    if (d == 0U) {
+        epid_gorilla_put(enc, 0U, 1U);
+    }
+    else if ((d + 63U) <= 127U) {
+        epid_gorilla_put(enc, (UINT32_C(0x2) << 7) | (d + 63U), 2U + 7U);
+    }
+    else if ((d + 255U) <= 511U) {
+        epid_gorilla_put(enc, (UINT32_C(0x6) << 9) | (d + 255U), 3U + 9U);
+    }
+    else if ((d + 2047U) <= 4095U) {
+        epid_gorilla_put(enc, (UINT32_C(0xE) << 12) | (d + 2047U), 4U + 12U);
+    }
+    else {
+        epid_gorilla_put(enc, UINT32_C(0xF), 4U);
+        epid_gorilla_put(enc, d, 32U);
+    }
+}
+
+
+/* Float field `f` by XOR with its previous value:
+ * `0`: Same value; `10` + bits: XOR in the previous window;
+ * `11` + 5 bits leading zeros + 5 bits (length - 1) + bits: New window.
+ */
+static inline void epid_gorilla_put_field(epid_gorilla_enc_t *enc, uint32_t f, uint32_t bits)
+{
+    epid_gorilla_state_t *st = &enc->state;
+    const uint32_t x = bits ^ st->bits[f];
+
+    st->bits[f] = bits;
+    if (x == 0U) {
+        epid_gorilla_put(enc, 0U, 1U);
+    }
+    else {
+        const uint32_t lead = epid_gorilla_clz(x);
+        const uint32_t trail = epid_gorilla_ctz(x);
+
+        const uint32_t len_new = 32U - lead - trail;
+        const uint32_t len_old = 32U - (uint32_t)st->lead[f] - (uint32_t)st->trail[f];
+
+        /* The previous window if it holds the XOR, and does not cost more
+         * than a new one (10 bits of header).
+         */
+        if ((lead >= st->lead[f]) && (trail >= st->trail[f]) && (len_old <= (len_new + 10U))) {
+            const uint32_t len = len_old;
+
+            epid_gorilla_put(enc, 0x2U, 2U);
+            epid_gorilla_put(enc, x >> st->trail[f], len);
+        }
+        else {
+            const uint32_t len = len_new;
+
+            epid_gorilla_put(enc, (UINT32_C(0x3) << 10) | (lead << 5) | (len - 1U), 12U);
+            epid_gorilla_put(enc, x >> trail, len);
+            st->lead[f] = (uint8_t)lead;
+            st->trail[f] = (uint8_t)trail;
+        }
+    }
+}
+
+
+int epid_gorilla_enc_push(epid_gorilla_enc_t *enc, const epid_telem_rec_t *rec)
+{
+    epid_gorilla_state_t *st = &enc->state;
+    uint32_t bits[EPID_GORILLA_FIELDS];
+
+    if (((enc->size - enc->pos) < EPID_GORILLA_REC_MAX) || (enc->count == UINT32_MAX)) {
+        return 0;
+    }
+
+    epid_gorilla_fields_get(rec, bits);
+
+    if (enc->count == 0U) {
+        /* Block start: A full record. */
+        epid_gorilla_put(enc, rec->tick, 32U);
+        for (uint32_t f = 0U; f < EPID_GORILLA_FIELDS; f++) {
+            epid_gorilla_put(enc, bits[f], 32U);
+            st->bits[f] = bits[f];
+        }
+        epid_gorilla_put(enc, rec->flags, 32U);
+    }
+    else {
+        const uint32_t delta = rec->tick - st->tick;
+
+        epid_gorilla_put_dod(enc, delta - st->delta);
+        st->delta = delta;
+
+        for (uint32_t f = 0U; f < EPID_GORILLA_FIELDS; f++) {
+            epid_gorilla_put_field(enc, f, bits[f]);
+        }
+
+        if (rec->flags == st->flags) {
+            epid_gorilla_put(enc, 0U, 1U);
+        }
+        else {
+            epid_gorilla_put(enc, 1U, 1U);
+            epid_gorilla_put(enc, rec->flags, 32U);
+        }
+    }
+    st->tick = rec->tick;
+    st->flags = rec->flags;
+    enc->count++;
+
+    return 1;
+}
+
+
+size_t epid_gorilla_enc_finish(epid_gorilla_enc_t *enc)
+{
+    /* Pending bits, padded with zeros to a byte. */
+    while (enc->n_acc > 0U) {
+        const uint32_t n = (enc->n_acc < 8U) ? enc->n_acc : 8U;
+
+        enc->n_acc -= n;
+        enc->buf[enc->pos] = (uint8_t)(((enc->acc >> enc->n_acc) << (8U - n)) & 0xFFU);
+        enc->pos++;
+    }
+
+    enc->buf[0] = (uint8_t)enc->count;
+    enc->buf[1] = (uint8_t)(enc->count >> 8);
+    enc->buf[2] = (uint8_t)(enc->count >> 16);
+    enc->buf[3] = (uint8_t)(enc->count >> 24);
+
+    return enc->pos;
+}
+
+
+epid_info_t epid_gorilla_dec_init(epid_gorilla_dec_t *dec, const uint8_t *buf, size_t size)
+{
+    if ((dec == NULL) || (buf == NULL) || (size < EPID_GORILLA_HEADER)) {
+        return EPID_ERR_INIT;
+    }
+
+    dec->buf = buf;
+    dec->size = size;
+    dec->pos = EPID_GORILLA_HEADER;
+    dec->acc = 0U;
+    dec->n_acc = 0U;
+    dec->count = (uint32_t)buf[0]
+               | ((uint32_t)buf[1] << 8)
+               | ((uint32_t)buf[2] << 16)
+               | ((uint32_t)buf[3] << 24);
+    dec->index = 0U;
+    dec->error = 0;
+    epid_gorilla_state_reset(&dec->state);
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Read `n` bits, `1 <= n <= 32`; Zero and `error` set past the block end. */
+static inline uint32_t epid_gorilla_get(epid_gorilla_dec_t *dec, uint32_t n)
+{
+    if (dec->n_acc < n) {
+        if ((dec->size - dec->pos) >= 4U) {
+            const uint8_t *p = &dec->buf[dec->pos];
+
+            dec->acc = (dec->acc << 32)
+                     | ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+                     | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+            dec->n_acc += 32U;
+            dec->pos += 4U;
+        }
+        else {
+            while (dec->n_acc < n) {
+                if (dec->pos >= dec->size) {
+                    dec->error = 1;
+                    return 0U;
+                }
+                dec->acc = (dec->acc << 8) | dec->buf[dec->pos];
+                dec->n_acc += 8U;
+                dec->pos++;
+            }
+        }
+    }
+    dec->n_acc -= n;
+
+    return (uint32_t)((dec->acc >> dec->n_acc) & ((UINT64_C(1) << n) - 1U));
+}
+
+
+static inline uint32_t epid_gorilla_get_dod(epid_gorilla_dec_t *dec)
+{
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        return 0U;
+    }
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        return epid_gorilla_get(dec, 7U) - 63U;
+    }
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        return epid_gorilla_get(dec, 9U) - 255U;
+    }
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        return epid_gorilla_get(dec, 12U) - 2047U;
+    }
+    return epid_gorilla_get(dec, 32U);
+}
+
+
+static inline void epid_gorilla_get_field(epid_gorilla_dec_t *dec, uint32_t f)
+{
+    epid_gorilla_state_t *st = &dec->state;
+
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        return; /* Same value. */
+    }
+
+    if (epid_gorilla_get(dec, 1U) == 0U) {
+        if (st->lead[f] >= EPID_GORILLA_NO_WINDOW) {
+            dec->error = 1; /* No previous window. */
+            return;
+        }
+        st->bits[f] ^= epid_gorilla_get(dec, 32U - (uint32_t)st->lead[f] - (uint32_t)st->trail[f])
+                       << st->trail[f];
+    }
+    else {
+        const uint32_t lead = epid_gorilla_get(dec, 5U);
+        const uint32_t len = epid_gorilla_get(dec, 5U) + 1U;
+
+        if ((lead + len) > 32U) {
+            dec->error = 1;
+            return;
+        }
+        st->lead[f] = (uint8_t)lead;
+        st->trail[f] = (uint8_t)(32U - lead - len);
+        st->bits[f] ^= epid_gorilla_get(dec, len) << st->trail[f];
+    }
+}
+
+
+int epid_gorilla_dec_pop(epid_gorilla_dec_t *dec, epid_telem_rec_t *rec)
+{
+    epid_gorilla_state_t *st = &dec->state;
+
+    if ((dec->index >= dec->count) || (dec->error != 0)) {
+        return 0;
+    }
+
+    if (dec->index == 0U) {
+        st->tick = epid_gorilla_get(dec, 32U);
+        for (uint32_t f = 0U; f < EPID_GORILLA_FIELDS; f++) {
+            st->bits[f] = epid_gorilla_get(dec, 32U);
+        }
+        st->flags = epid_gorilla_get(dec, 32U);
+    }
+    else {
+        st->delta += epid_gorilla_get_dod(dec);
+        st->tick += st->delta;
+
+        for (uint32_t f = 0U; f < EPID_GORILLA_FIELDS; f++) {
+            epid_gorilla_get_field(dec, f);
+        }
+
+        if (epid_gorilla_get(dec, 1U) != 0U) {
+            st->flags = epid_gorilla_get(dec, 32U);
+        }
+    }
+
+    if (dec->error != 0) {
+        return 0;
+    }
+
+    rec->tick = st->tick;
+    epid_gorilla_fields_set(rec, st->bits);
+    rec->flags = st->flags;
+    dec->index++;
+
+    return 1;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
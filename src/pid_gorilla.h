@@ -0,0 +1,159 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID telemetry compression: A streaming encoder/decoder of telemetry records
+ * (`epid_telem_rec_t`, <pid_telem.h>) by the Gorilla time series method
+ * (T. Pelkonen et al., "Gorilla: A fast, scalable, in-memory time series
+ * database," VLDB 2015), lossless.
+ *
+ * - Tick: Delta-of-delta, one bit when ticks are regular.
+ * - SP, PV, P, I, D, CV: XOR with the previous value of the same field, one
+ *   bit when unchanged, else the meaningful bits of the XOR, reusing the
+ *   previous leading/trailing zeros window when it fits.
+ * - Flags: One bit when unchanged.
+ *
+ * Records of one channel (a loop) are encoded in blocks, in a buffer given by
+ * the user; Every block starts with a full record and is decoded alone.
+ * Encoder and decoder states are a few dozen bytes per channel, with no
+ * allocation. Portable C99, usable on embedded targets (compressed telemetry
+ * links) and hosts (archives).
+ *
+ * Block layout: Records count (32-bits, little-endian), then the bit stream,
+ * most significant bit first, padded with zeros to a byte.
+ */
+
+
+#ifndef EPID_GORILLA_H
+#define EPID_GORILLA_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_telem.h"
+
+/* Float fields of a record: SP, PV, P, I, D, CV. */
+#define EPID_GORILLA_FIELDS (6U)
+
+/* Bytes of the block header. */
+#define EPID_GORILLA_HEADER (4U)
+
+/* Max bytes of an encoded record, with the pending bits of the stream. */
+#define EPID_GORILLA_REC_MAX (48U)
+
+
+typedef struct {
+    uint32_t tick; /* Previous tick. */
+    uint32_t delta; /* Previous ticks delta. */
+    uint32_t flags; /* Previous flags. */
+    uint32_t bits[EPID_GORILLA_FIELDS]; /* Previous float fields, bit-patterns. */
+    uint8_t lead[EPID_GORILLA_FIELDS]; /* XOR window: Leading zeros, 32 if none. */
+    uint8_t trail[EPID_GORILLA_FIELDS]; /* XOR window: Trailing zeros. */
+} epid_gorilla_state_t;
+
+typedef struct {
+    uint8_t *buf; /* Block buffer. */
+    size_t size; /* Block buffer bytes. */
+    size_t pos; /* Bytes written. */
+    uint64_t acc; /* Pending bits, in the low `n_acc` bits. */
+    uint32_t n_acc;
+    uint32_t count; /* Records in the block. */
+    epid_gorilla_state_t state;
+} epid_gorilla_enc_t;
+
+typedef struct {
+    const uint8_t *buf; /* Block. */
+    size_t size; /* Block bytes. */
+    size_t pos; /* Bytes read. */
+    uint64_t acc; /* Read bits, in the low `n_acc` bits. */
+    uint32_t n_acc;
+    uint32_t count; /* Records left in the block. */
+    uint32_t index; /* Records read. */
+    int error; /* Truncated block. */
+    epid_gorilla_state_t state;
+} epid_gorilla_dec_t;
+
+
+/**
+ * Start a block of a channel in a buffer.
+ *
+ * enc: Pointer to the `epid_gorilla_enc_t` context.
+ * buf: Block buffer.
+ * size: Block buffer bytes, `size >= EPID_GORILLA_HEADER + EPID_GORILLA_REC_MAX`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_gorilla_enc_init(epid_gorilla_enc_t *enc, uint8_t *buf, size_t size);
+
+
+/**
+ * Encode a record in the block.
+ *
+ * enc: Pointer to the `epid_gorilla_enc_t` context.
+ * rec: Pointer to the record.
+ *
+ * Return: Non-zero if encoded, zero if the block is full: Finish it with
+ *         `epid_gorilla_enc_finish()`, then start a new one.
+ */
+int epid_gorilla_enc_push(epid_gorilla_enc_t *enc, const epid_telem_rec_t *rec);
+
+
+/**
+ * Finish the block: Write the pending bits and the records count.
+ *
+ * enc: Pointer to the `epid_gorilla_enc_t` context.
+ *
+ * Return: The block bytes, from the start of the buffer.
+ */
+size_t epid_gorilla_enc_finish(epid_gorilla_enc_t *enc);
+
+
+/**
+ * Start decoding a block.
+ *
+ * dec: Pointer to the `epid_gorilla_dec_t` context.
+ * buf: Block, as written by `epid_gorilla_enc_finish()`, only read.
+ * size: Block bytes.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred (no block header).
+ */
+epid_info_t epid_gorilla_dec_init(epid_gorilla_dec_t *dec, const uint8_t *buf, size_t size);
+
+
+/**
+ * Decode the next record of the block.
+ *
+ * dec: Pointer to the `epid_gorilla_dec_t` context.
+ * rec: Pointer to the destination record.
+ *
+ * Return: Non-zero if decoded, zero at the end of the block, or if the block
+ *         is truncated (`dec->error` is set).
+ */
+int epid_gorilla_dec_pop(epid_gorilla_dec_t *dec, epid_telem_rec_t *rec);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_GORILLA_H */
@@ -0,0 +1,285 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_gs.h"
+#include "pid_flt.h"
+
+
+/* Check the gains table, same checks as `epid_gains_init()`. */
+static epid_info_t epid_gs_check_gains(const epid_gains_t *gains, size_t n)
+{
+    for (size_t i = 0U; i < n; i++) {
+        epid_gains_t g;
+        const epid_info_t err = epid_gains_init(&g, gains[i].kp, gains[i].ki, gains[i].kd);
+
+        if (err != EPID_ERR_NONE) {
+            return err;
+        }
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Position of `point` in a uniform grid: Segment `i` and `t` in [0, 1],
+ * without data dependent branches. A NAN `point` gives the first breakpoint.
+ * last: `n - 1`, and `top` the same as `float`.
+ */
+static inline size_t epid_gs_pos_uniform(float first, float inv_step,
+                                         uint32_t last, float top,
+                                         float point, float *t)
+{
+    float f = (point - first) * inv_step;
+    uint32_t i;
+
+    f = (f > EPID_FP_ZERO) ? f : EPID_FP_ZERO; /* Also NAN. */
+    f = (f < top) ? f : top;
+    i = (uint32_t)f; /* `n <= UINT32_MAX`. */
+    i = (i < last) ? i : (last - 1U); /* `t` is one at the last breakpoint. */
+    *t = f - (float)i;
+
+    return i;
+}
+
+
+/* Position of `point` in sorted breakpoints, as `epid_gs_pos_uniform()`,
+ * by a fixed number of binary search steps for a given `last`.
+ */
+static inline size_t epid_gs_pos_sorted(const float *x, size_t last,
+                                        float point, float *t)
+{
+    size_t i = 0U;
+    size_t len = last; /* Segments `[i, i + len)` holding `p`. */
+    float p = (point > x[0]) ? point : x[0]; /* Also NAN. */
+
+    p = (p < x[last]) ? p : x[last];
+    while (len > 1U) {
+        const size_t half = len / 2U;
+        i = (x[i + half] <= p) ? (i + half) : i;
+        len -= half;
+    }
+    *t = (p - x[i]) / (x[i + 1U] - x[i]);
+
+    return i;
+}
+
+
+/* Convex form: Within {g[i], g[i + 1]}, exact at both ends. */
+static inline void epid_gs_mix(const epid_gains_t *g, size_t i, float t,
+                               float *kp, float *ki, float *kd)
+{
+    const float s = EPID_FP_ONE - t;
+
+    *kp = (s * g[i].kp) + (t * g[i + 1U].kp);
+    *ki = (s * g[i].ki) + (t * g[i + 1U].ki);
+    *kd = (s * g[i].kd) + (t * g[i + 1U].kd);
+}
+
+
+epid_info_t epid_gs_init(epid_gs_t *gs, const float *breakpoints,
+                         const epid_gains_t *gains, size_t n)
+{
+    epid_info_t err;
+
+    if ((gs == NULL)
+     || (breakpoints == NULL)
+     || (gains == NULL)
+     || (n == 0U)
+     || (n > (size_t)UINT32_MAX)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    for (size_t i = 0U; i < n; i++) {
+#ifdef EPID_FEATURE_VALID_FLT
+        if (epid_flt_finite(breakpoints[i]) == 0) {
+            return EPID_ERR_FLT;
+        }
+#endif
+        if ((i > 0U) && !(breakpoints[i] > breakpoints[i - 1U])) {
+            return EPID_ERR_INIT;
+        }
+    }
+
+    err = epid_gs_check_gains(gains, n);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    gs->breakpoints = breakpoints;
+    gs->gains = gains;
+    gs->n = n;
+    gs->first = breakpoints[0];
+    gs->inv_step = EPID_FP_ZERO;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_gs_init_uniform(epid_gs_t *gs, float first, float step,
+                                 const epid_gains_t *gains, size_t n)
+{
+    epid_info_t err;
+    const float last = first + (step * (float)(n - 1U));
+    const float inv_step = EPID_FP_ONE / step;
+
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((epid_flt_finite(first) == 0)
+     || (epid_flt_finite(step) == 0)
+     || (epid_flt_finite(last) == 0)
+     || (epid_flt_finite(inv_step) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((gs == NULL)
+     || (gains == NULL)
+     || (n == 0U)
+     || (n > (size_t)UINT32_MAX)
+     || (step <= EPID_FP_ZERO)
+     || ((n > 1U) && !(last > first))
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    err = epid_gs_check_gains(gains, n);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    gs->breakpoints = NULL;
+    gs->gains = gains;
+    gs->n = n;
+    gs->first = first;
+    gs->inv_step = inv_step;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_gs_lookup(const epid_gs_t *gs, float point, epid_gains_t *gains)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if (epid_flt_is_nan(point) != 0U) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if (gs->n == 1U) {
+        *gains = gs->gains[0];
+    }
+    else {
+        const size_t last = gs->n - 1U;
+        float t;
+        const size_t i = (gs->breakpoints == NULL)
+            ? epid_gs_pos_uniform(gs->first, gs->inv_step, (uint32_t)last, (float)last, point, &t)
+            : epid_gs_pos_sorted(gs->breakpoints, last, point, &t);
+
+        epid_gs_mix(gs->gains, i, t, &gains->kp, &gains->ki, &gains->kd);
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_gs_update(const epid_gs_t *gs, epid_t *ctx, float point)
+{
+    epid_gains_t gains;
+    const epid_info_t err = epid_gs_lookup(gs, point, &gains);
+
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    return epid_set_gains(ctx, gains.kp, gains.ki, gains.kd);
+}
+
+
+/* Non-zero if a controller keeps its gains: NAN operating point. */
+static inline int epid_gs_keep(float point)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    return (int)epid_flt_is_nan(point);
+#else
+    (void)point;
+    return 0;
+#endif
+}
+
+
+/* Store gains, or keep the current ones; By selects, not branches. */
+static inline void epid_gs_store(float kp, float ki, float kd, int keep,
+                                 float *kp_out, float *ki_out, float *kd_out)
+{
+    *kp_out = keep ? *kp_out : kp;
+    *ki_out = keep ? *ki_out : ki;
+    *kd_out = keep ? *kd_out : kd;
+}
+
+
+void epid_gs_bank_update(const epid_gs_t *gs, epid_bank_t *bank,
+                         const float *points, size_t n)
+{
+    /* Locals, not reloaded after the gains stores. */
+    const epid_gains_t *g = gs->gains;
+    const float *x = gs->breakpoints;
+    const size_t last = gs->n - 1U;
+    const float first = gs->first;
+    const float inv_step = gs->inv_step;
+    const float top = (float)last;
+    float *kp = bank->kp;
+    float *ki = bank->ki;
+    float *kd = bank->kd;
+
+    /* Table gains are valid, so are the interpolated ones: No per controller
+     * checks. One loop per table kind, with no branch on the table.
+     */
+    if (last == 0U) {
+        for (size_t i = 0U; i < n; i++) {
+            epid_gs_store(g[0].kp, g[0].ki, g[0].kd, epid_gs_keep(points[i]),
+                          &kp[i], &ki[i], &kd[i]);
+        }
+    }
+    else if (x == NULL) {
+        for (size_t i = 0U; i < n; i++) {
+            float t, a, b, c;
+            const size_t j = epid_gs_pos_uniform(first, inv_step, (uint32_t)last, top,
+                                                 points[i], &t);
+            epid_gs_mix(g, j, t, &a, &b, &c);
+            epid_gs_store(a, b, c, epid_gs_keep(points[i]), &kp[i], &ki[i], &kd[i]);
+        }
+    }
+    else {
+        for (size_t i = 0U; i < n; i++) {
+            float t, a, b, c;
+            const size_t j = epid_gs_pos_sorted(x, last, points[i], &t);
+            epid_gs_mix(g, j, t, &a, &b, &c);
+            epid_gs_store(a, b, c, epid_gs_keep(points[i]), &kp[i], &ki[i], &kd[i]);
+        }
+    }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
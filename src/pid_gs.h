@@ -0,0 +1,138 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID gain scheduling: {`Kp`, `Ki`, `Kd`} as a function of an operating
+ * point (temperature, flow, ...), by linear interpolation in a table of
+ * `epid_gains_t` profiles given at breakpoints.
+ *
+ * - Sorted breakpoints: Segment found by binary search, O(log n).
+ * - Uniform grid {`first + i * step`}: Segment found by one multiply, O(1).
+ *
+ * Operating points out of the table range use the first or the last gains
+ * (no extrapolation). Gains are interpolated as `(1 - t) * g[i] + t * g[i + 1]`,
+ * so they stay within the table gains and are valid when the table is.
+ * Gains are applied without resetting states, see `epid_set_gains()`.
+ * Tables are not copied and must outlive the schedule.
+ * Portable C99, no allocation, usable on embedded targets.
+ */
+
+
+#ifndef EPID_GS_H
+#define EPID_GS_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_bank.h"
+
+
+typedef struct {
+    const float *breakpoints; /* Strictly increasing, `n` values; `NULL` for a uniform grid. */
+    const epid_gains_t *gains; /* Gains at every breakpoint, `n` values. */
+    size_t n; /* Number of breakpoints. */
+
+    float first; /* First breakpoint. */
+    float inv_step; /* Uniform grid: `1 / step`. */
+} epid_gs_t;
+
+
+/**
+ * Initialize a gain schedule over sorted breakpoints.
+ *
+ * gs: Pointer to the `epid_gs_t` context.
+ * breakpoints: Operating points of the table rows, strictly increasing, `n` values.
+ * gains: Gains at every breakpoint, `n` values, see `epid_gains_init()`.
+ * n: Number of breakpoints, `1 <= n <= UINT32_MAX`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if breakpoints are not strictly increasing, or on
+ *     invalid gains (same checks as `epid_gains_init()`).
+ *   - `EPID_ERR_FLT` if a breakpoint or a gain is NAN, or INF.
+ */
+epid_info_t epid_gs_init(epid_gs_t *gs, const float *breakpoints,
+                         const epid_gains_t *gains, size_t n);
+
+
+/**
+ * Initialize a gain schedule over a uniform grid of breakpoints
+ * {`first`, `first + step`, ..., `first + (n - 1) * step`}, with O(1) lookups.
+ *
+ * gs: Pointer to the `epid_gs_t` context.
+ * first: Operating point of the first table row.
+ * step: Operating points distance between table rows, positive.
+ * gains: Gains at every breakpoint, `n` values, see `epid_gains_init()`.
+ * n: Number of breakpoints, `1 <= n <= UINT32_MAX`.
+ *
+ * Return: See `epid_gs_init()`.
+ */
+epid_info_t epid_gs_init_uniform(epid_gs_t *gs, float first, float step,
+                                 const epid_gains_t *gains, size_t n);
+
+
+/**
+ * Get the interpolated gains at an operating point.
+ *
+ * gs: Pointer to the `epid_gs_t` context.
+ * point: The operating point.
+ * gains: Pointer to the destination gains.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_FLT` if `point` is NAN, `gains` are not modified.
+ */
+epid_info_t epid_gs_lookup(const epid_gs_t *gs, float point, epid_gains_t *gains);
+
+
+/**
+ * Set the gains of a `epid_t` context for an operating point, once per tick
+ * before `epid_p*_calc()`; By `epid_gs_lookup()` then `epid_set_gains()`,
+ * so states are kept (bumpless).
+ *
+ * gs: Pointer to the `epid_gs_t` context.
+ * ctx: Pointer to the `epid_t` context.
+ * point: The operating point.
+ *
+ * Return: See `epid_gs_lookup()` and `epid_set_gains()`;
+ *         on errors the gains are not modified.
+ */
+epid_info_t epid_gs_update(const epid_gs_t *gs, epid_t *ctx, float point);
+
+
+/**
+ * Set the gains of the first `n` controllers of a bank for their operating
+ * points, once per tick before `epid_bank_p*_step()`; Same gains as
+ * `epid_gs_lookup()` for each one, in one pass over the bank gains arrays.
+ * States are kept. A controller with a NAN operating point keeps its gains.
+ *
+ * gs: Pointer to the `epid_gs_t` context.
+ * bank: Pointer to the `epid_bank_t` context.
+ * points: Operating points, `n` values.
+ * n: Number of controllers to schedule, `n <= bank->n`.
+ */
+void epid_gs_bank_update(const epid_gs_t *gs, epid_bank_t *bank,
+                         const float *points, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_GS_H */
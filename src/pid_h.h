@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID half precision storage build: `epid_h_t`, `epid_h_lpf_t` and
+ * `epid_h_*()`, generated from "pid_tmpl.h" with the same equations and API
+ * as the `float` functions of <pid.h> (e.g. `epid_h_pid_calc()` for
+ * `epid_pid_calc()`). Gains, states and terms are `_Float16` (18 of the 28
+ * bytes of an `epid_h_t`, with `flags` and the `float` cached sample period),
+ * arguments and arithmetic are `float`, for huge controller sets limited by
+ * memory bandwidth. Available if the compiler supports `_Float16`
+ * (`EPID_H_AVAILABLE` is defined).
+ *
+ * Note: Gains, states and terms are rounded to 11 significant bits when stored.
+ */
+
+
+#ifndef EPID_H_H
+#define EPID_H_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+#if defined(__FLT16_MAX__) && !defined(__cplusplus)
+# define EPID_H_AVAILABLE 1
+
+/* `_Float16` is an ISO/IEC TS 18661-3 extension. */
+__extension__ typedef _Float16 epid_float16_t;
+
+# define EPID_TMPL_NAME(name) epid_h_##name
+# define EPID_TMPL_STORE epid_float16_t
+# define EPID_TMPL_REAL float
+# define EPID_TMPL_DECLARE 1
+# include "pid_tmpl.h"
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_H_H */
@@ -0,0 +1,381 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <math.h> /* For `expm1f()`. */
+
+#include "pid_plant.h"
+#include "pid_flt.h"
+
+/* `restrict` is C99 only. */
+#if defined(__cplusplus)
+# define EPID_RESTRICT
+#else
+# define EPID_RESTRICT restrict
+#endif
+
+/* No FP contraction in this file, as "pid_sim.c": Its fused kernels and the
+ * `epid_plant_*_step()` functions must round the same.
+ */
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT OFF
+# pragma clang fp contract(off)
+#elif defined(__GNUC__)
+# pragma GCC optimize("fp-contract=off")
+#else
+# pragma STDC FP_CONTRACT OFF
+#endif
+
+
+/* Zero a memory block of `len` floats. */
+static void epid_plant_zero(float *mem, size_t len)
+{
+    for (size_t i = 0U; i < len; i++) {
+        mem[i] = EPID_FP_ZERO;
+    }
+}
+
+
+/* First-order plus dead-time */
+
+epid_info_t epid_plant_fopdt_init(epid_plant_fopdt_t *plant, float *mem,
+                                  size_t n, uint32_t delay)
+{
+    if ((plant == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(n);
+
+    epid_plant_zero(mem, EPID_PLANT_FOPDT_MEM_LEN(n, (size_t)delay));
+
+    plant->a          = mem;
+    plant->gain       = mem + stride;
+    plant->y          = mem + (2U * stride);
+    plant->delay_line = mem + (3U * stride);
+    plant->delay = delay;
+    plant->head = 0U;
+    plant->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_plant_fopdt_set(epid_plant_fopdt_t *plant, size_t i,
+                                 float gain, float tau, float sample_period,
+                                 float y_0, float u_0)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((epid_flt_finite(gain) == 0)
+     || (epid_flt_finite(tau) == 0)
+     || (epid_flt_finite(sample_period) == 0)
+     || (epid_flt_finite(y_0) == 0)
+     || (epid_flt_finite(u_0) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((plant == NULL)
+     || (i >= plant->n)
+     || (tau <= EPID_FP_ZERO)
+     || (sample_period <= EPID_FP_ZERO)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(plant->n);
+
+    /* Step response of the continuous model over one sample period. */
+    plant->a[i] = -expm1f(-sample_period / tau);
+    plant->gain[i] = gain;
+    plant->y[i] = y_0;
+
+    for (uint32_t k = 0U; k < plant->delay; k++) {
+        plant->delay_line[(k * stride) + i] = u_0;
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_plant_fopdt_step(epid_plant_fopdt_t *plant, const float *u)
+{
+    const float *EPID_RESTRICT a = plant->a;
+    const float *EPID_RESTRICT gain = plant->gain;
+    float *EPID_RESTRICT y = plant->y;
+    const size_t n = plant->n;
+
+    if (plant->delay == 0U) {
+        for (size_t i = 0U; i < n; i++) {
+            y[i] = y[i] + a[i] * ((gain[i] * u[i]) - y[i]);
+        }
+        return;
+    }
+
+    /* The oldest row `u[k-delay]` is used, then overwritten by `u[k]`. */
+    float *EPID_RESTRICT slot = plant->delay_line + ((size_t)plant->head * EPID_BANK_STRIDE(n));
+
+    for (size_t i = 0U; i < n; i++) {
+        const float u_delayed = slot[i];
+
+        slot[i] = u[i];
+        y[i] = y[i] + a[i] * ((gain[i] * u_delayed) - y[i]);
+    }
+
+    plant->head = ((plant->head + 1U) == plant->delay) ? 0U : (plant->head + 1U);
+}
+
+
+/* Second-order */
+
+epid_info_t epid_plant_so_init(epid_plant_so_t *plant, float *mem, size_t n)
+{
+    if ((plant == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(n);
+
+    epid_plant_zero(mem, EPID_PLANT_SO_MEM_LEN(n));
+
+    plant->gain = mem;
+    plant->c1   = mem + stride;
+    plant->c2   = mem + (2U * stride);
+    plant->y    = mem + (3U * stride);
+    plant->w    = mem + (4U * stride);
+    plant->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_plant_so_set(epid_plant_so_t *plant, size_t i,
+                              float gain, float wn, float zeta,
+                              float sample_period, float y_0)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((epid_flt_finite(gain) == 0)
+     || (epid_flt_finite(wn) == 0)
+     || (epid_flt_finite(zeta) == 0)
+     || (epid_flt_finite(sample_period) == 0)
+     || (epid_flt_finite(y_0) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((plant == NULL)
+     || (i >= plant->n)
+     || (wn <= EPID_FP_ZERO)
+     || (zeta < EPID_FP_ZERO)
+     || (sample_period <= EPID_FP_ZERO)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const float wn_ts = wn * sample_period;
+    const float c1 = wn_ts * wn_ts;
+    const float c2 = 2.0f * zeta * wn_ts;
+
+    /* Jury test of the discrete model: Stable for `c2 < 2` and `c1 + 2*c2 < 4`. */
+    if ((c2 >= 2.0f) || ((c1 + (2.0f * c2)) >= 4.0f)) {
+        return EPID_ERR_INIT;
+    }
+
+    plant->gain[i] = gain;
+    plant->c1[i] = c1;
+    plant->c2[i] = c2;
+    plant->y[i] = y_0;
+    plant->w[i] = EPID_FP_ZERO;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_plant_so_step(epid_plant_so_t *plant, const float *u)
+{
+    const float *EPID_RESTRICT gain = plant->gain;
+    const float *EPID_RESTRICT c1 = plant->c1;
+    const float *EPID_RESTRICT c2 = plant->c2;
+    float *EPID_RESTRICT y = plant->y;
+    float *EPID_RESTRICT w = plant->w;
+    const size_t n = plant->n;
+
+    for (size_t i = 0U; i < n; i++) {
+        const float w_next = w[i] + (c1[i] * ((gain[i] * u[i]) - y[i])) - (c2[i] * w[i]);
+
+        w[i] = w_next;
+        y[i] = y[i] + w_next;
+    }
+}
+
+
+/* Integrating */
+
+epid_info_t epid_plant_int_init(epid_plant_int_t *plant, float *mem, size_t n)
+{
+    if ((plant == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    epid_plant_zero(mem, EPID_PLANT_INT_MEM_LEN(n));
+
+    plant->k_ts = mem;
+    plant->y    = mem + EPID_BANK_STRIDE(n);
+    plant->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_plant_int_set(epid_plant_int_t *plant, size_t i,
+                               float gain, float sample_period, float y_0)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((epid_flt_finite(gain) == 0)
+     || (epid_flt_finite(sample_period) == 0)
+     || (epid_flt_finite(y_0) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((plant == NULL)
+     || (i >= plant->n)
+     || (sample_period <= EPID_FP_ZERO)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    plant->k_ts[i] = gain * sample_period;
+    plant->y[i] = y_0;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_plant_int_step(epid_plant_int_t *plant, const float *u)
+{
+    const float *EPID_RESTRICT k_ts = plant->k_ts;
+    float *EPID_RESTRICT y = plant->y;
+    const size_t n = plant->n;
+
+    for (size_t i = 0U; i < n; i++) {
+        y[i] = y[i] + (k_ts[i] * u[i]);
+    }
+}
+
+
+/* Thermal */
+
+epid_info_t epid_plant_thermal_init(epid_plant_thermal_t *plant, float *mem, size_t n)
+{
+    if ((plant == NULL)
+     || (mem == NULL)
+     || (n == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t stride = EPID_BANK_STRIDE(n);
+
+    epid_plant_zero(mem, EPID_PLANT_THERMAL_MEM_LEN(n));
+
+    plant->k_in    = mem;
+    plant->k_loss  = mem + stride;
+    plant->ambient = mem + (2U * stride);
+    plant->y       = mem + (3U * stride);
+    plant->n = n;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_plant_thermal_set(epid_plant_thermal_t *plant, size_t i,
+                                   float capacity, float loss, float ambient,
+                                   float sample_period, float y_0)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((epid_flt_finite(capacity) == 0)
+     || (epid_flt_finite(loss) == 0)
+     || (epid_flt_finite(ambient) == 0)
+     || (epid_flt_finite(sample_period) == 0)
+     || (epid_flt_finite(y_0) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((plant == NULL)
+     || (i >= plant->n)
+     || (capacity <= EPID_FP_ZERO)
+     || (loss < EPID_FP_ZERO)
+     || (sample_period <= EPID_FP_ZERO)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    const float k_loss = (sample_period * loss) / capacity;
+
+    /* Forward Euler: Monotonic cooling for `k_loss < 1`. */
+    if (k_loss >= 1.0f) {
+        return EPID_ERR_INIT;
+    }
+
+    plant->k_in[i] = sample_period / capacity;
+    plant->k_loss[i] = k_loss;
+    plant->ambient[i] = ambient;
+    plant->y[i] = y_0;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_plant_thermal_step(epid_plant_thermal_t *plant, const float *u)
+{
+    const float *EPID_RESTRICT k_in = plant->k_in;
+    const float *EPID_RESTRICT k_loss = plant->k_loss;
+    const float *EPID_RESTRICT ambient = plant->ambient;
+    float *EPID_RESTRICT y = plant->y;
+    const size_t n = plant->n;
+
+    for (size_t i = 0U; i < n; i++) {
+        /* Heating only: A negative (or NaN) input adds no energy. */
+        const float power = (u[i] > EPID_FP_ZERO) ? u[i] : EPID_FP_ZERO;
+
+        y[i] = y[i] + (k_in[i] * power) - (k_loss[i] * (y[i] - ambient[i]));
+    }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
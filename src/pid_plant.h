@@ -0,0 +1,310 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID plant models: Discrete-time process models to simulate closed loops,
+ * many plants of a model stored as structure-of-arrays (SoA) and stepped
+ * in one pass, with the same layout rules as `epid_bank_t`.
+ *
+ * - `epid_plant_fopdt_t`: First-order plus dead-time, `K * e^(-L*s) / (tau*s + 1)`.
+ * - `epid_plant_so_t`: Second-order, `K * wn^2 / (s^2 + 2*zeta*wn*s + wn^2)`.
+ * - `epid_plant_int_t`: Integrating, `K / s`.
+ * - `epid_plant_thermal_t`: Lumped thermal mass with a heater and losses to
+ *   the ambient, as the heating system of `extras/testing/main.c`.
+ *
+ * Every step takes the inputs `u[k]` (CV) and updates the outputs to `y[k+1]`,
+ * so a closed loop of plants and a controller bank is:
+ *
+ *     epid_bank_pid_step(&bank, setpoints, plant.y, out_min, out_max, n);
+ *     epid_plant_fopdt_step(&plant, bank.y_out);
+ *
+ * Sample periods are given per plant, and must be the controllers ones.
+ */
+
+
+#ifndef EPID_PLANT_H
+#define EPID_PLANT_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_bank.h"
+
+/* Number of floats in the memory block needed by `n` plants of a model,
+ * and a dead time of `delay` samples for `epid_plant_fopdt_t`.
+ */
+#define EPID_PLANT_FOPDT_MEM_LEN(n, delay) ((3U + (delay)) * EPID_BANK_STRIDE(n))
+#define EPID_PLANT_SO_MEM_LEN(n) (5U * EPID_BANK_STRIDE(n))
+#define EPID_PLANT_INT_MEM_LEN(n) (2U * EPID_BANK_STRIDE(n))
+#define EPID_PLANT_THERMAL_MEM_LEN(n) (4U * EPID_BANK_STRIDE(n))
+
+
+typedef struct {
+    /* `y[k+1] = y[k] + a * (K * u[k-delay] - y[k])`, exact for inputs held
+     * over the sample period.
+     * `a[stride] gain[stride] y[stride] delay_line[delay * stride]`
+     */
+    float *a; /* `1 - e^(-Ts/tau)` */
+    float *gain; /* `K` */
+    float *y; /* Outputs (PV). */
+
+    /* Dead time: A ring of the `delay` last inputs rows, `head` is the oldest. */
+    float *delay_line;
+    uint32_t delay; /* Dead time `L / Ts` in samples, shared by the plants. */
+    uint32_t head;
+
+    size_t n; /* Number of plants. */
+} epid_plant_fopdt_t;
+
+typedef struct {
+    /* Semi-implicit Euler, `w` is `Ts * dy/dt`:
+     * `w[k+1] = w[k] + c1 * (K * u[k] - y[k]) - c2 * w[k]`, `y[k+1] = y[k] + w[k+1]`
+     * `gain[stride] c1[stride] c2[stride] y[stride] w[stride]`
+     */
+    float *gain; /* `K` */
+    float *c1; /* `(wn * Ts)^2` */
+    float *c2; /* `2 * zeta * wn * Ts` */
+    float *y; /* Outputs (PV). */
+    float *w;
+
+    size_t n; /* Number of plants. */
+} epid_plant_so_t;
+
+typedef struct {
+    /* `y[k+1] = y[k] + K * Ts * u[k]`
+     * `k_ts[stride] y[stride]`
+     */
+    float *k_ts; /* `K * Ts` */
+    float *y; /* Outputs (PV). */
+
+    size_t n; /* Number of plants. */
+} epid_plant_int_t;
+
+typedef struct {
+    /* Heat balance (forward Euler), heating only (`u < 0` is zero):
+     * `y[k+1] = y[k] + k_in * u[k] - k_loss * (y[k] - ambient)`
+     * `k_in[stride] k_loss[stride] ambient[stride] y[stride]`
+     */
+    float *k_in; /* `Ts / C` */
+    float *k_loss; /* `Ts * h / C` */
+    float *ambient; /* Ambient temperature. */
+    float *y; /* Outputs (PV), temperatures. */
+
+    size_t n; /* Number of plants. */
+} epid_plant_thermal_t;
+
+
+/**
+ * Initialize `n` first-order plus dead-time plants over a memory block.
+ * All parameters and states are set to zero, so every plant must be set
+ * by `epid_plant_fopdt_set()` before processing.
+ *
+ * plant: Pointer to the `epid_plant_fopdt_t` context.
+ * mem: Memory block of at least `EPID_PLANT_FOPDT_MEM_LEN(n, delay)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of plants.
+ * delay: Dead time in samples (zero for none), the same for all plants;
+ *        Plants of different dead times are in different contexts.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_plant_fopdt_init(epid_plant_fopdt_t *plant, float *mem,
+                                  size_t n, uint32_t delay);
+
+
+/**
+ * Set the first-order plus dead-time plant `i` and its states.
+ *
+ * plant: Pointer to the `epid_plant_fopdt_t` context.
+ * i: Index of the plant, `i < plant->n`.
+ * gain: Process gain `K`.
+ * tau: Time constant, `tau > 0`.
+ * sample_period: Sample period `Ts`, `Ts > 0`.
+ * y_0: Initial output `y[0]`.
+ * u_0: Inputs during the dead time before the first step.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ *   - `EPID_ERR_FLT` if an argument is NAN, or INF.
+ */
+epid_info_t epid_plant_fopdt_set(epid_plant_fopdt_t *plant, size_t i,
+                                 float gain, float tau, float sample_period,
+                                 float y_0, float u_0);
+
+
+/**
+ * Step all first-order plus dead-time plants by one sample.
+ *
+ * plant: Pointer to the `epid_plant_fopdt_t` context.
+ * u: Inputs `u[k]` (CV), `plant->n` values.
+ */
+void epid_plant_fopdt_step(epid_plant_fopdt_t *plant, const float *u);
+
+
+/**
+ * Initialize `n` second-order plants over a memory block.
+ * All parameters and states are set to zero, so every plant must be set
+ * by `epid_plant_so_set()` before processing.
+ *
+ * plant: Pointer to the `epid_plant_so_t` context.
+ * mem: Memory block of at least `EPID_PLANT_SO_MEM_LEN(n)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of plants.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_plant_so_init(epid_plant_so_t *plant, float *mem, size_t n);
+
+
+/**
+ * Set the second-order plant `i` at rest (`dy/dt = 0`).
+ * The discrete model is stable for `(c1 + 2 * c2) < 4` (see `epid_plant_so_t`),
+ * and close to the continuous one for `wn * Ts` well under 1.
+ *
+ * plant: Pointer to the `epid_plant_so_t` context.
+ * i: Index of the plant, `i < plant->n`.
+ * gain: Process gain `K`.
+ * wn: Natural frequency in rad/s, `wn > 0`.
+ * zeta: Damping ratio, `zeta >= 0`.
+ * sample_period: Sample period `Ts`, `Ts > 0`.
+ * y_0: Initial output `y[0]`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred, or on an unstable
+ *     discrete model.
+ *   - `EPID_ERR_FLT` if an argument is NAN, or INF.
+ */
+epid_info_t epid_plant_so_set(epid_plant_so_t *plant, size_t i,
+                              float gain, float wn, float zeta,
+                              float sample_period, float y_0);
+
+
+/**
+ * Step all second-order plants by one sample.
+ *
+ * plant: Pointer to the `epid_plant_so_t` context.
+ * u: Inputs `u[k]` (CV), `plant->n` values.
+ */
+void epid_plant_so_step(epid_plant_so_t *plant, const float *u);
+
+
+/**
+ * Initialize `n` integrating plants over a memory block.
+ * All parameters and states are set to zero, so every plant must be set
+ * by `epid_plant_int_set()` before processing.
+ *
+ * plant: Pointer to the `epid_plant_int_t` context.
+ * mem: Memory block of at least `EPID_PLANT_INT_MEM_LEN(n)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of plants.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_plant_int_init(epid_plant_int_t *plant, float *mem, size_t n);
+
+
+/**
+ * Set the integrating plant `i` and its state.
+ *
+ * plant: Pointer to the `epid_plant_int_t` context.
+ * i: Index of the plant, `i < plant->n`.
+ * gain: Process gain `K`, output rate per unit input.
+ * sample_period: Sample period `Ts`, `Ts > 0`.
+ * y_0: Initial output `y[0]`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ *   - `EPID_ERR_FLT` if an argument is NAN, or INF.
+ */
+epid_info_t epid_plant_int_set(epid_plant_int_t *plant, size_t i,
+                               float gain, float sample_period, float y_0);
+
+
+/**
+ * Step all integrating plants by one sample.
+ *
+ * plant: Pointer to the `epid_plant_int_t` context.
+ * u: Inputs `u[k]` (CV), `plant->n` values.
+ */
+void epid_plant_int_step(epid_plant_int_t *plant, const float *u);
+
+
+/**
+ * Initialize `n` thermal plants over a memory block.
+ * All parameters and states are set to zero, so every plant must be set
+ * by `epid_plant_thermal_set()` before processing.
+ *
+ * plant: Pointer to the `epid_plant_thermal_t` context.
+ * mem: Memory block of at least `EPID_PLANT_THERMAL_MEM_LEN(n)` floats,
+ *      aligned to `EPID_BANK_ALIGN` bytes for best performance.
+ * n: Number of plants.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_plant_thermal_init(epid_plant_thermal_t *plant, float *mem, size_t n);
+
+
+/**
+ * Set the thermal plant `i` and its temperature.
+ * Inputs are the heater powers in W, temperatures in °C (or K).
+ *
+ * plant: Pointer to the `epid_plant_thermal_t` context.
+ * i: Index of the plant, `i < plant->n`.
+ * capacity: Heat capacity `C` in J/°C (specific heat * mass), `C > 0`.
+ * loss: Heat loss coefficient `h` in W/°C (transfer coefficient * surface),
+ *       `0 <= (Ts * h / C) < 1`.
+ * ambient: Ambient temperature.
+ * sample_period: Sample period `Ts` in s, `Ts > 0`.
+ * y_0: Initial temperature `y[0]`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ *   - `EPID_ERR_FLT` if an argument is NAN, or INF.
+ */
+epid_info_t epid_plant_thermal_set(epid_plant_thermal_t *plant, size_t i,
+                                   float capacity, float loss, float ambient,
+                                   float sample_period, float y_0);
+
+
+/**
+ * Step all thermal plants by one sample.
+ *
+ * plant: Pointer to the `epid_plant_thermal_t` context.
+ * u: Inputs `u[k]` (CV), heater powers, `plant->n` values.
+ */
+void epid_plant_thermal_step(epid_plant_thermal_t *plant, const float *u);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_PLANT_H */
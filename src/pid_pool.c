@@ -0,0 +1,253 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_pool.h"
+#include "pid_flt.h"
+
+/* `restrict` is C99 only. */
+#if defined(__cplusplus)
+# define EPID_RESTRICT
+#else
+# define EPID_RESTRICT restrict
+#endif
+
+/* 4 records per 64-bytes cache line. */
+typedef char epid_hot_size_check[(sizeof(epid_hot_t) == 16U) ? 1 : -1];
+
+
+epid_info_t epid_pool_init(epid_pool_t *pool, epid_hot_t *hot, size_t n,
+                           const epid_gains_t *gains, size_t n_gains,
+                           epid_terms_t *terms)
+{
+    if ((pool == NULL)
+     || (hot == NULL)
+     || (n == 0U)
+     || (gains == NULL)
+     || (n_gains == 0U)
+     || (n_gains > (size_t)UINT32_MAX)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    for (size_t i = 0U; i < n; i++) {
+        hot[i].xk_1 = EPID_FP_ZERO;
+        hot[i].xk_2 = EPID_FP_ZERO;
+        hot[i].y_out = EPID_FP_ZERO;
+        hot[i].gains = 0U;
+    }
+
+    pool->hot = hot;
+    pool->gains = gains;
+    pool->terms = terms;
+    pool->n = n;
+    pool->n_gains = n_gains;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_pool_set(epid_pool_t *pool, size_t i,
+                          float xk_1, float xk_2, float y_previous,
+                          uint32_t gains)
+{
+    epid_t ctx;
+    epid_info_t err;
+
+    if ((pool == NULL)
+     || (i >= pool->n)
+     || ((size_t)gains >= pool->n_gains)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Same checks as a single controller. */
+    err = epid_init(&ctx, xk_1, xk_2, y_previous,
+                    pool->gains[gains].kp, pool->gains[gains].ki, pool->gains[gains].kd);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    pool->hot[i].xk_1 = xk_1;
+    pool->hot[i].xk_2 = xk_2;
+    pool->hot[i].y_out = y_previous;
+    pool->hot[i].gains = gains;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_pool_store(const epid_pool_t *pool, size_t i, epid_t *ctx)
+{
+    const epid_hot_t *hot = &pool->hot[i];
+    const epid_gains_t *gains = &pool->gains[hot->gains];
+
+    ctx->kp = gains->kp;
+    ctx->ki = gains->ki;
+    ctx->kd = gains->kd;
+    ctx->xk_1 = hot->xk_1;
+    ctx->xk_2 = hot->xk_2;
+    ctx->y_out = hot->y_out;
+
+    if (pool->terms != NULL) {
+        ctx->p_term = pool->terms[i].p_term;
+        ctx->i_term = pool->terms[i].i_term;
+        ctx->d_term = pool->terms[i].d_term;
+    }
+}
+
+
+/* Single controller updates, inlined in the pool loops. */
+static inline void epid_hot_pi_update(epid_hot_t *ctx, const epid_gains_t *g,
+                                      float setpoint, float measure,
+                                      float out_min, float out_max,
+                                      epid_terms_t *terms)
+{
+    const float y_prev = ctx->y_out;
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     */
+    const float p_term = g->kp * (ctx->xk_1 - measure);
+    const float i_term = g->ki * (setpoint - measure);
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+    float y = y_prev + (p_term + i_term);
+
+    ctx->xk_1 = measure; /* `x[k-1] = x[k]` */
+
+#ifdef EPID_FEATURE_VALID_FLT
+    /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+    y = epid_flt_nan_keep(y, y_prev);
+#endif
+
+    /* Limit the new output `y[k]` (CV) to boundaries. */
+    if (y > out_max) {
+        y = out_max;
+    }
+    else if (y < out_min) {
+        y = out_min;
+    }
+
+    ctx->y_out = y;
+
+    /* Opt-in output, a well predicted branch. */
+    if (terms != NULL) {
+        terms->p_term = p_term;
+        terms->i_term = i_term;
+        terms->d_term = EPID_FP_ZERO;
+    }
+}
+
+static inline void epid_hot_pid_update(epid_hot_t *ctx, const epid_gains_t *g,
+                                       float setpoint, float measure,
+                                       float out_min, float out_max,
+                                       epid_terms_t *terms)
+{
+    const float y_prev = ctx->y_out;
+    const float xk_1 = ctx->xk_1;
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+     */
+    const float dx = xk_1 - measure;
+    const float d_term = g->kd * (xk_1 + dx - ctx->xk_2);
+    const float p_term = g->kp * dx;
+    const float i_term = g->ki * (setpoint - measure);
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+    float y = y_prev + (p_term + i_term + d_term);
+
+    ctx->xk_2 = xk_1;    /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = measure; /* `x[k-1] = x[k]` */
+
+#ifdef EPID_FEATURE_VALID_FLT
+    /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+    y = epid_flt_nan_keep(y, y_prev);
+#endif
+
+    /* Limit the new output `y[k]` (CV) to boundaries. */
+    if (y > out_max) {
+        y = out_max;
+    }
+    else if (y < out_min) {
+        y = out_min;
+    }
+
+    ctx->y_out = y;
+
+    /* Opt-in output, a well predicted branch. */
+    if (terms != NULL) {
+        terms->p_term = p_term;
+        terms->i_term = i_term;
+        terms->d_term = d_term;
+    }
+}
+
+
+void epid_hot_pi_step(epid_hot_t *ctx, const epid_gains_t *gains,
+                      float setpoint, float measure,
+                      float out_min, float out_max, epid_terms_t *terms)
+{
+    epid_hot_pi_update(ctx, &gains[ctx->gains], setpoint, measure,
+                       out_min, out_max, terms);
+}
+
+
+void epid_hot_pid_step(epid_hot_t *ctx, const epid_gains_t *gains,
+                       float setpoint, float measure,
+                       float out_min, float out_max, epid_terms_t *terms)
+{
+    epid_hot_pid_update(ctx, &gains[ctx->gains], setpoint, measure,
+                        out_min, out_max, terms);
+}
+
+
+void epid_pool_pi_step(epid_pool_t *pool,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n)
+{
+    epid_hot_t *EPID_RESTRICT hot = pool->hot;
+    const epid_gains_t *EPID_RESTRICT gains = pool->gains;
+    epid_terms_t *EPID_RESTRICT terms = pool->terms;
+
+    for (size_t i = 0U; i < n; i++) {
+        epid_hot_pi_update(&hot[i], &gains[hot[i].gains], setpoints[i], measures[i],
+                           out_min, out_max, (terms != NULL) ? &terms[i] : NULL);
+    }
+}
+
+
+void epid_pool_pid_step(epid_pool_t *pool,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n)
+{
+    epid_hot_t *EPID_RESTRICT hot = pool->hot;
+    const epid_gains_t *EPID_RESTRICT gains = pool->gains;
+    epid_terms_t *EPID_RESTRICT terms = pool->terms;
+
+    for (size_t i = 0U; i < n; i++) {
+        epid_hot_pid_update(&hot[i], &gains[hot[i].gains], setpoints[i], measures[i],
+                            out_min, out_max, (terms != NULL) ? &terms[i] : NULL);
+    }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
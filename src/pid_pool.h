@@ -0,0 +1,202 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID controller pool: Type-C PID controllers with a hot/cold split layout,
+ * for large numbers of loops where `epid_t` wastes memory bandwidth.
+ *
+ * - `epid_hot_t` records: The per-tick state {`x[k-1]`, `x[k-2]`, `y[k-1]`}
+ *   and an index in the gains table; 16 bytes, 4 controllers per 64-bytes
+ *   cache line when the array is aligned to `EPID_POOL_ALIGN` bytes.
+ * - `epid_gains_t` table (see <pid.h>): Read-only per tick, and shared by
+ *   every controller with the same tuning (one profile for identical loops).
+ * - `epid_terms_t` buffer: Opt-in terms output {`P[k]`, `I[k]`, `D[k]`},
+ *   only written when given, for observability.
+ *
+ * Every controller `i` of a pool follows the same equations as an `epid_t`
+ * processed by `epid_pid_calc()` then `epid_pid_sum()`, bit for bit, when
+ * both are compiled with the same floating-point settings.
+ */
+
+
+#ifndef EPID_POOL_H
+#define EPID_POOL_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+/* Alignment in bytes of `epid_hot_t` arrays, one cache line. */
+#define EPID_POOL_ALIGN (64U)
+
+/* Alignment attribute for statically allocated arrays, as in <pid_bank.h>. */
+#ifndef EPID_ALIGNED
+# if defined(__GNUC__) || defined(__clang__)
+#  define EPID_ALIGNED(x) __attribute__((aligned(x)))
+# elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#  define EPID_ALIGNED(x) _Alignas(x)
+# else
+#  define EPID_ALIGNED(x)
+# endif
+#endif
+
+
+typedef struct {
+    float xk_1; /* Physical measurement `PV[k-1]`. */
+    float xk_2; /* Physical measurement `PV[k-2]`. */
+    float y_out; /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+    uint32_t gains; /* Index of the controller gains in the gains table. */
+} epid_hot_t;
+
+typedef struct {
+    float p_term; /* The P-term calculated value `P[k]`. */
+    float i_term; /* The I-term calculated value `I[k]`. */
+    float d_term; /* The D-term calculated value `D[k]`, zero for PI. */
+} epid_terms_t;
+
+typedef struct {
+    epid_hot_t *hot; /* Controllers states, `n` records. */
+    const epid_gains_t *gains; /* Gains table, `n_gains` entries. */
+    epid_terms_t *terms; /* Terms output, `n` records, or `NULL` to skip. */
+
+    size_t n; /* Number of controllers in the pool. */
+    size_t n_gains; /* Number of entries in the gains table. */
+} epid_pool_t;
+
+
+/**
+ * Initialize a `epid_pool_t` context over user allocated arrays.
+ * All states are set to zero with the gains index zero, so every controller
+ * must be set by `epid_pool_set()` before processing.
+ *
+ * pool: Pointer to the `epid_pool_t` context.
+ * hot: Array of `n` records, aligned to `EPID_POOL_ALIGN` bytes for best performance.
+ * n: Number of controllers.
+ * gains: Gains table of `n_gains` initialized entries, see `epid_gains_init()`.
+ * n_gains: Number of entries in the gains table.
+ * terms: Array of `n` records for the terms output, or `NULL`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_pool_init(epid_pool_t *pool, epid_hot_t *hot, size_t n,
+                           const epid_gains_t *gains, size_t n_gains,
+                           epid_terms_t *terms);
+
+
+/**
+ * Initialize or reset the controller `i` of a pool, set its gains index,
+ * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}, with the same checks as `epid_init()`.
+ *
+ * pool: Pointer to the `epid_pool_t` context.
+ * i: Index of the controller, `i < pool->n`.
+ * xk_1: A process variable (PV) point `x[k-1]`.
+ * xk_2: A process variable (PV) point `x[k-2]` for D-term.
+ * y_previous: A control variable (CV) point `y[k-1]`.
+ * gains: Index of the gains in the table, `gains < pool->n_gains`.
+ *
+ * Return: See `epid_init()`.
+ */
+epid_info_t epid_pool_set(epid_pool_t *pool, size_t i,
+                          float xk_1, float xk_2, float y_previous,
+                          uint32_t gains);
+
+
+/**
+ * Copy gains, states and terms (if the pool has a terms output)
+ * of the controller `i` of a pool into an `epid_t` context.
+ *
+ * pool: Pointer to the `epid_pool_t` context.
+ * i: Index of the controller, `i < pool->n`.
+ * ctx: Pointer to the destination `epid_t` context.
+ */
+void epid_pool_store(const epid_pool_t *pool, size_t i, epid_t *ctx);
+
+
+/**
+ * Do processing as a Type-C PI controller for a single `epid_hot_t` record,
+ * with its gains profile from a table, same as `epid_pi_calc()` then
+ * `epid_pi_sum()`. For controllers kept out of pools (e.g. one per ISR).
+ *
+ * ctx: Pointer to the `epid_hot_t` record.
+ * gains: Gains table, indexed by `ctx->gains`.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ * terms: Pointer to the terms output, or `NULL`.
+ */
+void epid_hot_pi_step(epid_hot_t *ctx, const epid_gains_t *gains,
+                      float setpoint, float measure,
+                      float out_min, float out_max, epid_terms_t *terms);
+
+
+/**
+ * Do processing as a Type-C PID controller for a single `epid_hot_t` record,
+ * with its gains profile from a table, same as `epid_pid_calc()` then
+ * `epid_pid_sum()`.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ *
+ * Arguments: See `epid_hot_pi_step()`.
+ */
+void epid_hot_pid_step(epid_hot_t *ctx, const epid_gains_t *gains,
+                       float setpoint, float measure,
+                       float out_min, float out_max, epid_terms_t *terms);
+
+
+/**
+ * Do processing as Type-C PI controllers for the first `n` controllers of
+ * a pool, same as `epid_pi_calc()` then `epid_pi_sum()` for each one.
+ *
+ * pool: Pointer to the `epid_pool_t` context.
+ * setpoints: The desired setpoints (SP), `n` values.
+ * measures: Measured process variables (PV), `n` values.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ * n: Number of controllers to process, `n <= pool->n`.
+ */
+void epid_pool_pi_step(epid_pool_t *pool,
+                       const float *setpoints, const float *measures,
+                       float out_min, float out_max, size_t n);
+
+
+/**
+ * Do processing as Type-C PID controllers for the first `n` controllers of
+ * a pool, same as `epid_pid_calc()` then `epid_pid_sum()` for each one.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ *
+ * pool: Pointer to the `epid_pool_t` context.
+ * setpoints: The desired setpoints (SP), `n` values.
+ * measures: Measured process variables (PV), `n` values.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ * n: Number of controllers to process, `n <= pool->n`.
+ */
+void epid_pool_pid_step(epid_pool_t *pool,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_POOL_H */
@@ -0,0 +1,337 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_q.h"
+
+
+/* `term_sat` bits: A term saturated to the max, or to the min. */
+#define EPID_Q_SAT_MAX 1U
+#define EPID_Q_SAT_MIN 2U
+
+
+/* Saturate a wide value to the Q31 range, and set `overflow` if needed. */
+static int32_t epid_q31_sat(epid_q31_t *ctx, int64_t x)
+{
+    if (x > (int64_t)INT32_MAX) {
+        ctx->overflow = 1U;
+        return INT32_MAX;
+    }
+    else if (x < (int64_t)INT32_MIN) {
+        ctx->overflow = 1U;
+        return INT32_MIN;
+    }
+    return (int32_t)x;
+}
+
+
+/* Term `K * x` with `K` in `gain_frac_bits` fractional bits, saturated to Q31.
+ * The saturation is recorded in `term_sat`, for `epid_q31_p*_sum()`.
+ */
+static int32_t epid_q31_mul(epid_q31_t *ctx, int32_t k, int32_t x)
+{
+    const int64_t y = ((int64_t)k * (int64_t)x) >> ctx->gain_frac_bits;
+
+    if (y > (int64_t)INT32_MAX) {
+        ctx->term_sat |= EPID_Q_SAT_MAX;
+        return INT32_MAX;
+    }
+    else if (y < (int64_t)INT32_MIN) {
+        ctx->term_sat |= EPID_Q_SAT_MIN;
+        return INT32_MIN;
+    }
+    return (int32_t)y;
+}
+
+
+/* Saturate a wide value to the Q15 range, and set `overflow` if needed. */
+static int16_t epid_q15_sat(epid_q15_t *ctx, int32_t x)
+{
+    if (x > (int32_t)INT16_MAX) {
+        ctx->overflow = 1U;
+        return INT16_MAX;
+    }
+    else if (x < (int32_t)INT16_MIN) {
+        ctx->overflow = 1U;
+        return INT16_MIN;
+    }
+    return (int16_t)x;
+}
+
+
+/* Term `K * x` with `K` in `gain_frac_bits` fractional bits, saturated to Q15.
+ * The saturation is recorded in `term_sat`, for `epid_q15_p*_sum()`.
+ */
+static int16_t epid_q15_mul(epid_q15_t *ctx, int16_t k, int16_t x)
+{
+    const int32_t y = ((int32_t)k * (int32_t)x) >> ctx->gain_frac_bits;
+
+    if (y > (int32_t)INT16_MAX) {
+        ctx->term_sat |= EPID_Q_SAT_MAX;
+        return INT16_MAX;
+    }
+    else if (y < (int32_t)INT16_MIN) {
+        ctx->term_sat |= EPID_Q_SAT_MIN;
+        return INT16_MIN;
+    }
+    return (int16_t)y;
+}
+
+
+epid_info_t epid_q31_init(epid_q31_t *ctx,
+                          int32_t xk_1, int32_t xk_2, int32_t y_previous,
+                          int32_t kp, int32_t ki, int32_t kd,
+                          uint_fast8_t gain_frac_bits)
+{
+    if ((ctx == NULL)
+     || (kp <= 0)
+     || (ki <= 0)
+     || (kd < 0) /* Okay to be zero for PI controller. */
+     || (gain_frac_bits > EPID_Q31_GAIN_FRAC_MAX)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Set previous states for equations. */
+    ctx->xk_1 = xk_1; /* Set `x[k-1]` */
+    ctx->xk_2 = xk_2; /* Set `x[k-1]` for D-term */
+    ctx->y_out = y_previous; /* Set `y[k-1]` */
+
+    /* Direct gains assignments. */
+    ctx->kp = kp; /* P-term gain constant. */
+    ctx->ki = ki; /* I-term gain constant. */
+    ctx->kd = kd; /* D-term gain constant. */
+    ctx->gain_frac_bits = gain_frac_bits;
+
+    ctx->term_sat = 0U;
+    ctx->overflow = 0U;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_q15_init(epid_q15_t *ctx,
+                          int16_t xk_1, int16_t xk_2, int16_t y_previous,
+                          int16_t kp, int16_t ki, int16_t kd,
+                          uint_fast8_t gain_frac_bits)
+{
+    if ((ctx == NULL)
+     || (kp <= 0)
+     || (ki <= 0)
+     || (kd < 0) /* Okay to be zero for PI controller. */
+     || (gain_frac_bits > EPID_Q15_GAIN_FRAC_MAX)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Set previous states for equations. */
+    ctx->xk_1 = xk_1; /* Set `x[k-1]` */
+    ctx->xk_2 = xk_2; /* Set `x[k-1]` for D-term */
+    ctx->y_out = y_previous; /* Set `y[k-1]` */
+
+    /* Direct gains assignments. */
+    ctx->kp = kp; /* P-term gain constant. */
+    ctx->ki = ki; /* I-term gain constant. */
+    ctx->kd = kd; /* D-term gain constant. */
+    ctx->gain_frac_bits = gain_frac_bits;
+
+    ctx->term_sat = 0U;
+    ctx->overflow = 0U;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_q31_pi_calc(epid_q31_t *ctx, int32_t setpoint, int32_t measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     */
+    ctx->term_sat = 0U;
+    const int32_t dx = epid_q31_sat(ctx, (int64_t)ctx->xk_1 - measure);
+    const int32_t e = epid_q31_sat(ctx, (int64_t)setpoint - measure);
+
+    ctx->p_term = epid_q31_mul(ctx, ctx->kp, dx);
+    ctx->i_term = epid_q31_mul(ctx, ctx->ki, e);
+
+    ctx->xk_1 = measure; /* `x[k-1] = x[k]` */
+}
+
+
+void epid_q15_pi_calc(epid_q15_t *ctx, int16_t setpoint, int16_t measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     */
+    ctx->term_sat = 0U;
+    const int16_t dx = epid_q15_sat(ctx, (int32_t)ctx->xk_1 - measure);
+    const int16_t e = epid_q15_sat(ctx, (int32_t)setpoint - measure);
+
+    ctx->p_term = epid_q15_mul(ctx, ctx->kp, dx);
+    ctx->i_term = epid_q15_mul(ctx, ctx->ki, e);
+
+    ctx->xk_1 = measure; /* `x[k-1] = x[k]` */
+}
+
+
+void epid_q31_pid_calc(epid_q31_t *ctx, int32_t setpoint, int32_t measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+     */
+    ctx->term_sat = 0U;
+    const int32_t dx = epid_q31_sat(ctx, (int64_t)ctx->xk_1 - measure);
+    const int32_t ddx = epid_q31_sat(ctx, (int64_t)ctx->xk_1 + dx - ctx->xk_2);
+    const int32_t e = epid_q31_sat(ctx, (int64_t)setpoint - measure);
+
+    ctx->d_term = epid_q31_mul(ctx, ctx->kd, ddx);
+    ctx->p_term = epid_q31_mul(ctx, ctx->kp, dx);
+    ctx->i_term = epid_q31_mul(ctx, ctx->ki, e);
+
+    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = measure;   /* `x[k-1] = x[k]` */
+}
+
+
+void epid_q15_pid_calc(epid_q15_t *ctx, int16_t setpoint, int16_t measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+     */
+    ctx->term_sat = 0U;
+    const int16_t dx = epid_q15_sat(ctx, (int32_t)ctx->xk_1 - measure);
+    const int16_t ddx = epid_q15_sat(ctx, (int32_t)ctx->xk_1 + dx - ctx->xk_2);
+    const int16_t e = epid_q15_sat(ctx, (int32_t)setpoint - measure);
+
+    ctx->d_term = epid_q15_mul(ctx, ctx->kd, ddx);
+    ctx->p_term = epid_q15_mul(ctx, ctx->kp, dx);
+    ctx->i_term = epid_q15_mul(ctx, ctx->ki, e);
+
+    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = measure;   /* `x[k-1] = x[k]` */
+}
+
+
+void epid_q31_pi_sum(epid_q31_t *ctx, int32_t out_min, int32_t out_max)
+{
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+    int64_t y = (int64_t)ctx->y_out + ctx->p_term + ctx->i_term;
+    uint_fast8_t sat = ctx->term_sat;
+
+    /* Limit the new output `y[k]` (CV) to boundaries, in the wide sum (which
+     * can not overflow). Terms saturated only to the limited side are absorbed.
+     */
+    if (y >= out_max) {
+        y = out_max;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MAX;
+    }
+    else if (y <= out_min) {
+        y = out_min;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MIN;
+    }
+    if (sat != 0U) {
+        ctx->overflow = 1U;
+    }
+
+    ctx->y_out = (int32_t)y;
+}
+
+
+void epid_q15_pi_sum(epid_q15_t *ctx, int16_t out_min, int16_t out_max)
+{
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+    int32_t y = (int32_t)ctx->y_out + ctx->p_term + ctx->i_term;
+    uint_fast8_t sat = ctx->term_sat;
+
+    /* Limit the new output `y[k]` (CV) to boundaries, in the wide sum (which
+     * can not overflow). Terms saturated only to the limited side are absorbed.
+     */
+    if (y >= out_max) {
+        y = out_max;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MAX;
+    }
+    else if (y <= out_min) {
+        y = out_min;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MIN;
+    }
+    if (sat != 0U) {
+        ctx->overflow = 1U;
+    }
+
+    ctx->y_out = (int16_t)y;
+}
+
+
+void epid_q31_pid_sum(epid_q31_t *ctx, int32_t out_min, int32_t out_max)
+{
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+    int64_t y = (int64_t)ctx->y_out + ctx->p_term + ctx->i_term + ctx->d_term;
+    uint_fast8_t sat = ctx->term_sat;
+
+    /* Limit the new output `y[k]` (CV) to boundaries, in the wide sum (which
+     * can not overflow). Terms saturated only to the limited side are absorbed.
+     */
+    if (y >= out_max) {
+        y = out_max;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MAX;
+    }
+    else if (y <= out_min) {
+        y = out_min;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MIN;
+    }
+    if (sat != 0U) {
+        ctx->overflow = 1U;
+    }
+
+    ctx->y_out = (int32_t)y;
+}
+
+
+void epid_q15_pid_sum(epid_q15_t *ctx, int16_t out_min, int16_t out_max)
+{
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+    int32_t y = (int32_t)ctx->y_out + ctx->p_term + ctx->i_term + ctx->d_term;
+    uint_fast8_t sat = ctx->term_sat;
+
+    /* Limit the new output `y[k]` (CV) to boundaries, in the wide sum (which
+     * can not overflow). Terms saturated only to the limited side are absorbed.
+     */
+    if (y >= out_max) {
+        y = out_max;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MAX;
+    }
+    else if (y <= out_min) {
+        y = out_min;
+        sat &= (uint_fast8_t)~EPID_Q_SAT_MIN;
+    }
+    if (sat != 0U) {
+        ctx->overflow = 1U;
+    }
+
+    ctx->y_out = (int16_t)y;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
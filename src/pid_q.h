@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID fixed-point Type-C PID controllers for targets without FPU.
+ *
+ * Same equations and API as the floating-point `epid_t`, with
+ * signals {SP, PV, CV, terms} as fractions in `[-1, 1)`:
+ *   - `epid_q31_t`: Q31 signals (`int32_t`), gains in `int32_t`.
+ *   - `epid_q15_t`: Q15 signals (`int16_t`), gains in `int16_t`.
+ * Gains have a configurable number of fractional bits `gain_frac_bits`,
+ * so the real gain is `K = k / 2^gain_frac_bits`.
+ *
+ * All arithmetic saturates. Any saturation sets the sticky `overflow` flag
+ * of the context, which takes the place of `EPID_ERR_FLT` of the
+ * floating-point API; It is cleared only by `epid_q*_init()`.
+ * A saturated term {`P[k]`, `I[k]`, `D[k]`} sets `overflow` only if the
+ * output limits of `epid_q*_sum()` do not absorb it: The output is not
+ * limited by the same side as the saturations, so it differs from the exact
+ * one. Limiting the output to {out_min, out_max} alone is not a saturation.
+ *
+ * Note: Signed right shifts are assumed arithmetic, as by GCC and Clang.
+ */
+
+
+#ifndef EPID_Q_H
+#define EPID_Q_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+/* Convert a real value `x` to a fixed-point value with `frac` fractional bits. */
+#define EPID_Q31_CONST(x, frac) ((int32_t)((x) * (double)(1UL << (frac))))
+#define EPID_Q15_CONST(x, frac) ((int16_t)((x) * (double)(1UL << (frac))))
+
+/* Max fractional bits of the gains. */
+#define EPID_Q31_GAIN_FRAC_MAX (31U)
+#define EPID_Q15_GAIN_FRAC_MAX (15U)
+
+
+typedef struct {
+    /* Controller settings. */
+    int32_t kp; /* Gain constant `Kp` for P-term. */
+    int32_t ki; /* Gain constant `Ki` for I-term. */
+    int32_t kd; /* Gain constant `Kd` for D-term. */
+    uint_fast8_t gain_frac_bits; /* Fractional bits of {kp, ki, kd}. */
+
+    /* Controller states. */
+    int32_t xk_1; /* Physical measurement `PV[k-1]`. */
+    int32_t xk_2; /* Physical measurement `PV[k-2]`. */
+
+    /* Controller outputs. */
+    int32_t p_term; /* The P-term calculated value `P[k]`. */
+    int32_t i_term; /* The I-term calculated value `I[k]`. */
+    int32_t d_term; /* The D-term calculated value `D[k]`. */
+
+    int32_t y_out; /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+
+    uint_fast8_t term_sat; /* Terms saturations of the last `calc`, checked by `sum`. */
+    uint_fast8_t overflow; /* Sticky saturation flag, `1` if any saturation occurred. */
+} epid_q31_t;
+
+typedef struct {
+    /* Controller settings. */
+    int16_t kp; /* Gain constant `Kp` for P-term. */
+    int16_t ki; /* Gain constant `Ki` for I-term. */
+    int16_t kd; /* Gain constant `Kd` for D-term. */
+    uint_fast8_t gain_frac_bits; /* Fractional bits of {kp, ki, kd}. */
+
+    /* Controller states. */
+    int16_t xk_1; /* Physical measurement `PV[k-1]`. */
+    int16_t xk_2; /* Physical measurement `PV[k-2]`. */
+
+    /* Controller outputs. */
+    int16_t p_term; /* The P-term calculated value `P[k]`. */
+    int16_t i_term; /* The I-term calculated value `I[k]`. */
+    int16_t d_term; /* The D-term calculated value `D[k]`. */
+
+    int16_t y_out; /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+
+    uint_fast8_t term_sat; /* Terms saturations of the last `calc`, checked by `sum`. */
+    uint_fast8_t overflow; /* Sticky saturation flag, `1` if any saturation occurred. */
+} epid_q15_t;
+
+
+/**
+ * Initialize or reset a `epid_q31_t` context by direct gains assignment,
+ * and set {`x[k-1]`, `x[k-2]`, `y[k-1]`}. Clear the `overflow` flag.
+ *
+ * ctx: Pointer to the `epid_q31_t` context.
+ * xk_1: A process variable (PV) point `x[k-1]`.
+ * xk_2: A process variable (PV) point `x[k-2]` for D-term.
+ * y_previous: A control variable (CV) point `y[k-1]`.
+ * kp: Gain constant `Kp` for P-term.
+ * ki: Gain constant `Ki` for I-term.
+ * kd: Gain constant `Kd` for D-term.
+ * gain_frac_bits: Fractional bits of {kp, ki, kd}, `<= EPID_Q31_GAIN_FRAC_MAX`.
+ *
+ * - {kp, ki, kd} must not be negative.
+ * - {kp, ki} must not be zero.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_q31_init(epid_q31_t *ctx,
+                          int32_t xk_1, int32_t xk_2, int32_t y_previous,
+                          int32_t kp, int32_t ki, int32_t kd,
+                          uint_fast8_t gain_frac_bits);
+
+/* Same as `epid_q31_init()` for `epid_q15_t`, `gain_frac_bits <= EPID_Q15_GAIN_FRAC_MAX`. */
+epid_info_t epid_q15_init(epid_q15_t *ctx,
+                          int16_t xk_1, int16_t xk_2, int16_t y_previous,
+                          int16_t kp, int16_t ki, int16_t kd,
+                          uint_fast8_t gain_frac_bits);
+
+
+/**
+ * Do processing as a Type-C PI controller to calculated and update
+ * terms {`P[k]`, `I[k]`} in the context. See `epid_pi_calc()`.
+ *
+ * ctx: Pointer to the context.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ */
+void epid_q31_pi_calc(epid_q31_t *ctx, int32_t setpoint, int32_t measure);
+void epid_q15_pi_calc(epid_q15_t *ctx, int16_t setpoint, int16_t measure);
+
+
+/**
+ * Do processing as a Type-C PID controller to calculated and update
+ * terms {`P[k]`, `I[k]`, `D[k]`} in the context. See `epid_pid_calc()`.
+ *
+ * ctx: Pointer to the context.
+ * setpoint: The desired setpoint (SP).
+ * measure: Measured process variable (PV).
+ */
+void epid_q31_pid_calc(epid_q31_t *ctx, int32_t setpoint, int32_t measure);
+void epid_q15_pid_calc(epid_q15_t *ctx, int16_t setpoint, int16_t measure);
+
+
+/**
+ * Update the control variable `y[k] = y[k-1] + P[k] + I[k]` in the context,
+ * limited to {out_min, out_max}. See `epid_pi_sum()`.
+ *
+ * ctx: Pointer to the context.
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ */
+void epid_q31_pi_sum(epid_q31_t *ctx, int32_t out_min, int32_t out_max);
+void epid_q15_pi_sum(epid_q15_t *ctx, int16_t out_min, int16_t out_max);
+
+
+/**
+ * Update the control variable `y[k] = y[k-1] + P[k] + I[k] + D[k]`
+ * in the context, limited to {out_min, out_max}. See `epid_pid_sum()`.
+ *
+ * ctx: Pointer to the context.
+ * out_min: Min output from controller.
+ * out_max: Max output from controller.
+ */
+void epid_q31_pid_sum(epid_q31_t *ctx, int32_t out_min, int32_t out_max);
+void epid_q15_pid_sum(epid_q15_t *ctx, int16_t out_min, int16_t out_max);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_Q_H */
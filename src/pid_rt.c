@@ -0,0 +1,425 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/* For `sched_setaffinity()` and `CPU_SET()`. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+# define _GNU_SOURCE 1
+#endif
+
+#include "pid_rt.h"
+
+#ifdef EPID_RT_AVAILABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+
+/* Stack bytes touched after `mlockall()`, so the loop does not page fault. */
+#define EPID_RT_STACK_PREFAULT (64U * 1024U)
+
+
+static uint64_t epid_rt_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * UINT64_C(1000000000)) + (uint64_t)ts.tv_nsec;
+}
+
+
+static struct timespec epid_rt_timespec(uint64_t ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / UINT64_C(1000000000));
+    ts.tv_nsec = (long)(ns % UINT64_C(1000000000));
+    return ts;
+}
+
+
+/* Index of the most significant set bit, `value != 0`. */
+static unsigned epid_rt_msb(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63U - (unsigned)__builtin_clzll(value);
+#else
+    unsigned msb = 0U;
+    while ((value >>= 1) != 0U) {
+        msb++;
+    }
+    return msb;
+#endif
+}
+
+
+static size_t epid_rt_bucket(uint64_t value)
+{
+    unsigned e;
+
+    if (value < EPID_RT_HIST_SUB) {
+        return (size_t)value;
+    }
+    e = epid_rt_msb(value);
+    return ((size_t)(e - EPID_RT_HIST_SUB_BITS + 1U) * EPID_RT_HIST_SUB)
+         + (size_t)((value >> (e - EPID_RT_HIST_SUB_BITS)) & (EPID_RT_HIST_SUB - 1U));
+}
+
+
+/* Greatest value of a bucket. */
+static uint64_t epid_rt_bucket_max(size_t bucket)
+{
+    unsigned shift;
+
+    if (bucket < EPID_RT_HIST_SUB) {
+        return (uint64_t)bucket;
+    }
+    shift = (unsigned)(bucket / EPID_RT_HIST_SUB) - 1U;
+    return ((((uint64_t)EPID_RT_HIST_SUB + (bucket % EPID_RT_HIST_SUB)) + 1U) << shift) - 1U;
+}
+
+
+void epid_rt_hist_clear(epid_rt_hist_t *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT64_MAX;
+}
+
+
+void epid_rt_hist_add(epid_rt_hist_t *hist, uint64_t value)
+{
+    hist->buckets[epid_rt_bucket(value)]++;
+    hist->count++;
+    hist->sum += value;
+    if (value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+
+uint64_t epid_rt_hist_percentile(const epid_rt_hist_t *hist, double p)
+{
+    uint64_t rank, seen = 0U;
+
+    if (hist->count == 0U) {
+        return 0U;
+    }
+
+    /* Rank of the value, from 1 to `count`. */
+    rank = (uint64_t)((p / 100.0) * (double)hist->count + 0.5);
+    if (rank < 1U) {
+        rank = 1U;
+    }
+    else if (rank > hist->count) {
+        rank = hist->count;
+    }
+
+    for (size_t b = 0U; b < EPID_RT_HIST_LEN; b++) {
+        seen += hist->buckets[b];
+        if (seen >= rank) {
+            const uint64_t value = epid_rt_bucket_max(b);
+            if (value < hist->min) {
+                return hist->min;
+            }
+            return (value > hist->max) ? hist->max : value;
+        }
+    }
+
+    return hist->max;
+}
+
+
+void epid_rt_hist_summary(const epid_rt_hist_t *hist, epid_rt_summary_t *summary)
+{
+    if (hist->count == 0U) {
+        memset(summary, 0, sizeof(*summary));
+        return;
+    }
+
+    summary->min = hist->min;
+    summary->p50 = epid_rt_hist_percentile(hist, 50.0);
+    summary->p99 = epid_rt_hist_percentile(hist, 99.0);
+    summary->p999 = epid_rt_hist_percentile(hist, 99.9);
+    summary->max = hist->max;
+    summary->mean = (double)hist->sum / (double)hist->count;
+}
+
+
+epid_info_t epid_rt_init(epid_rt_t *rt, const epid_rt_config_t *config,
+                         epid_t *ctx, float setpoint,
+                         epid_rt_sensor_t sensor, epid_rt_actuator_t actuator,
+                         void *user)
+{
+    if ((rt == NULL)
+     || (config == NULL)
+     || (config->period_ns == 0U)
+     || (ctx == NULL)
+     || (sensor == NULL)
+     || (actuator == NULL)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    rt->config = *config;
+    rt->ctx = ctx;
+    rt->setpoint = setpoint;
+    rt->sensor = sensor;
+    rt->actuator = actuator;
+    rt->user = user;
+
+    rt->stats.ticks = 0U;
+    rt->stats.misses = 0U;
+    rt->stats.skipped = 0U;
+    rt->stats.sensor_errors = 0U;
+    epid_rt_hist_clear(&rt->stats.jitter);
+    epid_rt_hist_clear(&rt->stats.compute);
+
+    rt->stop = 0;
+    rt->error_op = NULL;
+    rt->error = 0;
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_rt_stop(epid_rt_t *rt)
+{
+    rt->stop = 1;
+}
+
+
+static epid_info_t epid_rt_fail(epid_rt_t *rt, const char *op)
+{
+    rt->error_op = op;
+    rt->error = errno;
+    return EPID_ERR_INIT;
+}
+
+
+/* One tick: Sensor, controller and actuator. */
+static void epid_rt_tick(epid_rt_t *rt)
+{
+    float measure;
+
+    if (rt->sensor(rt->user, &rt->setpoint, &measure) != 0) {
+        rt->stats.sensor_errors++;
+        return;
+    }
+
+    if (rt->config.is_pi) {
+        epid_pi_calc(rt->ctx, rt->setpoint, measure);
+        epid_pi_sum(rt->ctx, rt->config.out_min, rt->config.out_max);
+    }
+    else {
+        epid_pid_calc(rt->ctx, rt->setpoint, measure);
+        epid_pid_sum(rt->ctx, rt->config.out_min, rt->config.out_max);
+    }
+
+    rt->actuator(rt->user, rt->ctx->y_out);
+}
+
+
+/* Timed loop, the thread settings are done. */
+static epid_info_t epid_rt_loop(epid_rt_t *rt)
+{
+    const uint64_t period = rt->config.period_ns;
+    const int use_timerfd = ((rt->config.options & EPID_RT_TIMERFD) != 0U);
+    uint64_t deadline = epid_rt_now() + period;
+    int tfd = -1;
+
+    if (use_timerfd) {
+        struct itimerspec its;
+
+        tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (tfd < 0) {
+            return epid_rt_fail(rt, "timerfd_create");
+        }
+        its.it_value = epid_rt_timespec(deadline);
+        its.it_interval = epid_rt_timespec(period);
+        if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) != 0) {
+            close(tfd);
+            return epid_rt_fail(rt, "timerfd_settime");
+        }
+    }
+
+    for (uint64_t k = 0U; ((rt->config.ticks == 0U) || (k < rt->config.ticks)) && (!rt->stop); k++) {
+        uint64_t wake, end;
+
+        if (use_timerfd) {
+            uint64_t expirations = 0U;
+            ssize_t len;
+
+            do {
+                len = read(tfd, &expirations, sizeof(expirations));
+            } while ((len < 0) && (errno == EINTR) && (!rt->stop));
+            if (rt->stop) {
+                break;
+            }
+            if (len != (ssize_t)sizeof(expirations)) {
+                close(tfd);
+                return epid_rt_fail(rt, "read(timerfd)");
+            }
+            /* Expirations missed by a late tick or read are skipped. */
+            if (expirations > 1U) {
+                rt->stats.misses++;
+                rt->stats.skipped += expirations - 1U;
+                deadline += (expirations - 1U) * period;
+            }
+        }
+        else {
+            const struct timespec ts = epid_rt_timespec(deadline);
+            int err;
+
+            do {
+                err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            } while ((err == EINTR) && (!rt->stop));
+            if ((err != 0) && (err != EINTR)) {
+                errno = err;
+                return epid_rt_fail(rt, "clock_nanosleep");
+            }
+        }
+
+        if (rt->stop) {
+            break;
+        }
+
+        wake = epid_rt_now();
+        epid_rt_tick(rt);
+        end = epid_rt_now();
+
+        rt->stats.ticks++;
+        epid_rt_hist_add(&rt->stats.jitter, (wake > deadline) ? (wake - deadline) : 0U);
+        epid_rt_hist_add(&rt->stats.compute, end - wake);
+
+        deadline += period;
+        if ((!use_timerfd) && (end > deadline)) {
+            /* Next deadline in the future, without a burst of late ticks. */
+            const uint64_t late = ((end - deadline) / period) + 1U;
+            rt->stats.misses++;
+            rt->stats.skipped += late;
+            deadline += late * period;
+        }
+    }
+
+    if (tfd >= 0) {
+        close(tfd);
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_rt_run(epid_rt_t *rt)
+{
+    const unsigned options = rt->config.options;
+    cpu_set_t cpus_old;
+    struct sched_param param_old;
+    int policy_old = 0;
+    int locked = 0, pinned = 0, fifo = 0;
+    epid_info_t err = EPID_ERR_NONE;
+
+    rt->error_op = NULL;
+    rt->error = 0;
+
+    if ((options & EPID_RT_MLOCK) != 0U) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            err = epid_rt_fail(rt, "mlockall");
+        }
+        else {
+            volatile unsigned char stack[EPID_RT_STACK_PREFAULT];
+            for (size_t i = 0U; i < sizeof(stack); i += 256U) {
+                stack[i] = 0U;
+            }
+            locked = 1;
+        }
+    }
+
+    if ((err == EPID_ERR_NONE) && ((options & EPID_RT_PIN) != 0U)) {
+        cpu_set_t cpus;
+
+        CPU_ZERO(&cpus);
+        if ((rt->config.cpu < 0) || (rt->config.cpu >= CPU_SETSIZE)) {
+            errno = EINVAL;
+            err = epid_rt_fail(rt, "sched_setaffinity");
+        }
+        else if (sched_getaffinity(0, sizeof(cpus_old), &cpus_old) != 0) {
+            err = epid_rt_fail(rt, "sched_getaffinity");
+        }
+        else {
+            CPU_SET(rt->config.cpu, &cpus);
+            if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+                err = epid_rt_fail(rt, "sched_setaffinity");
+            }
+            else {
+                pinned = 1;
+            }
+        }
+    }
+
+    if ((err == EPID_ERR_NONE) && ((options & EPID_RT_FIFO) != 0U)) {
+        struct sched_param param;
+
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = rt->config.priority;
+        policy_old = sched_getscheduler(0);
+        if ((policy_old < 0) || (sched_getparam(0, &param_old) != 0)) {
+            err = epid_rt_fail(rt, "sched_getscheduler");
+        }
+        else if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+            err = epid_rt_fail(rt, "sched_setscheduler");
+        }
+        else {
+            fifo = 1;
+        }
+    }
+
+    if (err == EPID_ERR_NONE) {
+        err = epid_rt_loop(rt);
+    }
+
+    /* Restore the thread settings. */
+    if (fifo) {
+        sched_setscheduler(0, policy_old, &param_old);
+    }
+    if (pinned) {
+        sched_setaffinity(0, sizeof(cpus_old), &cpus_old);
+    }
+    if (locked) {
+        munlockall();
+    }
+
+    return err;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_rt_unavailable_t;
+#endif /* EPID_RT_AVAILABLE */
@@ -0,0 +1,228 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID real-time runner: The periodic "read PV, `epid_pid_calc()`,
+ * `epid_pid_sum()`, write CV, sleep" loop of an `epid_t` controller for
+ * Linux hosts, with timing statistics.
+ *
+ * - Absolute deadlines on `CLOCK_MONOTONIC`, by `clock_nanosleep()` or by
+ *   a periodic `timerfd` (`EPID_RT_TIMERFD`), so the period does not drift.
+ * - Optional `SCHED_FIFO` priority, `mlockall()` and CPU pinning of the
+ *   calling thread, restored when the run ends.
+ * - Pluggable sensor and actuator callbacks: Hardware I/O, or a simulated plant.
+ * - Histograms of the wake-up latency after every deadline (jitter) and of the
+ *   compute time (sensor, controller and actuator), with min, p50, p99,
+ *   p99.9 and max; counts of deadline misses and skipped periods.
+ *
+ * Host only: `EPID_RT_AVAILABLE` is defined on Linux, else "pid_rt.c" is empty.
+ */
+
+
+#ifndef EPID_RT_H
+#define EPID_RT_H 1
+
+#if defined(__linux__)
+# define EPID_RT_AVAILABLE 1
+#endif
+
+#ifdef EPID_RT_AVAILABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <signal.h> /* For `sig_atomic_t`. */
+
+#include "pid.h"
+
+/* Options of `epid_rt_config_t`, bits. */
+#define EPID_RT_TIMERFD (1U << 0) /* Wait on a `timerfd`, else `clock_nanosleep()`. */
+#define EPID_RT_FIFO (1U << 1) /* `SCHED_FIFO` at `priority`. */
+#define EPID_RT_MLOCK (1U << 2) /* Lock all memory, prefault the stack. */
+#define EPID_RT_PIN (1U << 3) /* Run on the CPU `cpu` only. */
+
+/* Histogram resolution: `2^EPID_RT_HIST_SUB_BITS` buckets per power of 2,
+ * exact below `2^EPID_RT_HIST_SUB_BITS` ns, else within 1/16 (6.25%).
+ */
+#define EPID_RT_HIST_SUB_BITS (4U)
+#define EPID_RT_HIST_SUB (1U << EPID_RT_HIST_SUB_BITS)
+#define EPID_RT_HIST_LEN ((64U - EPID_RT_HIST_SUB_BITS + 1U) * EPID_RT_HIST_SUB)
+
+
+/**
+ * Sensor callback: Read the process variable (PV) of a tick.
+ * user: User pointer of the runner.
+ * setpoint: Current setpoint (SP), can be changed by the callback.
+ * measure: Where to store the measured process variable (PV).
+ * Return: Zero on success, else the tick is skipped (no controller update,
+ *         no actuator write) and counted in `sensor_errors`.
+ */
+typedef int (*epid_rt_sensor_t)(void *user, float *setpoint, float *measure);
+
+/**
+ * Actuator callback: Write the controller output (CV) of a tick.
+ * user: User pointer of the runner.
+ * output: The controller output `ctx->y_out`.
+ */
+typedef void (*epid_rt_actuator_t)(void *user, float output);
+
+typedef struct {
+    uint64_t count; /* Number of values. */
+    uint64_t min; /* Min value, `UINT64_MAX` if empty. */
+    uint64_t max; /* Max value. */
+    uint64_t sum; /* Sum of values, for the mean. */
+    uint64_t buckets[EPID_RT_HIST_LEN];
+} epid_rt_hist_t;
+
+typedef struct {
+    uint64_t min, p50, p99, p999, max; /* In ns. */
+    double mean; /* In ns. */
+} epid_rt_summary_t;
+
+typedef struct {
+    uint64_t period_ns; /* Controller sample period in ns. */
+    uint64_t ticks; /* Number of ticks to run, zero until `epid_rt_stop()`. */
+    unsigned options; /* `EPID_RT_*` bits. */
+    int priority; /* `SCHED_FIFO` priority, with `EPID_RT_FIFO`. */
+    int cpu; /* CPU number, with `EPID_RT_PIN`. */
+    int is_pi; /* Non-zero for a PI controller, else PID. */
+    float out_min; /* Min output from controller. */
+    float out_max; /* Max output from controller. */
+} epid_rt_config_t;
+
+typedef struct {
+    uint64_t ticks; /* Ticks run. */
+    uint64_t misses; /* Ticks ended after the next deadline (late wake-up or compute). */
+    uint64_t skipped; /* Deadlines skipped after misses, not run late. */
+    uint64_t sensor_errors; /* Ticks skipped by the sensor callback. */
+    epid_rt_hist_t jitter; /* Wake-up latency after the deadline, in ns. */
+    epid_rt_hist_t compute; /* Sensor, controller and actuator time, in ns. */
+} epid_rt_stats_t;
+
+typedef struct {
+    epid_rt_config_t config;
+    epid_t *ctx; /* The controller, initialized by the user. */
+    float setpoint; /* Setpoint (SP), kept between ticks. */
+    epid_rt_sensor_t sensor;
+    epid_rt_actuator_t actuator;
+    void *user; /* User pointer of the callbacks. */
+
+    epid_rt_stats_t stats;
+
+    volatile sig_atomic_t stop; /* Set by `epid_rt_stop()`. */
+
+    /* Failed system call of `epid_rt_run()` and its `errno`, or `NULL`. */
+    const char *error_op;
+    int error;
+} epid_rt_t;
+
+
+/**
+ * Initialize a runner of an `epid_t` controller and clear its statistics.
+ *
+ * rt: Pointer to the `epid_rt_t` context.
+ * config: Runner settings, copied; `period_ns` must not be zero.
+ * ctx: Pointer to an initialized `epid_t` context, see `epid_init_T()`
+ *      with `sample_period` of `config->period_ns`.
+ * setpoint: The initial setpoint (SP).
+ * sensor: Sensor callback.
+ * actuator: Actuator callback.
+ * user: User pointer given to the callbacks.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_rt_init(epid_rt_t *rt, const epid_rt_config_t *config,
+                         epid_t *ctx, float setpoint,
+                         epid_rt_sensor_t sensor, epid_rt_actuator_t actuator,
+                         void *user);
+
+
+/**
+ * Run the control loop in the calling thread, one tick per period from
+ * one period after the call, for `config.ticks` ticks or until `epid_rt_stop()`.
+ * Each tick: sensor, `epid_p*_calc()`, `epid_p*_sum()`, actuator.
+ * After a deadline miss, the late deadlines are skipped (no burst of ticks).
+ * Statistics are accumulated over runs.
+ *
+ * rt: Pointer to the `epid_rt_t` context.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if a setup or timer system call failed, see
+ *     `rt->error_op` and `rt->error` (e.g. `EPERM` for `SCHED_FIFO`).
+ */
+epid_info_t epid_rt_run(epid_rt_t *rt);
+
+
+/**
+ * Make `epid_rt_run()` return after the current tick, or at once if
+ * called before it; cleared by `epid_rt_init()`.
+ * Async-signal-safe, e.g. from a `SIGINT` handler.
+ *
+ * rt: Pointer to the `epid_rt_t` context.
+ */
+void epid_rt_stop(epid_rt_t *rt);
+
+
+/**
+ * Clear a histogram.
+ *
+ * hist: Pointer to the `epid_rt_hist_t` context.
+ */
+void epid_rt_hist_clear(epid_rt_hist_t *hist);
+
+
+/**
+ * Add a value to a histogram.
+ *
+ * hist: Pointer to the `epid_rt_hist_t` context.
+ * value: The value, in ns.
+ */
+void epid_rt_hist_add(epid_rt_hist_t *hist, uint64_t value);
+
+
+/**
+ * Get a percentile of a histogram, the upper bound of its bucket
+ * limited to {min, max}.
+ *
+ * hist: Pointer to the `epid_rt_hist_t` context.
+ * p: Percentile, `0 <= p <= 100`.
+ *
+ * Return: The value, zero if the histogram is empty.
+ */
+uint64_t epid_rt_hist_percentile(const epid_rt_hist_t *hist, double p);
+
+
+/**
+ * Get min, p50, p99, p99.9, max and mean of a histogram.
+ *
+ * hist: Pointer to the `epid_rt_hist_t` context.
+ * summary: Pointer to the destination, all zero if the histogram is empty.
+ */
+void epid_rt_hist_summary(const epid_rt_hist_t *hist, epid_rt_summary_t *summary);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_RT_AVAILABLE */
+
+#endif /* EPID_RT_H */
@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_sched.h"
+
+/* Group indexes are stored in `uint8_t`, `EPID_SCHED_NONE` excluded. */
+typedef char epid_sched_groups_check[(EPID_SCHED_GROUPS_MAX < EPID_SCHED_NONE) ? 1 : -1];
+
+
+/* Put the group `g` in the wheel slot of its `due` tick. */
+static void epid_sched_insert(epid_sched_t *sched, uint8_t g)
+{
+    epid_sched_group_t *group = &sched->groups[g];
+    const uint32_t due = group->due;
+    const uint32_t delta = due - sched->now; /* Wraps around with `now`. */
+    uint8_t *slot;
+
+    if (delta < EPID_SCHED_WHEEL0) {
+        slot = &sched->wheel0[due & (EPID_SCHED_WHEEL0 - 1U)];
+    }
+    else {
+        uint32_t level = 0U;
+        uint32_t shift = EPID_SCHED_WHEEL0_BITS;
+
+        /* The lowest level whose range holds `delta`. */
+        while ((level < (EPID_SCHED_LEVELS - 2U))
+            && (delta >= (UINT32_C(1) << (shift + EPID_SCHED_WHEELN_BITS)))) {
+            level++;
+            shift += EPID_SCHED_WHEELN_BITS;
+        }
+        slot = &sched->wheeln[level][(due >> shift) & (EPID_SCHED_WHEELN - 1U)];
+    }
+
+    group->next = *slot;
+    *slot = g;
+}
+
+
+/* Move the groups of a slot of the level `level + 1` to lower levels.
+ * Return: `index`.
+ */
+static uint32_t epid_sched_cascade(epid_sched_t *sched, uint32_t level, uint32_t index)
+{
+    uint8_t g = sched->wheeln[level][index];
+
+    sched->wheeln[level][index] = EPID_SCHED_NONE;
+
+    while (g != EPID_SCHED_NONE) {
+        const uint8_t next = sched->groups[g].next;
+        epid_sched_insert(sched, g);
+        g = next;
+    }
+
+    return index;
+}
+
+
+epid_info_t epid_sched_init(epid_sched_t *sched)
+{
+    if (sched == NULL) {
+        return EPID_ERR_INIT;
+    }
+
+    for (size_t i = 0U; i < EPID_SCHED_WHEEL0; i++) {
+        sched->wheel0[i] = EPID_SCHED_NONE;
+    }
+    for (size_t l = 0U; l < (EPID_SCHED_LEVELS - 1U); l++) {
+        for (size_t i = 0U; i < EPID_SCHED_WHEELN; i++) {
+            sched->wheeln[l][i] = EPID_SCHED_NONE;
+        }
+    }
+
+    sched->n_groups = 0U;
+    sched->now = 0U;
+    sched->n_due = 0U;
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_sched_add(epid_sched_t *sched, size_t begin, size_t n,
+                           uint32_t period, uint32_t phase)
+{
+    epid_sched_group_t *group;
+
+    if ((sched == NULL)
+     || (sched->n_groups >= EPID_SCHED_GROUPS_MAX)
+     || (n == 0U)
+     || (n > (SIZE_MAX - begin))
+     || (period == 0U)
+     || (period > EPID_SCHED_PERIOD_MAX)
+     || (phase >= period)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Disjoint ranges: A controller is processed by one group only. */
+    for (size_t g = 0U; g < sched->n_groups; g++) {
+        const epid_sched_group_t *other = &sched->groups[g];
+        if ((begin < (other->begin + other->n)) && (other->begin < (begin + n))) {
+            return EPID_ERR_INIT;
+        }
+    }
+
+    group = &sched->groups[sched->n_groups];
+    group->begin = begin;
+    group->n = n;
+    group->period = period;
+    group->due = sched->now + phase;
+    epid_sched_insert(sched, (uint8_t)sched->n_groups);
+    sched->n_groups++;
+
+    return EPID_ERR_NONE;
+}
+
+
+size_t epid_sched_tick(epid_sched_t *sched)
+{
+    const uint32_t index = sched->now & (EPID_SCHED_WHEEL0 - 1U);
+    size_t n_due = 0U;
+    uint8_t g;
+
+    /* First level wrapped: Bring the next range of ticks down, level by level. */
+    if (index == 0U) {
+        uint32_t shift = EPID_SCHED_WHEEL0_BITS;
+        for (uint32_t level = 0U; level < (EPID_SCHED_LEVELS - 1U); level++) {
+            if (epid_sched_cascade(sched, level,
+                                   (sched->now >> shift) & (EPID_SCHED_WHEELN - 1U)) != 0U) {
+                break;
+            }
+            shift += EPID_SCHED_WHEELN_BITS;
+        }
+    }
+
+    /* Take the due groups, sorted by `begin` (insertion sort, few groups). */
+    g = sched->wheel0[index];
+    sched->wheel0[index] = EPID_SCHED_NONE;
+    while (g != EPID_SCHED_NONE) {
+        const size_t begin = sched->groups[g].begin;
+        size_t j = n_due;
+
+        while ((j > 0U) && (sched->groups[sched->due[j - 1U]].begin > begin)) {
+            sched->due[j] = sched->due[j - 1U];
+            j--;
+        }
+        sched->due[j] = g;
+        n_due++;
+        g = sched->groups[g].next;
+    }
+
+    /* Re-arm relative to the next tick. */
+    sched->now++;
+    for (size_t i = 0U; i < n_due; i++) {
+        sched->groups[sched->due[i]].due += sched->groups[sched->due[i]].period;
+        epid_sched_insert(sched, sched->due[i]);
+    }
+
+    sched->n_due = n_due;
+    return n_due;
+}
+
+
+/* One tick, with `kernel` on every run of adjacent due groups. */
+static void epid_sched_step(epid_sched_t *sched, epid_bank_t *bank,
+                            void (*kernel)(epid_bank_t *bank,
+                                           const float *setpoints, const float *measures,
+                                           float out_min, float out_max, size_t n),
+                            const float *setpoints, const float *measures,
+                            float out_min, float out_max)
+{
+    const size_t n_due = epid_sched_tick(sched);
+    size_t i = 0U;
+
+    while (i < n_due) {
+        const size_t begin = sched->groups[sched->due[i]].begin;
+        size_t end = begin + sched->groups[sched->due[i]].n;
+        epid_bank_t view;
+
+        /* Merge adjacent ranges into one dense call. */
+        for (i++; (i < n_due) && (sched->groups[sched->due[i]].begin == end); i++) {
+            end += sched->groups[sched->due[i]].n;
+        }
+
+        view.kp = bank->kp + begin;
+        view.ki = bank->ki + begin;
+        view.kd = bank->kd + begin;
+        view.xk_1 = bank->xk_1 + begin;
+        view.xk_2 = bank->xk_2 + begin;
+        view.y_out = bank->y_out + begin;
+        view.n = end - begin;
+
+        kernel(&view, setpoints + begin, measures + begin, out_min, out_max, end - begin);
+    }
+}
+
+
+void epid_sched_pi_step(epid_sched_t *sched, epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max)
+{
+    epid_sched_step(sched, bank, epid_bank_pi_step,
+                    setpoints, measures, out_min, out_max);
+}
+
+
+void epid_sched_pid_step(epid_sched_t *sched, epid_bank_t *bank,
+                         const float *setpoints, const float *measures,
+                         float out_min, float out_max)
+{
+    epid_sched_step(sched, bank, epid_bank_pid_step,
+                    setpoints, measures, out_min, out_max);
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID multi-rate scheduler: Runs the controllers of a bank (<pid_bank.h>)
+ * at their own sample periods, as integer multiples of a base tick.
+ *
+ * Controllers with the same period are placed next to each other in the bank
+ * and registered as a group {first index, count, period, phase}, so the due
+ * controllers of a tick are dense ranges of the bank arrays, processed by the
+ * bank (SIMD) kernels; adjacent due groups are merged into one kernel call.
+ *
+ * Groups are kept in a hierarchical timer wheel: `EPID_SCHED_WHEEL0` slots of
+ * one tick, then `EPID_SCHED_LEVELS - 1` levels of `EPID_SCHED_WHEELN` slots
+ * each covering a whole lower level, cascaded down when their time comes.
+ * The cost of a tick is O(due groups), not O(groups) or O(controllers).
+ *
+ * Gains of every controller must be for its group period, e.g. by
+ * `epid_init_T()` with `sample_period = period * tick period`.
+ * Portable C99, no allocation, usable on embedded targets.
+ */
+
+
+#ifndef EPID_SCHED_H
+#define EPID_SCHED_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_bank.h"
+
+/* Max number of groups of a scheduler, at most 255. */
+#ifndef EPID_SCHED_GROUPS_MAX
+# define EPID_SCHED_GROUPS_MAX (32U)
+#endif
+
+/* Timer wheel geometry: 2^8 slots of the first level, 3 levels of 2^6 slots. */
+#define EPID_SCHED_WHEEL0_BITS (8U)
+#define EPID_SCHED_WHEELN_BITS (6U)
+#define EPID_SCHED_WHEEL0 (1U << EPID_SCHED_WHEEL0_BITS)
+#define EPID_SCHED_WHEELN (1U << EPID_SCHED_WHEELN_BITS)
+#define EPID_SCHED_LEVELS (4U)
+
+/* Max group period in ticks, the range of the wheel: 2^26 - 1. */
+#define EPID_SCHED_PERIOD_MAX \
+    ((UINT32_C(1) << (EPID_SCHED_WHEEL0_BITS \
+                      + ((EPID_SCHED_LEVELS - 1U) * EPID_SCHED_WHEELN_BITS))) - 1U)
+
+/* No group, end of a slot list. */
+#define EPID_SCHED_NONE (0xFFU)
+
+
+typedef struct {
+    size_t begin; /* First controller index in the bank. */
+    size_t n; /* Number of controllers. */
+    uint32_t period; /* Period in ticks. */
+    uint32_t due; /* Tick of the next processing. */
+    uint8_t next; /* Next group in the same wheel slot, or `EPID_SCHED_NONE`. */
+} epid_sched_group_t;
+
+typedef struct {
+    epid_sched_group_t groups[EPID_SCHED_GROUPS_MAX];
+    size_t n_groups;
+
+    /* Wheel slots, heads of lists of groups. */
+    uint8_t wheel0[EPID_SCHED_WHEEL0];
+    uint8_t wheeln[EPID_SCHED_LEVELS - 1U][EPID_SCHED_WHEELN];
+
+    uint32_t now; /* Current tick, counts from zero, wraps around. */
+
+    /* Groups due at the last `epid_sched_tick()`, sorted by `begin`. */
+    uint8_t due[EPID_SCHED_GROUPS_MAX];
+    size_t n_due;
+} epid_sched_t;
+
+
+/**
+ * Initialize an empty `epid_sched_t` context at tick zero.
+ *
+ * sched: Pointer to the `epid_sched_t` context.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_sched_init(epid_sched_t *sched);
+
+
+/**
+ * Add a group of controllers with the same period to a scheduler.
+ * The group is first due at tick `now + phase`, then every `period` ticks.
+ * Use different phases to spread large groups of slow loops over ticks.
+ *
+ * sched: Pointer to the `epid_sched_t` context.
+ * begin: First controller index of the group in the bank.
+ * n: Number of controllers of the group, its range must not overlap other groups.
+ * period: Period in ticks, `1 <= period <= EPID_SCHED_PERIOD_MAX`.
+ * phase: Ticks before the first processing, `phase < period`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` on invalid arguments, overlap or no room for the group.
+ */
+epid_info_t epid_sched_add(epid_sched_t *sched, size_t begin, size_t n,
+                           uint32_t period, uint32_t phase);
+
+
+/**
+ * Collect the groups due at the current tick in `sched->due[]`,
+ * then advance to the next tick.
+ * Called by `epid_sched_p*_step()`, or directly for user processing of the
+ * due ranges (e.g. a pool or custom arrays indexed like the bank).
+ *
+ * sched: Pointer to the `epid_sched_t` context.
+ *
+ * Return: The number of due groups `sched->n_due`.
+ */
+size_t epid_sched_tick(epid_sched_t *sched);
+
+
+/**
+ * Do one tick: Process the due groups as Type-C PI controllers with
+ * `epid_bank_pi_step()` on their ranges of the bank, one call per run of
+ * adjacent due groups. Other controllers are not read nor written.
+ *
+ * sched: Pointer to the `epid_sched_t` context.
+ * bank: Pointer to the `epid_bank_t` context holding all groups.
+ * setpoints: The desired setpoints (SP), indexed as the bank.
+ * measures: Measured process variables (PV), indexed as the bank,
+ *           only read for due controllers.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ */
+void epid_sched_pi_step(epid_sched_t *sched, epid_bank_t *bank,
+                        const float *setpoints, const float *measures,
+                        float out_min, float out_max);
+
+
+/**
+ * Do one tick: Process the due groups as Type-C PID controllers,
+ * see `epid_sched_pi_step()`.
+ * Note: There is NO noise filtering on the derivative-term (`D[k]`).
+ */
+void epid_sched_pid_step(epid_sched_t *sched, epid_bank_t *bank,
+                         const float *setpoints, const float *measures,
+                         float out_min, float out_max);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_SCHED_H */
@@ -0,0 +1,548 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_sim.h"
+#include "pid_flt.h"
+
+#ifdef EPID_SIM_THREADS_AVAILABLE
+# include <pthread.h>
+#endif
+
+/* Kernels are generated from one generic block function, inlined with
+ * constant model and options, so no test is left in the steps loop.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+# define EPID_SIM_INLINE static inline __attribute__((always_inline))
+#else
+# define EPID_SIM_INLINE static inline
+#endif
+
+#define EPID_SIM_L ((size_t)EPID_SIM_LANES)
+
+/* No FP contraction in this file, as "pid_bank.c": The AVX2 and AVX-512F
+ * kernels enable FMA by `target()` attributes, and the fused loops must
+ * round as the banks and plant steps.
+ */
+#if defined(__clang__)
+# pragma STDC FP_CONTRACT OFF
+# pragma clang fp contract(off)
+#elif defined(__GNUC__)
+# pragma GCC optimize("fp-contract=off")
+#else
+# pragma STDC FP_CONTRACT OFF
+#endif
+
+
+/* Arguments of a run, shared by the blocks. */
+typedef struct {
+    const epid_sim_t *sim;
+    const float *setpoints;
+    float out_min;
+    float out_max;
+    uint32_t steps;
+    float *pv_out;
+    float *cv_out;
+    uint32_t countdown; /* Steps before the first telemetry step. */
+    uint32_t head; /* Dead time ring head of the first step. */
+} epid_sim_job_t;
+
+
+epid_info_t epid_sim_init(epid_sim_t *sim, epid_bank_t *bank, epid_lpf_bank_t *lpf,
+                          int model, void *plant, int is_pid, uint32_t decimation)
+{
+    size_t n_plant;
+
+    if ((sim == NULL)
+     || (bank == NULL)
+     || (plant == NULL)
+     || (decimation == 0U)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    switch (model) {
+    case EPID_SIM_FOPDT: n_plant = ((const epid_plant_fopdt_t *)plant)->n; break;
+    case EPID_SIM_SO: n_plant = ((const epid_plant_so_t *)plant)->n; break;
+    case EPID_SIM_INT: n_plant = ((const epid_plant_int_t *)plant)->n; break;
+    case EPID_SIM_THERMAL: n_plant = ((const epid_plant_thermal_t *)plant)->n; break;
+    default: return EPID_ERR_INIT;
+    }
+
+    if ((n_plant != bank->n)
+     || ((lpf != NULL) && (lpf->n != bank->n))
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    sim->bank = bank;
+    sim->lpf = lpf;
+    sim->plant = plant;
+    sim->model = model;
+    sim->is_pid = is_pid;
+    sim->decimation = decimation;
+    sim->tick = 0U;
+    sim->n = bank->n;
+
+    return EPID_ERR_NONE;
+}
+
+
+size_t epid_sim_rows(const epid_sim_t *sim, uint32_t steps)
+{
+    const uint32_t countdown = (uint32_t)((sim->decimation - (sim->tick % sim->decimation)) % sim->decimation);
+
+    return (countdown >= steps) ? 0U : (1U + (size_t)((steps - 1U - countdown) / sim->decimation));
+}
+
+
+/* Run the loops `[base, base + m)` (`m <= EPID_SIM_L`) for all the steps of
+ * a job. Lanes past `m` run on zeros and are not stored.
+ * Same operations order as `epid_lpf_bank_calc()`, `epid_bank_p*_step()`
+ * and `epid_plant_*_step()`.
+ */
+EPID_SIM_INLINE void epid_sim_block(const epid_sim_job_t *job, size_t base, size_t m,
+                                    const int model, const int is_pid, const int has_lpf)
+{
+    const epid_sim_t *sim = job->sim;
+    const size_t n = sim->n;
+    const float out_min = job->out_min;
+    const float out_max = job->out_max;
+
+    /* Controllers */
+    float kp[EPID_SIM_L], ki[EPID_SIM_L], kd[EPID_SIM_L], sp[EPID_SIM_L];
+    float xk_1[EPID_SIM_L], xk_2[EPID_SIM_L], y_out[EPID_SIM_L];
+    /* Filters */
+    float lpf_a[EPID_SIM_L], lpf_y[EPID_SIM_L];
+    /* Plants: Parameters `c0`..`c2` and states `y`, `w` of the model. */
+    float c0[EPID_SIM_L], c1[EPID_SIM_L], c2[EPID_SIM_L], y[EPID_SIM_L], w[EPID_SIM_L];
+    float pv[EPID_SIM_L], u_delayed[EPID_SIM_L];
+
+    const epid_plant_fopdt_t *fopdt = (const epid_plant_fopdt_t *)sim->plant;
+    const epid_plant_so_t *so = (const epid_plant_so_t *)sim->plant;
+    const epid_plant_int_t *integ = (const epid_plant_int_t *)sim->plant;
+    const epid_plant_thermal_t *thermal = (const epid_plant_thermal_t *)sim->plant;
+
+    for (size_t i = 0U; i < EPID_SIM_L; i++) {
+        kp[i] = ki[i] = kd[i] = sp[i] = EPID_FP_ZERO;
+        xk_1[i] = xk_2[i] = y_out[i] = EPID_FP_ZERO;
+        lpf_a[i] = lpf_y[i] = EPID_FP_ZERO;
+        c0[i] = c1[i] = c2[i] = y[i] = w[i] = EPID_FP_ZERO;
+        u_delayed[i] = EPID_FP_ZERO;
+    }
+
+    for (size_t i = 0U; i < m; i++) {
+        const size_t j = base + i;
+
+        kp[i] = sim->bank->kp[j];
+        ki[i] = sim->bank->ki[j];
+        kd[i] = sim->bank->kd[j];
+        sp[i] = job->setpoints[j];
+        xk_1[i] = sim->bank->xk_1[j];
+        xk_2[i] = sim->bank->xk_2[j];
+        y_out[i] = sim->bank->y_out[j];
+
+        if (has_lpf) {
+            lpf_a[i] = sim->lpf->smoothing_factor[j];
+            lpf_y[i] = sim->lpf->y[j];
+        }
+
+        switch (model) {
+        case EPID_SIM_FOPDT:
+            c0[i] = fopdt->a[j];
+            c1[i] = fopdt->gain[j];
+            y[i] = fopdt->y[j];
+            break;
+        case EPID_SIM_SO:
+            c0[i] = so->gain[j];
+            c1[i] = so->c1[j];
+            c2[i] = so->c2[j];
+            y[i] = so->y[j];
+            w[i] = so->w[j];
+            break;
+        case EPID_SIM_INT:
+            c0[i] = integ->k_ts[j];
+            y[i] = integ->y[j];
+            break;
+        default:
+            c0[i] = thermal->k_in[j];
+            c1[i] = thermal->k_loss[j];
+            c2[i] = thermal->ambient[j];
+            y[i] = thermal->y[j];
+            break;
+        }
+    }
+
+    const uint32_t delay = (model == EPID_SIM_FOPDT) ? fopdt->delay : 0U;
+    const size_t stride = EPID_BANK_STRIDE(n);
+    uint32_t head = job->head;
+    uint32_t countdown = job->countdown;
+    size_t row = 0U;
+
+    for (uint32_t k = 0U; k < job->steps; k++) {
+        for (size_t i = 0U; i < EPID_SIM_L; i++) {
+            /* Measurement `x[k]`, filtered. */
+            float measure = y[i];
+
+            pv[i] = measure;
+            if (has_lpf) {
+                const float lpf_prev = lpf_y[i];
+                lpf_y[i] = lpf_prev + lpf_a[i] * (measure - lpf_prev);
+                measure = lpf_y[i];
+            }
+
+            /* Controller, as `epid_bank_p*_step()`. */
+            const float x1 = xk_1[i];
+            float out;
+
+            if (is_pid) {
+                const float dx = x1 - measure;
+                const float d_term = kd[i] * (x1 + dx - xk_2[i]);
+                const float p_term = kp[i] * dx;
+                const float i_term = ki[i] * (sp[i] - measure);
+                out = y_out[i] + (p_term + i_term + d_term);
+                xk_2[i] = x1;
+#ifdef EPID_FEATURE_VALID_FLT
+                /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+                out = epid_flt_nan_keep(out, y_out[i]);
+#endif
+            }
+            else {
+                const float p_term = kp[i] * (x1 - measure);
+                const float i_term = ki[i] * (sp[i] - measure);
+                out = y_out[i] + (p_term + i_term);
+#ifdef EPID_FEATURE_VALID_FLT
+                /* A NaN term always gives a NaN `y[k]`, keep `y[k-1]`. */
+                out = epid_flt_nan_keep(out, y_out[i]);
+#endif
+            }
+            xk_1[i] = measure;
+
+            if (out > out_max) {
+                out = out_max;
+            }
+            else if (out < out_min) {
+                out = out_min;
+            }
+            y_out[i] = out;
+        }
+
+        /* Plant, as `epid_plant_*_step()`. */
+        if ((model == EPID_SIM_FOPDT) && (delay != 0U)) {
+            float *slot = fopdt->delay_line + (((size_t)head * stride) + base);
+
+            for (size_t i = 0U; i < m; i++) {
+                u_delayed[i] = slot[i];
+                slot[i] = y_out[i];
+            }
+            head = ((head + 1U) == delay) ? 0U : (head + 1U);
+        }
+
+        for (size_t i = 0U; i < EPID_SIM_L; i++) {
+            const float u = y_out[i];
+
+            switch (model) {
+            case EPID_SIM_FOPDT: {
+                const float u_k = (delay != 0U) ? u_delayed[i] : u;
+                y[i] = y[i] + c0[i] * ((c1[i] * u_k) - y[i]);
+                break;
+            }
+            case EPID_SIM_SO: {
+                const float w_next = w[i] + (c1[i] * ((c0[i] * u) - y[i])) - (c2[i] * w[i]);
+                w[i] = w_next;
+                y[i] = y[i] + w_next;
+                break;
+            }
+            case EPID_SIM_INT:
+                y[i] = y[i] + (c0[i] * u);
+                break;
+            default: {
+                const float power = (u > EPID_FP_ZERO) ? u : EPID_FP_ZERO;
+                y[i] = y[i] + (c0[i] * power) - (c1[i] * (y[i] - c2[i]));
+                break;
+            }
+            }
+        }
+
+        /* Decimated telemetry. */
+        if (countdown == 0U) {
+            countdown = sim->decimation;
+            if (job->pv_out != NULL) {
+                for (size_t i = 0U; i < m; i++) {
+                    job->pv_out[(row * n) + base + i] = pv[i];
+                }
+            }
+            if (job->cv_out != NULL) {
+                for (size_t i = 0U; i < m; i++) {
+                    job->cv_out[(row * n) + base + i] = y_out[i];
+                }
+            }
+            row++;
+        }
+        countdown--;
+    }
+
+    for (size_t i = 0U; i < m; i++) {
+        const size_t j = base + i;
+
+        sim->bank->xk_1[j] = xk_1[i];
+        sim->bank->xk_2[j] = xk_2[i];
+        sim->bank->y_out[j] = y_out[i];
+
+        if (has_lpf) {
+            sim->lpf->y[j] = lpf_y[i];
+        }
+
+        switch (model) {
+        case EPID_SIM_FOPDT:
+            fopdt->y[j] = y[i];
+            break;
+        case EPID_SIM_SO:
+            so->y[j] = y[i];
+            so->w[j] = w[i];
+            break;
+        case EPID_SIM_INT:
+            integ->y[j] = y[i];
+            break;
+        default:
+            thermal->y[j] = y[i];
+            break;
+        }
+    }
+}
+
+
+typedef void (*epid_sim_kernel_t)(const epid_sim_job_t *job, size_t base, size_t m);
+
+#define EPID_SIM_KERNEL(isa, attr, name, model, is_pid, has_lpf) \
+static attr void epid_sim_##name##_##isa(const epid_sim_job_t *job, size_t base, size_t m) \
+{ \
+    epid_sim_block(job, base, m, (model), (is_pid), (has_lpf)); \
+}
+
+/* All the kernels of an instruction set, and their table indexed by
+ * `[model][is_pid][has_lpf]`. The steps loops over the lanes are vectorized
+ * by the compiler for the instruction set of `attr`; Without fused
+ * multiply-add (no FP contraction, see <pid_bank.h>), so results do not
+ * depend on the instruction set.
+ */
+#define EPID_SIM_KERNELS(isa, attr) \
+EPID_SIM_KERNEL(isa, attr, fopdt_pi, EPID_SIM_FOPDT, 0, 0) \
+EPID_SIM_KERNEL(isa, attr, fopdt_pi_lpf, EPID_SIM_FOPDT, 0, 1) \
+EPID_SIM_KERNEL(isa, attr, fopdt_pid, EPID_SIM_FOPDT, 1, 0) \
+EPID_SIM_KERNEL(isa, attr, fopdt_pid_lpf, EPID_SIM_FOPDT, 1, 1) \
+EPID_SIM_KERNEL(isa, attr, so_pi, EPID_SIM_SO, 0, 0) \
+EPID_SIM_KERNEL(isa, attr, so_pi_lpf, EPID_SIM_SO, 0, 1) \
+EPID_SIM_KERNEL(isa, attr, so_pid, EPID_SIM_SO, 1, 0) \
+EPID_SIM_KERNEL(isa, attr, so_pid_lpf, EPID_SIM_SO, 1, 1) \
+EPID_SIM_KERNEL(isa, attr, int_pi, EPID_SIM_INT, 0, 0) \
+EPID_SIM_KERNEL(isa, attr, int_pi_lpf, EPID_SIM_INT, 0, 1) \
+EPID_SIM_KERNEL(isa, attr, int_pid, EPID_SIM_INT, 1, 0) \
+EPID_SIM_KERNEL(isa, attr, int_pid_lpf, EPID_SIM_INT, 1, 1) \
+EPID_SIM_KERNEL(isa, attr, thermal_pi, EPID_SIM_THERMAL, 0, 0) \
+EPID_SIM_KERNEL(isa, attr, thermal_pi_lpf, EPID_SIM_THERMAL, 0, 1) \
+EPID_SIM_KERNEL(isa, attr, thermal_pid, EPID_SIM_THERMAL, 1, 0) \
+EPID_SIM_KERNEL(isa, attr, thermal_pid_lpf, EPID_SIM_THERMAL, 1, 1) \
+\
+static const epid_sim_kernel_t epid_sim_kernels_##isa[4][2][2] = { \
+    {{epid_sim_fopdt_pi_##isa, epid_sim_fopdt_pi_lpf_##isa}, \
+     {epid_sim_fopdt_pid_##isa, epid_sim_fopdt_pid_lpf_##isa}}, \
+    {{epid_sim_so_pi_##isa, epid_sim_so_pi_lpf_##isa}, \
+     {epid_sim_so_pid_##isa, epid_sim_so_pid_lpf_##isa}}, \
+    {{epid_sim_int_pi_##isa, epid_sim_int_pi_lpf_##isa}, \
+     {epid_sim_int_pid_##isa, epid_sim_int_pid_lpf_##isa}}, \
+    {{epid_sim_thermal_pi_##isa, epid_sim_thermal_pi_lpf_##isa}, \
+     {epid_sim_thermal_pid_##isa, epid_sim_thermal_pid_lpf_##isa}} \
+};
+
+EPID_SIM_KERNELS(base, )
+
+#if defined(EPID_FEATURE_SIMD) \
+ && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)) \
+ && (defined(__GNUC__) || defined(__clang__))
+# define EPID_SIM_X86_AVX 1
+EPID_SIM_KERNELS(avx2, __attribute__((target("avx2"))))
+EPID_SIM_KERNELS(avx512f, __attribute__((target("avx512f"))))
+#endif
+
+
+/* Kernels table of the CPU, `NULL` until the first dispatch. */
+static const epid_sim_kernel_t (*epid_sim_kernels)[2][2] = NULL;
+
+
+/* Select the kernels once by the CPU features, as `epid_bank_p*_step()`.
+ * Racing first calls from many threads store the same value.
+ */
+static void epid_sim_dispatch(void)
+{
+    const epid_sim_kernel_t (*kernels)[2][2] = epid_sim_kernels_base;
+
+#if defined(EPID_SIM_X86_AVX)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        kernels = epid_sim_kernels_avx512f;
+    }
+    else if (__builtin_cpu_supports("avx2")) {
+        kernels = epid_sim_kernels_avx2;
+    }
+#endif
+
+    epid_sim_kernels = kernels;
+}
+
+
+/* Number of blocks of `EPID_SIM_LANES` loops. */
+static size_t epid_sim_blocks(const epid_sim_t *sim)
+{
+    return (sim->n + (EPID_SIM_L - 1U)) / EPID_SIM_L;
+}
+
+
+/* Run the blocks `[begin, end)` of a job. */
+static void epid_sim_range(const epid_sim_job_t *job, size_t begin, size_t end)
+{
+    const epid_sim_t *sim = job->sim;
+    const epid_sim_kernel_t kernel =
+        epid_sim_kernels[sim->model][sim->is_pid != 0][sim->lpf != NULL];
+
+    for (size_t b = begin; b < end; b++) {
+        const size_t base = b * EPID_SIM_L;
+        const size_t m = ((sim->n - base) < EPID_SIM_L) ? (sim->n - base) : EPID_SIM_L;
+
+        kernel(job, base, m);
+    }
+}
+
+
+/* Set a job for the next `steps` steps. */
+static void epid_sim_job(epid_sim_job_t *job, const epid_sim_t *sim,
+                         const float *setpoints, float out_min, float out_max,
+                         uint32_t steps, float *pv_out, float *cv_out)
+{
+    job->sim = sim;
+    job->setpoints = setpoints;
+    job->out_min = out_min;
+    job->out_max = out_max;
+    job->steps = steps;
+    job->pv_out = pv_out;
+    job->cv_out = cv_out;
+    job->countdown = (uint32_t)((sim->decimation - (sim->tick % sim->decimation)) % sim->decimation);
+    job->head = (sim->model == EPID_SIM_FOPDT) ? ((const epid_plant_fopdt_t *)sim->plant)->head : 0U;
+}
+
+
+/* Advance the shared states after a job. */
+static void epid_sim_advance(epid_sim_t *sim, uint32_t steps)
+{
+    if (sim->model == EPID_SIM_FOPDT) {
+        epid_plant_fopdt_t *fopdt = (epid_plant_fopdt_t *)sim->plant;
+
+        if (fopdt->delay != 0U) {
+            fopdt->head = (uint32_t)(((uint64_t)fopdt->head + steps) % fopdt->delay);
+        }
+    }
+    sim->tick += steps;
+}
+
+
+void epid_sim_run(epid_sim_t *sim, const float *setpoints,
+                  float out_min, float out_max, uint32_t steps,
+                  float *pv_out, float *cv_out)
+{
+    epid_sim_job_t job;
+
+    if (epid_sim_kernels == NULL) {
+        epid_sim_dispatch();
+    }
+
+    epid_sim_job(&job, sim, setpoints, out_min, out_max, steps, pv_out, cv_out);
+    epid_sim_range(&job, 0U, epid_sim_blocks(sim));
+    epid_sim_advance(sim, steps);
+}
+
+
+#ifdef EPID_SIM_THREADS_AVAILABLE
+typedef struct {
+    const epid_sim_job_t *job;
+    size_t begin;
+    size_t end;
+} epid_sim_part_t;
+
+
+static void *epid_sim_thread(void *arg)
+{
+    const epid_sim_part_t *part = (const epid_sim_part_t *)arg;
+
+    epid_sim_range(part->job, part->begin, part->end);
+    return NULL;
+}
+
+
+epid_info_t epid_sim_run_mt(epid_sim_t *sim, const float *setpoints,
+                            float out_min, float out_max, uint32_t steps,
+                            float *pv_out, float *cv_out, size_t n_threads)
+{
+    pthread_t threads[EPID_SIM_THREADS_MAX];
+    int started[EPID_SIM_THREADS_MAX];
+    epid_sim_part_t parts[EPID_SIM_THREADS_MAX];
+    epid_sim_job_t job;
+
+    if ((n_threads == 0U) || (n_threads > EPID_SIM_THREADS_MAX)) {
+        return EPID_ERR_INIT;
+    }
+
+    const size_t blocks = epid_sim_blocks(sim);
+
+    if (epid_sim_kernels == NULL) {
+        epid_sim_dispatch();
+    }
+    epid_sim_job(&job, sim, setpoints, out_min, out_max, steps, pv_out, cv_out);
+
+    /* Contiguous ranges of blocks, part 0 is run by the calling thread. */
+    for (size_t t = 0U; t < n_threads; t++) {
+        parts[t].job = &job;
+        parts[t].begin = (blocks * t) / n_threads;
+        parts[t].end = (blocks * (t + 1U)) / n_threads;
+        started[t] = (t != 0U) && (parts[t].begin != parts[t].end)
+                  && (pthread_create(&threads[t], NULL, epid_sim_thread, &parts[t]) == 0);
+    }
+
+    for (size_t t = 0U; t < n_threads; t++) {
+        if (!started[t]) {
+            epid_sim_range(&job, parts[t].begin, parts[t].end);
+        }
+    }
+    for (size_t t = 1U; t < n_threads; t++) {
+        if (started[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+
+    epid_sim_advance(sim, steps);
+
+    return EPID_ERR_NONE;
+}
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
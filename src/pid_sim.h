@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID simulation engine: Faster than real-time closed loops, a plant model
+ * (<pid_plant.h>), an optional measurement LPF and a controller (<pid_bank.h>)
+ * per loop, advanced by many steps in one call.
+ *
+ * Loops are processed by blocks of `EPID_SIM_LANES`: The states of a block are
+ * loaded once into local arrays (registers and L1 cache), the block is run for
+ * all the steps by one fused kernel, and the states are stored back once.
+ * Only decimated telemetry (PV and CV every `decimation` steps) is written.
+ *
+ * Every step of a loop is the same as, and bit for bit identical to:
+ *
+ *     measure = plant.y[i];
+ *     epid_lpf_bank_calc(&lpf, plant.y, n); measure = lpf.y[i]; (with a LPF)
+ *     epid_bank_pid_step(&bank, setpoints, measures, out_min, out_max, n);
+ *     epid_plant_*_step(&plant, bank.y_out);
+ *
+ * Loops are independent, so blocks can be run by many threads:
+ * `epid_sim_run_mt()` on POSIX hosts (`EPID_SIM_THREADS_AVAILABLE`).
+ */
+
+
+#ifndef EPID_SIM_H
+#define EPID_SIM_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_bank.h"
+#include "pid_plant.h"
+
+/* Threads runner: POSIX hosts, define `EPID_SIM_NO_THREADS` to turn off
+ * (then "pid_sim.c" needs no `-pthread`).
+ */
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(EPID_SIM_NO_THREADS)
+# define EPID_SIM_THREADS_AVAILABLE 1
+#endif
+
+/* Loops per block of the fused kernels, a multiple of `EPID_BANK_LANES`:
+ * Independent vectors of a step hide the latency of the step dependencies.
+ */
+#ifndef EPID_SIM_LANES
+# define EPID_SIM_LANES (64U)
+#endif
+
+/* Max number of threads of `epid_sim_run_mt()`. */
+#ifndef EPID_SIM_THREADS_MAX
+# define EPID_SIM_THREADS_MAX (64U)
+#endif
+
+/* Plant models, `plant` of `epid_sim_init()` */
+#define EPID_SIM_FOPDT (0) /* `epid_plant_fopdt_t` */
+#define EPID_SIM_SO (1) /* `epid_plant_so_t` */
+#define EPID_SIM_INT (2) /* `epid_plant_int_t` */
+#define EPID_SIM_THERMAL (3) /* `epid_plant_thermal_t` */
+
+
+typedef struct {
+    epid_bank_t *bank; /* Controllers. */
+    epid_lpf_bank_t *lpf; /* Measurements filters, or `NULL`. */
+    void *plant; /* `epid_plant_*_t` of `model`. */
+    int model; /* `EPID_SIM_*` plant model. */
+    int is_pid; /* Type-C PID if non-zero, else PI controllers. */
+
+    uint32_t decimation; /* Telemetry of 1 step in `decimation`. */
+    uint64_t tick; /* Steps done. */
+    size_t n; /* Number of loops. */
+} epid_sim_t;
+
+
+/**
+ * Initialize a simulation of `n` closed loops over initialized and set
+ * contexts of the same number of loops, used in place (not copied).
+ *
+ * sim: Pointer to the `epid_sim_t` context.
+ * bank: Controllers bank, see `epid_bank_init()`.
+ * lpf: Measurements LPF bank, see `epid_lpf_bank_init()`, or `NULL` for none.
+ * model: Plant model, `EPID_SIM_FOPDT`, `EPID_SIM_SO`, `EPID_SIM_INT`
+ *        or `EPID_SIM_THERMAL`.
+ * plant: Pointer to the `epid_plant_*_t` context of `model`.
+ * is_pid: Type-C PID controllers if non-zero, else Type-C PI.
+ * decimation: Telemetry of the steps `k` of `tick % decimation == 0`,
+ *             `decimation >= 1`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred, or on different
+ *     numbers of loops.
+ */
+epid_info_t epid_sim_init(epid_sim_t *sim, epid_bank_t *bank, epid_lpf_bank_t *lpf,
+                          int model, void *plant, int is_pid, uint32_t decimation);
+
+
+/**
+ * Get the number of telemetry rows of the next `steps` steps.
+ *
+ * sim: Pointer to the `epid_sim_t` context.
+ * steps: Number of steps.
+ *
+ * Return: Number of rows written by `epid_sim_run*()` for `steps`.
+ */
+size_t epid_sim_rows(const epid_sim_t *sim, uint32_t steps);
+
+
+/**
+ * Run all loops for `steps` steps, with constant setpoints.
+ * Telemetry rows are sample-major: `pv_out[r * n + i]` is the measurement
+ * (plant output, before the LPF) of loop `i` at the telemetry step `r`,
+ * as the columns of a trace file (<pid_trace.h>).
+ *
+ * sim: Pointer to the `epid_sim_t` context.
+ * setpoints: The desired setpoints (SP), `n` values.
+ * out_min: Min output from controllers.
+ * out_max: Max output from controllers.
+ * steps: Number of steps.
+ * pv_out: Measurements (PV), `epid_sim_rows(sim, steps) * n` values, or `NULL`.
+ * cv_out: Controllers outputs (CV), as `pv_out`, or `NULL`.
+ */
+void epid_sim_run(epid_sim_t *sim, const float *setpoints,
+                  float out_min, float out_max, uint32_t steps,
+                  float *pv_out, float *cv_out);
+
+
+#ifdef EPID_SIM_THREADS_AVAILABLE
+/**
+ * Same as `epid_sim_run()`, by `n_threads` threads (the calling thread and
+ * `n_threads - 1` started threads) running contiguous ranges of blocks;
+ * The ranges of threads that could not be started are run by the calling
+ * thread. Results are bit for bit identical for any number of threads.
+ *
+ * n_threads: Number of threads, `1 <= n_threads <= EPID_SIM_THREADS_MAX`.
+ * Other arguments: See `epid_sim_run()`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if `n_threads` is out of range (no step is done).
+ */
+epid_info_t epid_sim_run_mt(epid_sim_t *sim, const float *setpoints,
+                            float out_min, float out_max, uint32_t steps,
+                            float *pv_out, float *cv_out, size_t n_threads);
+#endif
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_SIM_H */
@@ -0,0 +1,217 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_telem.h"
+
+/* Built as C99 with `EPID_FEATURE_ATOMICS`: Empty, see <pid_telem.h>. */
+#ifdef EPID_TELEM_AVAILABLE
+
+/* Indexes: Relaxed loads of the own index, acquire loads of the other side
+ * index, release stores, so records are ordered by the index accesses only.
+ */
+#ifdef EPID_TELEM_ATOMICS
+_Static_assert(sizeof(epid_telem_index_t) == sizeof(uint32_t), "Layout of epid_telem_t");
+
+# define EPID_TELEM_LOAD(p) atomic_load_explicit((p), memory_order_relaxed)
+# define EPID_TELEM_LOAD_ACQUIRE(p) atomic_load_explicit((p), memory_order_acquire)
+# define EPID_TELEM_STORE(p, v) atomic_store_explicit((p), (v), memory_order_relaxed)
+# define EPID_TELEM_STORE_RELEASE(p, v) atomic_store_explicit((p), (v), memory_order_release)
+# define EPID_TELEM_INDEX_MASK (UINT32_C(0xFFFFFFFF))
+#else
+# if defined(__GNUC__) || defined(__clang__)
+#  define EPID_TELEM_BARRIER() __sync_synchronize()
+# else
+/* `volatile` accesses are not reordered between themselves. */
+#  define EPID_TELEM_BARRIER() ((void)0)
+# endif
+# define EPID_TELEM_LOAD(p) (*(p))
+# define EPID_TELEM_LOAD_ACQUIRE(p) epid_telem_load_acquire(p)
+# define EPID_TELEM_STORE(p, v) (*(p) = (v))
+# define EPID_TELEM_STORE_RELEASE(p, v) epid_telem_store_release((p), (v))
+# define EPID_TELEM_INDEX_MASK (UINT32_C(0xFF))
+
+static inline uint32_t epid_telem_load_acquire(const epid_telem_index_t *p)
+{
+    const uint32_t v = *p;
+    EPID_TELEM_BARRIER();
+    return v;
+}
+
+static inline void epid_telem_store_release(epid_telem_index_t *p, uint32_t v)
+{
+    EPID_TELEM_BARRIER();
+    *p = (uint8_t)v;
+}
+#endif
+
+/* Free-running indexes: Records in use are `(head - tail) & INDEX_MASK`. */
+#define EPID_TELEM_USED(head, tail) (((uint32_t)(head) - (uint32_t)(tail)) & EPID_TELEM_INDEX_MASK)
+
+
+/* Copy a record field by field, `volatile` records have no struct copy in C++. */
+static inline void epid_telem_copy(EPID_TELEM_Q epid_telem_rec_t *dst,
+                                   const EPID_TELEM_Q epid_telem_rec_t *src)
+{
+    dst->tick = src->tick;
+    dst->setpoint = src->setpoint;
+    dst->measure = src->measure;
+    dst->p_term = src->p_term;
+    dst->i_term = src->i_term;
+    dst->d_term = src->d_term;
+    dst->y_out = src->y_out;
+    dst->flags = src->flags;
+}
+
+
+epid_info_t epid_telem_init(epid_telem_t *ring, epid_telem_rec_t *recs, uint32_t cap)
+{
+    if ((ring == NULL)
+     || (recs == NULL)
+     || (cap < 2U)
+     || (cap > EPID_TELEM_CAP_MAX)
+     || ((cap & (cap - 1U)) != 0U) /* Power of 2. */
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    ring->recs = recs;
+    ring->mask = cap - 1U;
+    ring->tail_cache = 0U;
+    ring->head_cache = 0U;
+    EPID_TELEM_STORE(&ring->dropped, 0U);
+    EPID_TELEM_STORE(&ring->tail, 0U);
+    EPID_TELEM_STORE_RELEASE(&ring->head, 0U);
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Producer: The slot of the next record, or `NULL` if the ring is full (counted). */
+static inline EPID_TELEM_Q epid_telem_rec_t *epid_telem_slot(epid_telem_t *ring, uint32_t head)
+{
+    const uint32_t cap = ring->mask + 1U;
+
+    if (EPID_TELEM_USED(head, ring->tail_cache) >= cap) {
+        /* Full as last seen: Read the consumer line only now.
+         * Acquire: The consumer reads of the freed slots are done.
+         */
+        ring->tail_cache = (uint32_t)EPID_TELEM_LOAD_ACQUIRE(&ring->tail);
+
+        if (EPID_TELEM_USED(head, ring->tail_cache) >= cap) {
+            EPID_TELEM_STORE(&ring->dropped, (uint32_t)EPID_TELEM_LOAD(&ring->dropped) + 1U);
+            return NULL;
+        }
+    }
+
+    return &ring->recs[head & ring->mask];
+}
+
+
+/* Producer: Publish the record written at `head`. */
+static inline void epid_telem_commit(epid_telem_t *ring, uint32_t head)
+{
+    /* Release: The record is written before the index. */
+    EPID_TELEM_STORE_RELEASE(&ring->head, (head + 1U) & EPID_TELEM_INDEX_MASK);
+}
+
+
+int epid_telem_push(epid_telem_t *ring, uint32_t tick, float setpoint, const epid_t *ctx)
+{
+    const uint32_t head = (uint32_t)EPID_TELEM_LOAD(&ring->head); /* Only producer. */
+    EPID_TELEM_Q epid_telem_rec_t *rec = epid_telem_slot(ring, head);
+
+    if (rec == NULL) {
+        return 0;
+    }
+
+    rec->tick = tick;
+    rec->setpoint = setpoint;
+    rec->measure = ctx->xk_1; /* `x[k]` of the tick, after `epid_p*_calc()`. */
+    rec->p_term = ctx->p_term;
+    rec->i_term = ctx->i_term;
+    rec->d_term = ctx->d_term;
+    rec->y_out = ctx->y_out;
+    rec->flags = (uint32_t)ctx->flags;
+    epid_telem_commit(ring, head);
+
+    return 1;
+}
+
+
+int epid_telem_push_rec(epid_telem_t *ring, const epid_telem_rec_t *rec)
+{
+    const uint32_t head = (uint32_t)EPID_TELEM_LOAD(&ring->head); /* Only producer. */
+    EPID_TELEM_Q epid_telem_rec_t *slot = epid_telem_slot(ring, head);
+
+    if (slot == NULL) {
+        return 0;
+    }
+
+    epid_telem_copy(slot, rec);
+    epid_telem_commit(ring, head);
+
+    return 1;
+}
+
+
+uint32_t epid_telem_pop(epid_telem_t *ring, epid_telem_rec_t *out, uint32_t max)
+{
+    const uint32_t tail = (uint32_t)EPID_TELEM_LOAD(&ring->tail); /* Only consumer. */
+    uint32_t n = EPID_TELEM_USED(ring->head_cache, tail);
+
+    if (n < max) {
+        /* Not enough as last seen: Read the producer line only now.
+         * Acquire: The producer writes of the records are done.
+         */
+        ring->head_cache = (uint32_t)EPID_TELEM_LOAD_ACQUIRE(&ring->head);
+        n = EPID_TELEM_USED(ring->head_cache, tail);
+    }
+    n = (n < max) ? n : max;
+
+    for (uint32_t i = 0U; i < n; i++) {
+        epid_telem_copy(&out[i], &ring->recs[(tail + i) & ring->mask]);
+    }
+
+    if (n != 0U) {
+        /* Release: The reads are done before the slots are freed. */
+        EPID_TELEM_STORE_RELEASE(&ring->tail, (tail + n) & EPID_TELEM_INDEX_MASK);
+    }
+
+    return n;
+}
+
+
+uint32_t epid_telem_dropped(const epid_telem_t *ring)
+{
+    return (uint32_t)EPID_TELEM_LOAD(&ring->dropped);
+}
+
+
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_telem_unavailable_t;
+#endif /* EPID_TELEM_AVAILABLE */
+
+
+#ifdef __cplusplus
+}
+#endif
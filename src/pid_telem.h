@@ -0,0 +1,183 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID telemetry: A single-producer/single-consumer (SPSC) lock-free ring of
+ * per-tick controller records {tick, SP, PV, P, I, D, CV, flags}.
+ *
+ * The control step (producer, in an ISR or a real-time thread) pushes one
+ * record per tick; another thread or the main loop (consumer) pops them by
+ * batches and writes them out (console, file, network), so tracing costs the
+ * control step a record copy, not a formatted print.
+ *
+ * - Records storage is given by the user, a power of 2 records; No allocation.
+ * - Never blocks: If the ring is full, the record is dropped and counted.
+ * - Producer and consumer indexes are in separate cache lines; each side keeps
+ *   a cached copy of the other index, so a push or a pop of a batch usually
+ *   reads no cache line written by the other side.
+ *
+ * - `EPID_FEATURE_ATOMICS` (see <pid.h>): Atomic indexes, for multi-core
+ *   hosts; "pid_telem.c" is then built as C11 with <stdatomic.h>, else
+ *   (e.g. `-std=c99`) it is empty: `EPID_TELEM_AVAILABLE` is defined if the
+ *   functions are built in this unit.
+ * - Else: `volatile` 8-bits indexes (single byte accesses) and records, with
+ *   a full barrier on GCC/Clang, for single-core MCUs (ISR and main loop);
+ *   The capacity is then at most `EPID_TELEM_CAP_MAX` (128) records.
+ */
+
+
+#ifndef EPID_TELEM_H
+#define EPID_TELEM_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+#ifdef EPID_FEATURE_ATOMICS
+# if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) \
+  && !defined(__STDC_NO_ATOMICS__) && !defined(__cplusplus)
+#  define EPID_TELEM_ATOMICS 1 /* Atomic accesses in this unit. */
+#  define EPID_TELEM_AVAILABLE 1
+#  include <stdatomic.h>
+typedef _Atomic uint32_t epid_telem_index_t;
+typedef _Atomic uint32_t epid_telem_count_t;
+# else
+/* Same layout, for units which only hold rings (e.g. C++). */
+typedef volatile uint32_t epid_telem_index_t;
+typedef volatile uint32_t epid_telem_count_t;
+# endif
+# define EPID_TELEM_CAP_MAX (UINT32_C(1) << 31)
+# define EPID_TELEM_Q /* Records qualifier. */
+#else
+# define EPID_TELEM_AVAILABLE 1
+typedef volatile uint8_t epid_telem_index_t;
+typedef volatile uint32_t epid_telem_count_t;
+# define EPID_TELEM_CAP_MAX (UINT32_C(1) << 7)
+# define EPID_TELEM_Q volatile
+#endif
+
+/* Cache line size in bytes, for the indexes separation. */
+#ifndef EPID_TELEM_LINE
+# define EPID_TELEM_LINE (64U)
+#endif
+
+/* Alignment attribute for statically allocated arrays, as in <pid_bank.h>. */
+#ifndef EPID_ALIGNED
+# if defined(__GNUC__) || defined(__clang__)
+#  define EPID_ALIGNED(x) __attribute__((aligned(x)))
+# elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#  define EPID_ALIGNED(x) _Alignas(x)
+# else
+#  define EPID_ALIGNED(x)
+# endif
+#endif
+
+
+typedef struct {
+    uint32_t tick; /* Tick number, given by the producer. */
+    float setpoint; /* The setpoint (SP). */
+    float measure; /* The process variable (PV). */
+    float p_term; /* `P[k]` */
+    float i_term; /* `I[k]` */
+    float d_term; /* `D[k]` */
+    float y_out; /* The controller output (CV). */
+    uint32_t flags; /* `EPID_FLAG_*` bits of the controller. */
+} epid_telem_rec_t; /* 32 bytes, 2 records per cache line. */
+
+typedef struct {
+    /* Producer cache line. */
+    EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_index_t head; /* Next record to write. */
+    uint32_t tail_cache; /* Last `tail` read by the producer. */
+    epid_telem_count_t dropped; /* Records dropped on a full ring. */
+
+    /* Consumer cache line. */
+    EPID_ALIGNED(EPID_TELEM_LINE) epid_telem_index_t tail; /* Next record to read. */
+    uint32_t head_cache; /* Last `head` read by the consumer. */
+
+    /* Read-only after init, read by both sides. */
+    EPID_ALIGNED(EPID_TELEM_LINE) EPID_TELEM_Q epid_telem_rec_t *recs;
+    uint32_t mask; /* Capacity - 1. */
+} epid_telem_t;
+
+
+/**
+ * Initialize an empty ring over a records array, before use by both sides.
+ *
+ * ring: Pointer to the `epid_telem_t` context, best aligned to `EPID_TELEM_LINE`.
+ * recs: Records storage, `cap` values, best aligned to `EPID_TELEM_LINE`.
+ * cap: Capacity in records, a power of 2, `2 <= cap <= EPID_TELEM_CAP_MAX`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if initialization error occurred.
+ */
+epid_info_t epid_telem_init(epid_telem_t *ring, epid_telem_rec_t *recs, uint32_t cap);
+
+
+/**
+ * Producer: Push a record of a controller after its `epid_p*_sum()`, where
+ * `x[k-1]` of the context is the measure (PV) of the tick. Wait-free.
+ *
+ * ring: Pointer to the `epid_telem_t` context.
+ * tick: Tick number.
+ * setpoint: The setpoint (SP) of the tick.
+ * ctx: Pointer to the `epid_t` context, only read.
+ *
+ * Return: Non-zero if pushed, zero if dropped (ring full, counted).
+ */
+int epid_telem_push(epid_telem_t *ring, uint32_t tick, float setpoint, const epid_t *ctx);
+
+
+/**
+ * Producer: Push a record, e.g. of a bank controller. Wait-free.
+ *
+ * ring: Pointer to the `epid_telem_t` context.
+ * rec: Pointer to the record, copied.
+ *
+ * Return: See `epid_telem_push()`.
+ */
+int epid_telem_push_rec(epid_telem_t *ring, const epid_telem_rec_t *rec);
+
+
+/**
+ * Consumer: Pop the oldest records, up to `max`. Wait-free.
+ *
+ * ring: Pointer to the `epid_telem_t` context.
+ * out: Destination of the records, `max` values.
+ * max: Max number of records to pop.
+ *
+ * Return: The number of popped records, zero if the ring is empty.
+ */
+uint32_t epid_telem_pop(epid_telem_t *ring, epid_telem_rec_t *out, uint32_t max);
+
+
+/**
+ * Get the number of records dropped since init, from any side.
+ *
+ * ring: Pointer to the `epid_telem_t` context.
+ */
+uint32_t epid_telem_dropped(const epid_telem_t *ring);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_TELEM_H */
@@ -0,0 +1,525 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+/**
+ * EPID type-generic template, included once per precision with:
+ *   - `EPID_TMPL_NAME(name)`: Symbols name, e.g. `epid_d_##name`.
+ *   - `EPID_TMPL_STORE`: Storage type of contexts fields, e.g. `double`.
+ *   - `EPID_TMPL_REAL`: Arithmetic and arguments type, e.g. `double`.
+ *   - `EPID_TMPL_UINT`, `EPID_TMPL_ABS_MASK`, `EPID_TMPL_EXP_MASK`:
+ *     Unsigned integer type of the size of `EPID_TMPL_REAL`, and the
+ *     magnitude and exponent bit masks of its IEEE-754 format, for the
+ *     bit-pattern NaN/INF tests (as in "pid.c", they work with `-ffast-math`).
+ *   - `EPID_TMPL_DECLARE` or `EPID_TMPL_DEFINE`: Emit the types and
+ *     prototypes, or the functions definitions.
+ *   - `EPID_TMPL_API` (optional): Storage class of the functions, as
+ *     `EPID_API` of <pid.h> for the header-only mode.
+ * All these macros are undefined at the end of this file.
+ *
+ * "pid.c" defines the `float` API of <pid.h> (`epid_t`, `epid_*()`) from
+ * this file, with its own types and prototypes, so all the precisions share
+ * one source; Generated types have the field order of `epid_t`, and the
+ * functions its checks, sticky `EPID_FLAG_*` bits and cached sample period,
+ * see <pid.h> for documentation:
+ * `*_t`, `*_lpf_t`, `*_init()`, `*_init_T()`, `*_set_gains()`,
+ * `*_set_gains_T()`, `*_pi_calc()`, `*_pid_calc()`, `*_pi_sum()`,
+ * `*_pid_sum()`, `*_pi_step()`, `*_pid_step()`, `*_util_ilim()`,
+ * `*_util_lpf_init()`, `*_util_lpf_calc()`.
+ * `extras/testing/test_tmpl.c` compares the builds.
+ */
+
+/* No include guard, this file is included once per instantiation. */
+
+#ifndef EPID_TMPL_API
+# define EPID_TMPL_API
+#endif
+
+#define EPID_TMPL_S EPID_TMPL_STORE
+#define EPID_TMPL_R EPID_TMPL_REAL
+#define EPID_TMPL_U EPID_TMPL_UINT
+#define EPID_TMPL_CTX EPID_TMPL_NAME(t)
+#define EPID_TMPL_LPF EPID_TMPL_NAME(lpf_t)
+
+
+#ifdef EPID_TMPL_DECLARE
+
+typedef struct {
+    /* Controller settings. */
+    EPID_TMPL_S kp; /* Gain constant `Kp` for P-term. */
+    EPID_TMPL_S ki; /* Gain constant `Ki` for I-term. */
+    EPID_TMPL_S kd; /* Gain constant `Kd` for D-term. */
+
+    /* Controller states. */
+    EPID_TMPL_S xk_1; /* Physical measurement `PV[k-1]`. */
+    EPID_TMPL_S xk_2; /* Physical measurement `PV[k-2]`. */
+
+    /* Controller outputs. */
+    EPID_TMPL_S p_term; /* The P-term calculated value `P[k]`. */
+    EPID_TMPL_S i_term; /* The I-term calculated value `I[k]`. */
+    EPID_TMPL_S d_term; /* The D-term calculated value `D[k]`. */
+
+    EPID_TMPL_S y_out; /* The controller output (CV). `y[k] = y[k-1] + delta[k]` */
+
+    epid_flags_t flags; /* Sticky `EPID_FLAG_*` bits, write zero to clear. */
+
+    /* Cached by `*_init_T()` for `*_set_gains_T()`, zero if unknown. */
+    EPID_TMPL_R sample_period; /* `Ts` */
+    EPID_TMPL_R sample_rate; /* `1 / Ts` */
+} EPID_TMPL_CTX;
+
+typedef struct {
+    EPID_TMPL_S smoothing_factor; /* Filter's smoothing factor. `0 <= a <= 1` */
+    EPID_TMPL_S y; /* `y[k] = FILTER(x[k])` */
+} EPID_TMPL_LPF;
+
+
+epid_info_t EPID_TMPL_NAME(init)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R xk_1, EPID_TMPL_R xk_2, EPID_TMPL_R y_previous,
+    EPID_TMPL_R kp, EPID_TMPL_R ki, EPID_TMPL_R kd);
+
+epid_info_t EPID_TMPL_NAME(init_T)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R xk_1, EPID_TMPL_R xk_2, EPID_TMPL_R y_previous,
+    EPID_TMPL_R kp, EPID_TMPL_R ti, EPID_TMPL_R td,
+    EPID_TMPL_R sample_period);
+
+epid_info_t EPID_TMPL_NAME(set_gains)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R kp, EPID_TMPL_R ki, EPID_TMPL_R kd);
+
+epid_info_t EPID_TMPL_NAME(set_gains_T)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R kp, EPID_TMPL_R ti, EPID_TMPL_R td);
+
+void EPID_TMPL_NAME(pi_calc)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure);
+
+void EPID_TMPL_NAME(pid_calc)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure);
+
+void EPID_TMPL_NAME(pi_sum)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max);
+
+void EPID_TMPL_NAME(pid_sum)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max);
+
+void EPID_TMPL_NAME(pi_step)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max);
+
+void EPID_TMPL_NAME(pid_step)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max);
+
+void EPID_TMPL_NAME(util_ilim)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max);
+
+epid_info_t EPID_TMPL_NAME(util_lpf_init)(EPID_TMPL_LPF *ctx,
+    EPID_TMPL_R smoothing_factor, EPID_TMPL_R x_0);
+
+void EPID_TMPL_NAME(util_lpf_calc)(EPID_TMPL_LPF *ctx, EPID_TMPL_R input);
+
+#endif /* EPID_TMPL_DECLARE */
+
+
+#ifdef EPID_TMPL_DEFINE
+
+#ifdef EPID_FEATURE_VALID_FLT
+static inline EPID_TMPL_U EPID_TMPL_NAME(tmpl_bits)(EPID_TMPL_R x)
+{
+    EPID_TMPL_U u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static inline int EPID_TMPL_NAME(tmpl_finite)(EPID_TMPL_R x)
+{
+    return (EPID_TMPL_NAME(tmpl_bits)(x) & EPID_TMPL_EXP_MASK) != EPID_TMPL_EXP_MASK;
+}
+#endif
+
+
+/* Keep `y[k-1]` if `y[k]` is NaN, limit `y[k]` (CV) to boundaries,
+ * and set the sticky `EPID_FLAG_*` bits; By selects, not branches.
+ */
+static inline EPID_TMPL_R EPID_TMPL_NAME(tmpl_out_guard)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R y, EPID_TMPL_R y_prev, EPID_TMPL_R out_min, EPID_TMPL_R out_max)
+{
+    epid_flags_t flags = 0U;
+
+#ifdef EPID_FEATURE_VALID_FLT
+    /* A NaN term always gives a NaN `y[k]`. */
+    const EPID_TMPL_U y_bits = EPID_TMPL_NAME(tmpl_bits)(y);
+    const EPID_TMPL_U is_nan = ((y_bits & EPID_TMPL_ABS_MASK) > EPID_TMPL_EXP_MASK);
+    const EPID_TMPL_U is_inf = ((y_bits & EPID_TMPL_ABS_MASK) == EPID_TMPL_EXP_MASK);
+    const EPID_TMPL_U nan_mask = (EPID_TMPL_U)0U - is_nan;
+    const EPID_TMPL_U out_bits = (y_bits & ~nan_mask)
+                               | (EPID_TMPL_NAME(tmpl_bits)(y_prev) & nan_mask);
+
+    memcpy(&y, &out_bits, sizeof(y));
+    flags = (epid_flags_t)((is_nan * EPID_FLAG_NAN) | (is_inf * EPID_FLAG_INF));
+#else
+    (void)y_prev;
+#endif
+
+    /* Limit the new output `y[k]` (CV) to boundaries. */
+    const epid_flags_t sat_hi = (y > out_max);
+    const epid_flags_t sat_lo = (y < out_min);
+    y = sat_hi ? out_max : (sat_lo ? out_min : y);
+
+    ctx->flags |= flags
+                | (epid_flags_t)(sat_hi * EPID_FLAG_SAT_HI)
+                | (epid_flags_t)(sat_lo * EPID_FLAG_SAT_LO);
+
+    return y;
+}
+
+
+EPID_TMPL_API epid_info_t EPID_TMPL_NAME(init)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R xk_1, EPID_TMPL_R xk_2, EPID_TMPL_R y_previous,
+    EPID_TMPL_R kp, EPID_TMPL_R ki, EPID_TMPL_R kd)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((EPID_TMPL_NAME(tmpl_finite)(xk_1) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(xk_2) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(y_previous) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(kp) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(ki) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(kd) == 0) /* Okay to be zero for PI controller. */
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((ctx == NULL)
+     || (kp <= (EPID_TMPL_R)0)
+     || (ki <= (EPID_TMPL_R)0)
+     || (kd < (EPID_TMPL_R)0)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Set previous states for equations. */
+    ctx->xk_1 = (EPID_TMPL_S)xk_1; /* Set `x[k-1]` */
+    ctx->xk_2 = (EPID_TMPL_S)xk_2; /* Set `x[k-1]` for D-term */
+    ctx->y_out = (EPID_TMPL_S)y_previous; /* Set `y[k-1]` */
+
+    /* Direct gains assignments. */
+    ctx->kp = (EPID_TMPL_S)kp; /* P-term gain constant. */
+    ctx->ki = (EPID_TMPL_S)ki; /* I-term gain constant. */
+    ctx->kd = (EPID_TMPL_S)kd; /* D-term gain constant. */
+
+    ctx->flags = 0U; /* Clear sticky flags. */
+
+    ctx->sample_period = (EPID_TMPL_R)0; /* Unknown. */
+    ctx->sample_rate = (EPID_TMPL_R)0;
+
+    return EPID_ERR_NONE;
+}
+
+
+EPID_TMPL_API epid_info_t EPID_TMPL_NAME(init_T)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R xk_1, EPID_TMPL_R xk_2, EPID_TMPL_R y_previous,
+    EPID_TMPL_R kp, EPID_TMPL_R ti, EPID_TMPL_R td,
+    EPID_TMPL_R sample_period)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((EPID_TMPL_NAME(tmpl_finite)(ti) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(sample_period) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((ti <= (EPID_TMPL_R)0)
+     || (td <  (EPID_TMPL_R)0) /* Okay to be zero for PI controller. */
+     || (sample_period <= (EPID_TMPL_R)0)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* I-term gain constant; `Ki = Kp / (Ti / Ts) = (Kp * Ts) / Ti` */
+    const EPID_TMPL_R ki = (kp * sample_period) / ti;
+    /* D-term gain constant; `Kd = Kp * (Td / Ts)` */
+    const EPID_TMPL_R kd = kp * (td / sample_period);
+
+    const epid_info_t err = EPID_TMPL_NAME(init)(ctx,
+                                                 xk_1, xk_2, y_previous,
+                                                 kp, ki, kd);
+    if (err == EPID_ERR_NONE) {
+        /* Cached for `*_set_gains_T()`. */
+        ctx->sample_period = sample_period;
+        ctx->sample_rate = (EPID_TMPL_R)1 / sample_period;
+    }
+
+    return err;
+}
+
+
+EPID_TMPL_API epid_info_t EPID_TMPL_NAME(set_gains)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R kp, EPID_TMPL_R ki, EPID_TMPL_R kd)
+{
+    /* Same checks as `epid_gains_init()`. */
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((EPID_TMPL_NAME(tmpl_finite)(kp) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(ki) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(kd) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((ctx == NULL)
+     || (kp <= (EPID_TMPL_R)0)
+     || (ki <= (EPID_TMPL_R)0)
+     || (kd < (EPID_TMPL_R)0) /* Okay to be zero for PI controller. */
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* New gains only, states are kept. */
+    ctx->kp = (EPID_TMPL_S)kp;
+    ctx->ki = (EPID_TMPL_S)ki;
+    ctx->kd = (EPID_TMPL_S)kd;
+
+    return EPID_ERR_NONE;
+}
+
+
+EPID_TMPL_API epid_info_t EPID_TMPL_NAME(set_gains_T)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R kp, EPID_TMPL_R ti, EPID_TMPL_R td)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((EPID_TMPL_NAME(tmpl_finite)(ti) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(td) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((ctx == NULL)
+     || (ti <= (EPID_TMPL_R)0)
+     || (td <  (EPID_TMPL_R)0) /* Okay to be zero for PI controller. */
+     || (ctx->sample_period <= (EPID_TMPL_R)0) /* Not by `*_init_T()`. */
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Gains of `*_init_T()` with the cached `Ts` and `1 / Ts`;
+     * `Kd` may differ by one rounding, as `Td / Ts` is not divided here.
+     */
+    return EPID_TMPL_NAME(set_gains)(ctx, kp,
+                                     (kp * ctx->sample_period) / ti,
+                                     kp * (td * ctx->sample_rate));
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pi_calc)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     */
+    ctx->p_term = (EPID_TMPL_S)((EPID_TMPL_R)ctx->kp
+                                * ((EPID_TMPL_R)ctx->xk_1 - measure));
+    ctx->i_term = (EPID_TMPL_S)((EPID_TMPL_R)ctx->ki * (setpoint - measure));
+
+    ctx->xk_1 = (EPID_TMPL_S)measure; /* `x[k-1] = x[k]` */
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pid_calc)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure)
+{
+    /* P-term value: `P[k] = Kp * (x[k-1] - x[k])`
+     * I-term value: `I[k] = Ki * e[k] = Ki * (SP - x[k])`
+     * D-term value: `D[k] = Kp * (2*x[k-1] - x[k-2] - x[k])`
+     */
+    const EPID_TMPL_R xk_1 = (EPID_TMPL_R)ctx->xk_1;
+    const EPID_TMPL_R dx = xk_1 - measure;
+
+    ctx->d_term = (EPID_TMPL_S)((EPID_TMPL_R)ctx->kd
+                                * (xk_1 + dx - (EPID_TMPL_R)ctx->xk_2));
+    ctx->p_term = (EPID_TMPL_S)((EPID_TMPL_R)ctx->kp * dx);
+    ctx->i_term = (EPID_TMPL_S)((EPID_TMPL_R)ctx->ki * (setpoint - measure));
+
+    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = (EPID_TMPL_S)measure; /* `x[k-1] = x[k]` */
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pi_sum)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max)
+{
+    const EPID_TMPL_R y_prev = (EPID_TMPL_R)ctx->y_out;
+
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+    const EPID_TMPL_R y = y_prev
+        + ((EPID_TMPL_R)ctx->p_term + (EPID_TMPL_R)ctx->i_term);
+
+    ctx->y_out = (EPID_TMPL_S)EPID_TMPL_NAME(tmpl_out_guard)(ctx, y, y_prev,
+                                                             out_min, out_max);
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pid_sum)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max)
+{
+    const EPID_TMPL_R y_prev = (EPID_TMPL_R)ctx->y_out;
+
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+    const EPID_TMPL_R y = y_prev
+        + ((EPID_TMPL_R)ctx->p_term + (EPID_TMPL_R)ctx->i_term
+           + (EPID_TMPL_R)ctx->d_term);
+
+    ctx->y_out = (EPID_TMPL_S)EPID_TMPL_NAME(tmpl_out_guard)(ctx, y, y_prev,
+                                                             out_min, out_max);
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(util_ilim)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max)
+{
+    /* Limit I-term `I[k]` value to boundaries as an integrator anti-windup. */
+    if ((EPID_TMPL_R)ctx->i_term > i_max) {
+        ctx->i_term = (EPID_TMPL_S)i_max;
+    }
+    else if ((EPID_TMPL_R)ctx->i_term < i_min) {
+        ctx->i_term = (EPID_TMPL_S)i_min;
+    }
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pi_step)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max)
+{
+    /* Terms are kept in locals of the arithmetic type (not rounded to the
+     * storage type), and written to the context for telemetry.
+     */
+    const EPID_TMPL_R y_prev = (EPID_TMPL_R)ctx->y_out;
+    const EPID_TMPL_R p_term = (EPID_TMPL_R)ctx->kp * ((EPID_TMPL_R)ctx->xk_1 - measure);
+    EPID_TMPL_R i_term = (EPID_TMPL_R)ctx->ki * (setpoint - measure);
+    EPID_TMPL_R y;
+
+    ctx->xk_1 = (EPID_TMPL_S)measure; /* `x[k-1] = x[k]` */
+
+    /* Limit I-term `I[k]` value to boundaries as an integrator anti-windup. */
+    if (i_term > i_max) {
+        i_term = i_max;
+    }
+    else if (i_term < i_min) {
+        i_term = i_min;
+    }
+
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k]` */
+    y = y_prev + (p_term + i_term);
+    y = EPID_TMPL_NAME(tmpl_out_guard)(ctx, y, y_prev, out_min, out_max);
+
+    ctx->p_term = (EPID_TMPL_S)p_term;
+    ctx->i_term = (EPID_TMPL_S)i_term;
+    ctx->y_out = (EPID_TMPL_S)y;
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(pid_step)(EPID_TMPL_CTX *ctx,
+    EPID_TMPL_R setpoint, EPID_TMPL_R measure,
+    EPID_TMPL_R i_min, EPID_TMPL_R i_max,
+    EPID_TMPL_R out_min, EPID_TMPL_R out_max)
+{
+    /* Terms are kept in locals, as `*_pi_step()`. */
+    const EPID_TMPL_R y_prev = (EPID_TMPL_R)ctx->y_out;
+    const EPID_TMPL_R xk_1 = (EPID_TMPL_R)ctx->xk_1;
+    const EPID_TMPL_R dx = xk_1 - measure;
+    const EPID_TMPL_R d_term = (EPID_TMPL_R)ctx->kd * (xk_1 + dx - (EPID_TMPL_R)ctx->xk_2);
+    const EPID_TMPL_R p_term = (EPID_TMPL_R)ctx->kp * dx;
+    EPID_TMPL_R i_term = (EPID_TMPL_R)ctx->ki * (setpoint - measure);
+    EPID_TMPL_R y;
+
+    ctx->xk_2 = ctx->xk_1; /* `x[k-2] = x[k-1]` */
+    ctx->xk_1 = (EPID_TMPL_S)measure; /* `x[k-1] = x[k]` */
+
+    /* Limit I-term `I[k]` value to boundaries as an integrator anti-windup. */
+    if (i_term > i_max) {
+        i_term = i_max;
+    }
+    else if (i_term < i_min) {
+        i_term = i_min;
+    }
+
+    /* `y[k] = y[k-1] + delta[k] = y[k-1] + P[k] + I[k] + D[k]` */
+    y = y_prev + (p_term + i_term + d_term);
+    y = EPID_TMPL_NAME(tmpl_out_guard)(ctx, y, y_prev, out_min, out_max);
+
+    ctx->p_term = (EPID_TMPL_S)p_term;
+    ctx->i_term = (EPID_TMPL_S)i_term;
+    ctx->d_term = (EPID_TMPL_S)d_term;
+    ctx->y_out = (EPID_TMPL_S)y;
+}
+
+
+EPID_TMPL_API epid_info_t EPID_TMPL_NAME(util_lpf_init)(EPID_TMPL_LPF *ctx,
+    EPID_TMPL_R smoothing_factor, EPID_TMPL_R x_0)
+{
+#ifdef EPID_FEATURE_VALID_FLT
+    if ((EPID_TMPL_NAME(tmpl_finite)(smoothing_factor) == 0)
+     || (EPID_TMPL_NAME(tmpl_finite)(x_0) == 0)
+    ) {
+        return EPID_ERR_FLT;
+    }
+#endif
+
+    if ((ctx == NULL)
+     || (smoothing_factor <= (EPID_TMPL_R)0)
+     || (smoothing_factor >= (EPID_TMPL_R)1)
+    ) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Filter's smoothing factor. `0 < a < 1` */
+    ctx->smoothing_factor = (EPID_TMPL_S)smoothing_factor;
+    /* `y[0] = smoothing_factor * x[0]` */
+    ctx->y = (EPID_TMPL_S)(smoothing_factor * x_0);
+
+    return EPID_ERR_NONE;
+}
+
+
+EPID_TMPL_API void EPID_TMPL_NAME(util_lpf_calc)(EPID_TMPL_LPF *ctx, EPID_TMPL_R input)
+{
+    /* `y[k] = FILTER(x[k]) = y[k-1] + smoothing_factor * (x[k] - y[k-1])` */
+    const EPID_TMPL_R y_prev = (EPID_TMPL_R)ctx->y;
+    ctx->y = (EPID_TMPL_S)(y_prev
+        + (EPID_TMPL_R)ctx->smoothing_factor * (input - y_prev));
+}
+
+#endif /* EPID_TMPL_DEFINE */
+
+
+#undef EPID_TMPL_S
+#undef EPID_TMPL_R
+#undef EPID_TMPL_U
+#undef EPID_TMPL_CTX
+#undef EPID_TMPL_LPF
+#undef EPID_TMPL_NAME
+#undef EPID_TMPL_STORE
+#undef EPID_TMPL_REAL
+#undef EPID_TMPL_UINT
+#undef EPID_TMPL_ABS_MASK
+#undef EPID_TMPL_EXP_MASK
+#undef EPID_TMPL_DECLARE
+#undef EPID_TMPL_DEFINE
+#undef EPID_TMPL_API
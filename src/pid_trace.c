@@ -0,0 +1,514 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+/* For `pwrite()`, `ftruncate()` and `mmap()` in strict ISO C modes,
+ * and 64-bits file offsets on 32-bits hosts.
+ */
+#if !defined(_POSIX_C_SOURCE) && !defined(__APPLE__)
+# define _POSIX_C_SOURCE 200809L
+#endif
+#ifndef _FILE_OFFSET_BITS
+# define _FILE_OFFSET_BITS 64
+#endif
+
+#include "pid_trace.h"
+
+#ifdef EPID_TRACE_AVAILABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Capacity granularity: Every column starts 64 bytes aligned. */
+#define EPID_TRACE_ROWS_ALIGN (16U)
+
+/* Largest file size, for `off_t` and `size_t`. */
+#define EPID_TRACE_OFF_MAX (((uint64_t)1 << ((sizeof(off_t) * 8U) - 1U)) - 1U)
+
+
+/* Bytes of a sample in all columns. */
+static inline uint64_t epid_trace_row_bytes(uint32_t loops)
+{
+    return sizeof(float) * (1U + ((uint64_t)(EPID_TRACE_COLUMNS - 1U) * loops));
+}
+
+
+/* Values of a sample in a column. */
+static inline uint32_t epid_trace_width(const epid_trace_header_t *h, uint32_t column)
+{
+    return (column == EPID_TRACE_TIME) ? 1U : h->loops;
+}
+
+
+/* File offset of a column. */
+static inline uint64_t epid_trace_offset(const epid_trace_header_t *h, uint32_t column)
+{
+    uint64_t off = h->header_size;
+
+    if (column != EPID_TRACE_TIME) {
+        off += h->capacity * sizeof(float) * (1U + ((uint64_t)(column - 1U) * h->loops));
+    }
+
+    return off;
+}
+
+
+/* Writer buffer of a column: `rows` samples. */
+static inline float *epid_trace_buf(const epid_trace_writer_t *w, uint32_t column)
+{
+    size_t off = 0U;
+
+    if (column != EPID_TRACE_TIME) {
+        off = (size_t)w->rows * (1U + ((size_t)(column - 1U) * w->header.loops));
+    }
+
+    return &w->buf[off];
+}
+
+
+static int epid_trace_pwrite(int fd, const void *data, size_t size, uint64_t off)
+{
+    const unsigned char *p = (const unsigned char *)data;
+
+    while (size > 0U) {
+        const ssize_t n = pwrite(fd, p, size, (off_t)off);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        size -= (size_t)n;
+        off += (uint64_t)n;
+    }
+
+    return 0;
+}
+
+
+static void epid_trace_nan_fill(float *dst, uint32_t n)
+{
+    const uint32_t bits = UINT32_C(0x7FC00000); /* Quiet NAN. */
+    float nan_value;
+
+    memcpy(&nan_value, &bits, sizeof(nan_value));
+    for (uint32_t i = 0U; i < n; i++) {
+        dst[i] = nan_value;
+    }
+}
+
+
+epid_info_t epid_trace_writer_open(epid_trace_writer_t *w, const char *path,
+                                   uint32_t loops, uint64_t capacity,
+                                   double t0, double dt)
+{
+    epid_trace_header_t *h;
+    uint64_t row_bytes, size, rows;
+
+    if ((w == NULL) || (path == NULL) || (loops == 0U) || (capacity == 0U)) {
+        return EPID_ERR_INIT;
+    }
+
+    w->fd = -1;
+    w->buf = NULL;
+    w->error_op = NULL;
+    w->error = 0;
+
+    row_bytes = epid_trace_row_bytes(loops);
+    if (capacity > ((EPID_TRACE_OFF_MAX - sizeof(epid_trace_header_t)) / row_bytes)
+                   - EPID_TRACE_ROWS_ALIGN
+    ) {
+        return EPID_ERR_INIT;
+    }
+    capacity = (capacity + (EPID_TRACE_ROWS_ALIGN - 1U)) & ~(uint64_t)(EPID_TRACE_ROWS_ALIGN - 1U);
+    size = sizeof(epid_trace_header_t) + (capacity * row_bytes);
+
+    rows = EPID_TRACE_BUF_BYTES / row_bytes;
+    rows = (rows > 0U) ? rows : 1U;
+    rows = (rows < capacity) ? rows : capacity;
+    if ((rows > UINT32_MAX) || ((rows * row_bytes) > SIZE_MAX)) {
+        return EPID_ERR_INIT;
+    }
+
+    h = &w->header;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, EPID_TRACE_MAGIC, sizeof(h->magic));
+    h->version = (uint16_t)EPID_TRACE_VERSION;
+    h->header_size = (uint16_t)sizeof(epid_trace_header_t);
+    h->byte_order = EPID_TRACE_BYTE_ORDER;
+    h->columns = EPID_TRACE_COLUMNS;
+    h->loops = loops;
+    h->capacity = capacity;
+    h->count = 0U;
+    h->t0 = t0;
+    h->dt = dt;
+
+    w->count = 0U;
+    w->rows = (uint32_t)rows;
+    w->n_buf = 0U;
+
+    w->buf = (float *)malloc((size_t)(rows * row_bytes));
+    if (w->buf == NULL) {
+        w->error_op = "malloc";
+        w->error = ENOMEM;
+        return EPID_ERR_INIT;
+    }
+
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (w->fd < 0) {
+        w->error_op = "open";
+    }
+    /* The whole size at once: Holes until written, fixed column offsets. */
+    else if (ftruncate(w->fd, (off_t)size) != 0) {
+        w->error_op = "ftruncate";
+    }
+    else if (epid_trace_pwrite(w->fd, h, sizeof(*h), 0U) != 0) {
+        w->error_op = "pwrite";
+    }
+
+    if (w->error_op != NULL) {
+        w->error = errno;
+        if (w->fd >= 0) {
+            (void)close(w->fd);
+            w->fd = -1;
+        }
+        free(w->buf);
+        w->buf = NULL;
+        return EPID_ERR_INIT;
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_trace_writer_flush(epid_trace_writer_t *w)
+{
+    epid_trace_header_t *h = &w->header;
+
+    if (w->n_buf == 0U) {
+        return EPID_ERR_NONE;
+    }
+
+    for (uint32_t c = 0U; c < EPID_TRACE_COLUMNS; c++) {
+        const uint32_t width = epid_trace_width(h, c);
+        const uint64_t off = epid_trace_offset(h, c) + (h->count * width * sizeof(float));
+
+        if (epid_trace_pwrite(w->fd, epid_trace_buf(w, c),
+                              (size_t)w->n_buf * width * sizeof(float), off) != 0
+        ) {
+            w->error_op = "pwrite";
+            w->error = errno;
+            return EPID_ERR_INIT;
+        }
+    }
+
+    /* After the data: The header never counts unwritten samples. */
+    h->count += w->n_buf;
+    if (epid_trace_pwrite(w->fd, &h->count, sizeof(h->count),
+                          offsetof(epid_trace_header_t, count)) != 0
+    ) {
+        h->count -= w->n_buf;
+        w->error_op = "pwrite";
+        w->error = errno;
+        return EPID_ERR_INIT;
+    }
+    w->n_buf = 0U;
+
+    return EPID_ERR_NONE;
+}
+
+
+/* Room for one sample in the buffer: Flush it if full. */
+static inline epid_info_t epid_trace_reserve(epid_trace_writer_t *w)
+{
+    if (w->count >= w->header.capacity) {
+        w->error_op = "append";
+        w->error = ENOSPC;
+        return EPID_ERR_INIT;
+    }
+
+    if (w->n_buf == w->rows) {
+        return epid_trace_writer_flush(w);
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_trace_writer_append(epid_trace_writer_t *w, float time,
+                                     const float *sp, const float *pv, const float *cv,
+                                     const float *p, const float *i, const float *d)
+{
+    const float *const values[EPID_TRACE_COLUMNS] = {NULL, sp, pv, cv, p, i, d};
+    const uint32_t loops = w->header.loops;
+    const epid_info_t err = epid_trace_reserve(w);
+
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    epid_trace_buf(w, EPID_TRACE_TIME)[w->n_buf] = time;
+    for (uint32_t c = 1U; c < EPID_TRACE_COLUMNS; c++) {
+        float *dst = &epid_trace_buf(w, c)[(size_t)w->n_buf * loops];
+
+        if (values[c] != NULL) {
+            memcpy(dst, values[c], loops * sizeof(float));
+        }
+        else {
+            epid_trace_nan_fill(dst, loops);
+        }
+    }
+    w->n_buf++;
+    w->count++;
+
+    return EPID_ERR_NONE;
+}
+
+
+/* One loop sample: Column `c` is at `c * rows` in the buffer. */
+static inline void epid_trace_store1(epid_trace_writer_t *w, float time,
+                                     float sp, float pv, float cv,
+                                     float p, float i, float d)
+{
+    float *b = &w->buf[w->n_buf];
+    const size_t rows = w->rows;
+
+    b[EPID_TRACE_TIME * rows] = time;
+    b[EPID_TRACE_SP * rows] = sp;
+    b[EPID_TRACE_PV * rows] = pv;
+    b[EPID_TRACE_CV * rows] = cv;
+    b[EPID_TRACE_P * rows] = p;
+    b[EPID_TRACE_I * rows] = i;
+    b[EPID_TRACE_D * rows] = d;
+    w->n_buf++;
+    w->count++;
+}
+
+
+epid_info_t epid_trace_writer_append_ctx(epid_trace_writer_t *w, float time,
+                                         float setpoint, const epid_t *ctx)
+{
+    epid_info_t err;
+
+    if (w->header.loops != 1U) {
+        return EPID_ERR_INIT;
+    }
+
+    err = epid_trace_reserve(w);
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    epid_trace_store1(w, time, setpoint, ctx->xk_1, ctx->y_out,
+                      ctx->p_term, ctx->i_term, ctx->d_term);
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_trace_writer_append_recs(epid_trace_writer_t *w,
+                                          const epid_telem_rec_t *recs, size_t n)
+{
+    const double t0 = w->header.t0;
+    const double dt = w->header.dt;
+
+    if (w->header.loops != 1U) {
+        return EPID_ERR_INIT;
+    }
+
+    for (size_t k = 0U; k < n; k++) {
+        const epid_telem_rec_t *r = &recs[k];
+        const double tick = (double)r->tick;
+        const epid_info_t err = epid_trace_reserve(w);
+
+        if (err != EPID_ERR_NONE) {
+            return err;
+        }
+
+        epid_trace_store1(w, (float)((dt != 0.0) ? (t0 + (tick * dt)) : tick),
+                          r->setpoint, r->measure, r->y_out,
+                          r->p_term, r->i_term, r->d_term);
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_trace_writer_close(epid_trace_writer_t *w)
+{
+    epid_info_t err = epid_trace_writer_flush(w);
+
+    if ((close(w->fd) != 0) && (err == EPID_ERR_NONE)) {
+        w->error_op = "close";
+        w->error = errno;
+        err = EPID_ERR_INIT;
+    }
+    w->fd = -1;
+    free(w->buf);
+    w->buf = NULL;
+
+    return err;
+}
+
+
+/* Header checks, `size` is the file size. */
+static int epid_trace_header_valid(const epid_trace_header_t *h, uint64_t size)
+{
+    if ((memcmp(h->magic, EPID_TRACE_MAGIC, sizeof(h->magic)) != 0)
+     || (h->version == 0U)
+     || (h->version > EPID_TRACE_VERSION)
+     || (h->byte_order != EPID_TRACE_BYTE_ORDER)
+     || (h->header_size < sizeof(epid_trace_header_t))
+     || ((h->header_size % sizeof(float)) != 0U)
+     || (h->columns < EPID_TRACE_COLUMNS)
+     || (h->loops == 0U)
+     || (h->count > h->capacity)
+    ) {
+        return 0;
+    }
+
+    /* All columns in the file, no overflow: `header_size + capacity * row_bytes <= size`. */
+    if ((h->header_size > size)
+     || (h->capacity > ((size - h->header_size) / epid_trace_row_bytes(h->loops)))
+    ) {
+        return 0;
+    }
+
+    /* And each mapped column, for `capacity` (so `count`) samples. */
+    for (uint32_t c = 0U; c < EPID_TRACE_COLUMNS; c++) {
+        const uint64_t off = epid_trace_offset(h, c);
+
+        if ((off > size)
+         || ((h->capacity * epid_trace_width(h, c) * sizeof(float)) > (size - off))
+        ) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+
+epid_info_t epid_trace_reader_open(epid_trace_reader_t *r, const char *path)
+{
+    struct stat st;
+    int fd;
+    void *map;
+
+    if ((r == NULL) || (path == NULL)) {
+        return EPID_ERR_INIT;
+    }
+
+    r->map = NULL;
+    r->map_size = 0U;
+    r->error_op = NULL;
+    r->error = 0;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        r->error_op = "open";
+        r->error = errno;
+        return EPID_ERR_INIT;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        r->error_op = "fstat";
+        r->error = errno;
+        (void)close(fd);
+        return EPID_ERR_INIT;
+    }
+    if ((st.st_size < (off_t)sizeof(epid_trace_header_t))
+     || ((uint64_t)st.st_size > (uint64_t)SIZE_MAX)
+    ) {
+        (void)close(fd);
+        return EPID_ERR_INIT;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        r->error_op = "mmap";
+        r->error = errno;
+        (void)close(fd);
+        return EPID_ERR_INIT;
+    }
+    (void)close(fd); /* The map keeps the file. */
+
+    memcpy(&r->header, map, sizeof(r->header));
+    if (epid_trace_header_valid(&r->header, (uint64_t)st.st_size) == 0) {
+        (void)munmap(map, (size_t)st.st_size);
+        return EPID_ERR_INIT;
+    }
+
+    r->map = map;
+    r->map_size = (size_t)st.st_size;
+    for (uint32_t c = 0U; c < EPID_TRACE_COLUMNS; c++) {
+        r->columns[c] = (const float *)(const void *)((const unsigned char *)map
+                                                      + epid_trace_offset(&r->header, c));
+    }
+
+    return EPID_ERR_NONE;
+}
+
+
+uint64_t epid_trace_reader_refresh(epid_trace_reader_t *r)
+{
+    uint64_t count;
+
+    memcpy(&count, (const unsigned char *)r->map + offsetof(epid_trace_header_t, count),
+           sizeof(count));
+    r->header.count = (count < r->header.capacity) ? count : r->header.capacity;
+
+    return r->header.count;
+}
+
+
+const float *epid_trace_reader_column(const epid_trace_reader_t *r, uint32_t column)
+{
+    return (column < EPID_TRACE_COLUMNS) ? r->columns[column] : NULL;
+}
+
+
+void epid_trace_reader_close(epid_trace_reader_t *r)
+{
+    if (r->map != NULL) {
+        (void)munmap((void *)(uintptr_t)r->map, r->map_size);
+        r->map = NULL;
+        r->map_size = 0U;
+    }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_trace_unavailable_t;
+#endif /* EPID_TRACE_AVAILABLE */
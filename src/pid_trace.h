@@ -0,0 +1,265 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID trace files: A versioned columnar binary format for controller traces
+ * {time, SP, PV, CV, P, I, D} of one or more loops, a buffered writer for
+ * simulators and telemetry drains, and a `mmap()` reader.
+ *
+ * File layout (version 1), in the byte order of the writer:
+ *   - 64 bytes header, `epid_trace_header_t`.
+ *   - Column `EPID_TRACE_TIME`: `capacity` float32 values.
+ *   - Columns `EPID_TRACE_SP` to `EPID_TRACE_D`: `capacity * loops` float32
+ *     values each, sample-major (`[sample][loop]`).
+ * Columns are at fixed offsets, 64 bytes aligned; the first `count` samples
+ * are valid. Every column is one contiguous array, so a reader maps the file
+ * and uses the columns in place, with no parsing (also from NumPy, see
+ * `extras/testing/epid_trace.py`).
+ *
+ * The writer sizes the file for `capacity` samples at creation (a sparse file
+ * on most file systems), buffers samples, and writes each column chunk at its
+ * place, then the header `count`: If the writer process dies, the file is
+ * readable up to the last flush. A full trace is reported, for file rotation.
+ *
+ * Host only: Needs POSIX files and `mmap()`, `EPID_TRACE_AVAILABLE` is defined
+ * if available, else "pid_trace.c" is empty.
+ */
+
+
+#ifndef EPID_TRACE_H
+#define EPID_TRACE_H 1
+
+#if defined(__unix__) || defined(__APPLE__)
+# define EPID_TRACE_AVAILABLE 1
+#endif
+
+#ifdef EPID_TRACE_AVAILABLE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid_telem.h"
+
+#define EPID_TRACE_MAGIC "EPIDTRC" /* With its NUL: 8 bytes. */
+#define EPID_TRACE_VERSION (1U)
+#define EPID_TRACE_BYTE_ORDER (UINT32_C(0x01020304)) /* As written by the writer. */
+
+/* Columns. */
+#define EPID_TRACE_TIME (0U) /* Time (s), shared by all loops. */
+#define EPID_TRACE_SP (1U) /* Setpoint. */
+#define EPID_TRACE_PV (2U) /* Process variable, the measure. */
+#define EPID_TRACE_CV (3U) /* Controller output, `y[k]`. */
+#define EPID_TRACE_P (4U) /* `P[k]` */
+#define EPID_TRACE_I (5U) /* `I[k]` */
+#define EPID_TRACE_D (6U) /* `D[k]` */
+#define EPID_TRACE_COLUMNS (7U)
+
+/* Writer buffer size in bytes, for all columns. */
+#ifndef EPID_TRACE_BUF_BYTES
+# define EPID_TRACE_BUF_BYTES (1024U * 1024U)
+#endif
+
+
+typedef struct {
+    char magic[8]; /* `EPID_TRACE_MAGIC` */
+    uint16_t version; /* `EPID_TRACE_VERSION` */
+    uint16_t header_size; /* Bytes before the first column. */
+    uint32_t byte_order; /* `EPID_TRACE_BYTE_ORDER` */
+    uint32_t columns; /* `EPID_TRACE_COLUMNS` */
+    uint32_t loops; /* Values per sample of the loop columns. */
+    uint64_t capacity; /* Samples per column, a multiple of 16. */
+    uint64_t count; /* Valid samples, `count <= capacity`. */
+    double t0; /* Time of sample 0 (s). */
+    double dt; /* Sample period (s), zero if not uniform. */
+    uint64_t reserved; /* Zero. */
+} epid_trace_header_t; /* 64 bytes. */
+
+typedef struct {
+    int fd;
+    epid_trace_header_t header; /* `count`: Samples in the file. */
+    uint64_t count; /* Samples appended, in the file and the buffer. */
+
+    float *buf; /* `rows` samples per column, columns after each other. */
+    uint32_t rows; /* Buffer capacity in samples. */
+    uint32_t n_buf; /* Samples in the buffer. */
+
+    /* Failed system call and its `errno`, or `NULL`. */
+    const char *error_op;
+    int error;
+} epid_trace_writer_t;
+
+typedef struct {
+    const void *map;
+    size_t map_size;
+    epid_trace_header_t header; /* `count` as of the open or the last refresh. */
+    const float *columns[EPID_TRACE_COLUMNS]; /* Columns in the map. */
+
+    /* Failed system call and its `errno`, or `NULL`. */
+    const char *error_op;
+    int error;
+} epid_trace_reader_t;
+
+
+/**
+ * Create (or truncate) a trace file for `loops` loops and up to `capacity`
+ * samples, and allocate the writer buffer.
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ * path: File path.
+ * loops: Number of loops, at least one.
+ * capacity: Max number of samples, rounded up to a multiple of 16.
+ * t0: Time of sample 0 (s), saved in the header.
+ * dt: Sample period (s), zero if not uniform; Saved in the header, and used
+ *     for the time of `epid_trace_writer_append_recs()`.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` on invalid arguments, or if a system call failed, see
+ *     `w->error_op` and `w->error`.
+ */
+epid_info_t epid_trace_writer_open(epid_trace_writer_t *w, const char *path,
+                                   uint32_t loops, uint64_t capacity,
+                                   double t0, double dt);
+
+
+/**
+ * Append a sample of all loops.
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ * time: Time of the sample (s).
+ * sp, pv, cv, p, i, d: Values of the loops, `loops` values each;
+ *                      `NULL` for a column not traced (NAN values).
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if the trace is full (`w->error` is `ENOSPC`), or if a
+ *     buffer flush failed, see `epid_trace_writer_flush()`.
+ */
+epid_info_t epid_trace_writer_append(epid_trace_writer_t *w, float time,
+                                     const float *sp, const float *pv, const float *cv,
+                                     const float *p, const float *i, const float *d);
+
+
+/**
+ * Append a sample of a one loop trace from a controller after its
+ * `epid_p*_calc()` (and `epid_p*_sum()`), where `x[k-1]` is the measure (PV).
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ * time: Time of the sample (s).
+ * setpoint: The setpoint (SP) of the tick.
+ * ctx: Pointer to the `epid_t` context, only read.
+ *
+ * Return: See `epid_trace_writer_append()`, and `EPID_ERR_INIT` if `loops`
+ *         is not one.
+ */
+epid_info_t epid_trace_writer_append_ctx(epid_trace_writer_t *w, float time,
+                                         float setpoint, const epid_t *ctx);
+
+
+/**
+ * Append telemetry records (<pid_telem.h>) to a one loop trace, e.g. a batch
+ * of `epid_telem_pop()`; Time is `t0 + tick * dt`, or the tick if `dt` is zero.
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ * recs: Records, `n` values.
+ * n: Number of records.
+ *
+ * Return: See `epid_trace_writer_append_ctx()`; On error, the records before
+ *         the failed one are appended.
+ */
+epid_info_t epid_trace_writer_append_recs(epid_trace_writer_t *w,
+                                          const epid_telem_rec_t *recs, size_t n);
+
+
+/**
+ * Write the buffered samples and the header `count` to the file.
+ * Samples are flushed by the appends when the buffer is full, and by the close.
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if a write failed, see `w->error_op` and `w->error`;
+ *     The buffered samples are kept.
+ */
+epid_info_t epid_trace_writer_flush(epid_trace_writer_t *w);
+
+
+/**
+ * Flush, close the file and free the buffer.
+ *
+ * w: Pointer to the `epid_trace_writer_t` context.
+ *
+ * Return: See `epid_trace_writer_flush()`; The writer is closed in all cases.
+ */
+epid_info_t epid_trace_writer_close(epid_trace_writer_t *w);
+
+
+/**
+ * Map a trace file read-only and check its header. Pages are read from the
+ * file on first access, so the open time does not depend on the file size.
+ *
+ * r: Pointer to the `epid_trace_reader_t` context.
+ * path: File path.
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` if the file is not a valid trace of a supported version
+ *     and byte order, or if a system call failed, see `r->error_op` and `r->error`.
+ */
+epid_info_t epid_trace_reader_open(epid_trace_reader_t *r, const char *path);
+
+
+/**
+ * Read again the samples count of a trace still written by a writer.
+ *
+ * r: Pointer to the `epid_trace_reader_t` context.
+ *
+ * Return: The number of valid samples.
+ */
+uint64_t epid_trace_reader_refresh(epid_trace_reader_t *r);
+
+
+/**
+ * Get a column in the map.
+ *
+ * r: Pointer to the `epid_trace_reader_t` context.
+ * column: `EPID_TRACE_TIME` (`count` values), or `EPID_TRACE_SP` to
+ *         `EPID_TRACE_D` (`count * loops` values, sample-major).
+ *
+ * Return: Pointer to the first value, valid until `epid_trace_reader_close()`;
+ *         `NULL` if `column` is invalid.
+ */
+const float *epid_trace_reader_column(const epid_trace_reader_t *r, uint32_t column);
+
+
+/**
+ * Unmap a trace file.
+ *
+ * r: Pointer to the `epid_trace_reader_t` context.
+ */
+void epid_trace_reader_close(epid_trace_reader_t *r);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_TRACE_AVAILABLE */
+
+#endif /* EPID_TRACE_H */
@@ -0,0 +1,215 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <string.h> /* For `memcpy()` of FP bit-patterns. */
+
+#include "pid_tune.h"
+
+/* Built as C99 with `EPID_FEATURE_ATOMICS`: Empty, see <pid_tune.h>. */
+#ifdef EPID_TUNE_AVAILABLE
+
+#ifdef EPID_TUNE_ATOMICS
+_Static_assert(sizeof(epid_tune_seq_t) == sizeof(uint32_t), "Layout of epid_tune_t");
+
+# define EPID_TUNE_LOAD(p) atomic_load_explicit((p), memory_order_relaxed)
+# define EPID_TUNE_STORE(p, v) atomic_store_explicit((p), (v), memory_order_relaxed)
+# define EPID_TUNE_FENCE_RELEASE() atomic_thread_fence(memory_order_release)
+# define EPID_TUNE_FENCE_ACQUIRE() atomic_thread_fence(memory_order_acquire)
+#else
+# define EPID_TUNE_LOAD(p) (*(p))
+# define EPID_TUNE_STORE(p, v) (*(p) = (v))
+# if defined(__GNUC__) || defined(__clang__)
+#  define EPID_TUNE_FENCE_RELEASE() __sync_synchronize()
+#  define EPID_TUNE_FENCE_ACQUIRE() __sync_synchronize()
+# else
+/* `volatile` accesses are not reordered between themselves. */
+#  define EPID_TUNE_FENCE_RELEASE() ((void)0)
+#  define EPID_TUNE_FENCE_ACQUIRE() ((void)0)
+# endif
+#endif
+
+/* Values of `words[]`. */
+#define EPID_TUNE_KP (0U)
+#define EPID_TUNE_KI (1U)
+#define EPID_TUNE_KD (2U)
+#define EPID_TUNE_SP (3U)
+
+
+static uint32_t epid_tune_bits(float x)
+{
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+static float epid_tune_flt(uint32_t u)
+{
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+
+/* Publish `values[]` of the words set in `mask`. */
+static void epid_tune_publish(epid_tune_t *tune, const uint32_t values[4], unsigned mask)
+{
+    const uint32_t seq = (uint32_t)EPID_TUNE_LOAD(&tune->seq); /* Only writer. */
+
+    EPID_TUNE_STORE(&tune->seq, seq + 1U); /* Odd: Write in progress. */
+    EPID_TUNE_FENCE_RELEASE();
+
+    for (unsigned i = 0U; i < 4U; i++) {
+        if ((mask & (1U << i)) != 0U) {
+            EPID_TUNE_STORE(&tune->words[i], values[i]);
+        }
+    }
+
+    EPID_TUNE_FENCE_RELEASE();
+    EPID_TUNE_STORE(&tune->seq, seq + 2U); /* Even: Stable. */
+}
+
+
+epid_info_t epid_tune_init(epid_tune_t *tune, float kp, float ki, float kd, float setpoint)
+{
+    epid_gains_t gains;
+    const epid_info_t err = epid_gains_init(&gains, kp, ki, kd);
+
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+    if (tune == NULL) {
+        return EPID_ERR_INIT;
+    }
+
+    /* Not zero, so a reader with `seen` zero takes the initial values. */
+    EPID_TUNE_STORE(&tune->seq, 2U);
+    EPID_TUNE_STORE(&tune->words[EPID_TUNE_KP], epid_tune_bits(gains.kp));
+    EPID_TUNE_STORE(&tune->words[EPID_TUNE_KI], epid_tune_bits(gains.ki));
+    EPID_TUNE_STORE(&tune->words[EPID_TUNE_KD], epid_tune_bits(gains.kd));
+    EPID_TUNE_STORE(&tune->words[EPID_TUNE_SP], epid_tune_bits(setpoint));
+    EPID_TUNE_FENCE_RELEASE();
+
+    return EPID_ERR_NONE;
+}
+
+
+epid_info_t epid_tune_write(epid_tune_t *tune, float kp, float ki, float kd, float setpoint)
+{
+    epid_gains_t gains;
+    uint32_t values[4];
+    const epid_info_t err = epid_gains_init(&gains, kp, ki, kd);
+
+    if (err != EPID_ERR_NONE) {
+        return err;
+    }
+
+    values[EPID_TUNE_KP] = epid_tune_bits(gains.kp);
+    values[EPID_TUNE_KI] = epid_tune_bits(gains.ki);
+    values[EPID_TUNE_KD] = epid_tune_bits(gains.kd);
+    values[EPID_TUNE_SP] = epid_tune_bits(setpoint);
+    epid_tune_publish(tune, values, 0xFU);
+
+    return EPID_ERR_NONE;
+}
+
+
+void epid_tune_write_setpoint(epid_tune_t *tune, float setpoint)
+{
+    uint32_t values[4] = {0U, 0U, 0U, 0U};
+
+    values[EPID_TUNE_SP] = epid_tune_bits(setpoint);
+    epid_tune_publish(tune, values, 1U << EPID_TUNE_SP);
+}
+
+
+/* Copy the values if a new stable write is published and not torn.
+ * Return: Non-zero if `values[]` were taken.
+ */
+static int epid_tune_take(const epid_tune_t *tune, uint32_t *seen, uint32_t values[4])
+{
+    const uint32_t seq = (uint32_t)EPID_TUNE_LOAD(&tune->seq);
+
+    /* Fast path: One load per tick. */
+    if ((seq == *seen) || ((seq & 1U) != 0U)) {
+        return 0;
+    }
+
+    EPID_TUNE_FENCE_ACQUIRE();
+    for (unsigned i = 0U; i < 4U; i++) {
+        values[i] = (uint32_t)EPID_TUNE_LOAD(&tune->words[i]);
+    }
+    EPID_TUNE_FENCE_ACQUIRE();
+
+    /* Written during the copy: Keep the current values for this tick. */
+    if ((uint32_t)EPID_TUNE_LOAD(&tune->seq) != seq) {
+        return 0;
+    }
+
+    *seen = seq;
+    return 1;
+}
+
+
+int epid_tune_read(const epid_tune_t *tune, uint32_t *seen, epid_t *ctx, float *setpoint)
+{
+    uint32_t values[4];
+
+    if (epid_tune_take(tune, seen, values) == 0) {
+        return 0;
+    }
+
+    ctx->kp = epid_tune_flt(values[EPID_TUNE_KP]);
+    ctx->ki = epid_tune_flt(values[EPID_TUNE_KI]);
+    ctx->kd = epid_tune_flt(values[EPID_TUNE_KD]);
+    *setpoint = epid_tune_flt(values[EPID_TUNE_SP]);
+
+    return 1;
+}
+
+
+int epid_tune_read_gains(const epid_tune_t *tune, uint32_t *seen,
+                         epid_gains_t *gains, float *setpoint)
+{
+    uint32_t values[4];
+
+    if (epid_tune_take(tune, seen, values) == 0) {
+        return 0;
+    }
+
+    gains->kp = epid_tune_flt(values[EPID_TUNE_KP]);
+    gains->ki = epid_tune_flt(values[EPID_TUNE_KI]);
+    gains->kd = epid_tune_flt(values[EPID_TUNE_KD]);
+    *setpoint = epid_tune_flt(values[EPID_TUNE_SP]);
+
+    return 1;
+}
+
+
+#else
+/* Avoid an empty translation unit. */
+typedef int epid_tune_unavailable_t;
+#endif /* EPID_TUNE_AVAILABLE */
+
+
+#ifdef __cplusplus
+}
+#endif
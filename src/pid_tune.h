@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: ISC */
+/**
+ * Copyright (c) 2020 Abderraouf Adjal
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+/**
+ * EPID tuning channel: Lock-free updates of {`Kp`, `Ki`, `Kd`, `SP`} of a
+ * controller running in an ISR or in another thread, without torn sets.
+ *
+ * A sequence lock: One writer makes the sequence odd, writes the values, then
+ * makes it even again. The control step reads the sequence at the start of a
+ * tick, one load when nothing changed; on a new even sequence it copies the
+ * values and checks the sequence did not change during the copy.
+ * The reader never waits nor retries: If the writer is busy or the copy is
+ * torn, the current values are kept and the update is taken at a next tick.
+ * So both sides are wait-free, and a reader in an ISR never spins on a writer
+ * it interrupted.
+ *
+ * - `EPID_FEATURE_ATOMICS` (see <pid.h>): Atomic sequence and values, for
+ *   multi-core hosts; "pid_tune.c" is then built as C11 with <stdatomic.h>,
+ *   else (e.g. `-std=c99`) it is empty: `EPID_TUNE_AVAILABLE` is defined if
+ *   the functions are built in this unit.
+ * - Else: `volatile` 8-bits sequence (single byte stores) and values, with a
+ *   full barrier on GCC/Clang, for single-core MCUs (main loop and ISR).
+ *   A reader may miss an update if exactly a multiple of 128 writes happen
+ *   between two of its ticks, until the next write.
+ *
+ * Gains are checked by the writer as `epid_gains_init()`, so readers only
+ * see valid gains. Controller states are not modified (bumpless for the
+ * Type-C form, as the integral is in `y[k-1]`).
+ */
+
+
+#ifndef EPID_TUNE_H
+#define EPID_TUNE_H 1
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pid.h"
+
+#ifdef EPID_FEATURE_ATOMICS
+# if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) \
+  && !defined(__STDC_NO_ATOMICS__) && !defined(__cplusplus)
+#  define EPID_TUNE_ATOMICS 1 /* Atomic accesses in this unit. */
+#  define EPID_TUNE_AVAILABLE 1
+#  include <stdatomic.h>
+typedef _Atomic uint32_t epid_tune_seq_t;
+typedef _Atomic uint32_t epid_tune_word_t;
+# else
+/* Same layout, for units which only hold channels (e.g. C++). */
+typedef volatile uint32_t epid_tune_seq_t;
+typedef volatile uint32_t epid_tune_word_t;
+# endif
+#else
+# define EPID_TUNE_AVAILABLE 1
+typedef volatile uint8_t epid_tune_seq_t;
+typedef volatile uint32_t epid_tune_word_t;
+#endif
+
+
+typedef struct {
+    epid_tune_seq_t seq; /* Even: Stable values; odd: Write in progress. */
+    /* Bit-patterns of {`Kp`, `Ki`, `Kd`, `SP`}. */
+    epid_tune_word_t words[4];
+} epid_tune_t;
+
+
+/**
+ * Initialize a tuning channel with values, before readers use it.
+ *
+ * tune: Pointer to the `epid_tune_t` context.
+ * kp, ki, kd: Gains, with the same checks as `epid_gains_init()`.
+ * setpoint: The setpoint (SP).
+ *
+ * Return:
+ *   - `EPID_ERR_NONE` on success.
+ *   - `EPID_ERR_INIT` or `EPID_ERR_FLT` on invalid gains, see `epid_gains_init()`.
+ */
+epid_info_t epid_tune_init(epid_tune_t *tune, float kp, float ki, float kd, float setpoint);
+
+
+/**
+ * Writer: Publish new gains and setpoint, taken by readers at their next tick.
+ * Wait-free. One writer at a time per channel.
+ *
+ * tune: Pointer to the `epid_tune_t` context.
+ * kp, ki, kd: Gains, with the same checks as `epid_gains_init()`.
+ * setpoint: The setpoint (SP).
+ *
+ * Return: See `epid_tune_init()`; nothing is published on errors.
+ */
+epid_info_t epid_tune_write(epid_tune_t *tune, float kp, float ki, float kd, float setpoint);
+
+
+/**
+ * Writer: Publish a new setpoint with the current gains, see `epid_tune_write()`.
+ *
+ * tune: Pointer to the `epid_tune_t` context.
+ * setpoint: The setpoint (SP).
+ */
+void epid_tune_write_setpoint(epid_tune_t *tune, float setpoint);
+
+
+/**
+ * Reader: At the start of a tick, copy new values to a controller and to its
+ * setpoint if a complete write was published since the last successful read.
+ * Wait-free, no retry, safe in an ISR.
+ *
+ * tune: Pointer to the `epid_tune_t` context.
+ * seen: Reader state, the last taken sequence; init to zero before the first
+ *       read, which takes the current values.
+ * ctx: Pointer to the `epid_t` context, only {`kp`, `ki`, `kd`} are written.
+ * setpoint: Pointer to the setpoint of the controller.
+ *
+ * Return: Non-zero if new values were taken, else zero
+ *         (no change, write in progress, or torn copy).
+ */
+int epid_tune_read(const epid_tune_t *tune, uint32_t *seen, epid_t *ctx, float *setpoint);
+
+
+/**
+ * Reader: Same as `epid_tune_read()`, into a gains profile and a setpoint.
+ */
+int epid_tune_read_gains(const epid_tune_t *tune, uint32_t *seen,
+                         epid_gains_t *gains, float *setpoint);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EPID_TUNE_H */